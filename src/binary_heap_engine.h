@@ -0,0 +1,102 @@
+#ifndef _BINARY_HEAP_ENGINE_H_
+#define _BINARY_HEAP_ENGINE_H_
+
+/*
+ * Compile time selection of heap engine behind the common binary_heap_* API.
+ * Define BINARY_HEAP_ENGINE_INDEXED to use array backed indexed_binary_heap_t,
+ * BINARY_HEAP_ENGINE_DARY to use array backed d-ary dary_heap_t,
+ * otherwise pointer linked linked_binary_heap_t is used.
+ * Keyed heaps created with binary_heap_init_keyed are ordered by u64 keys.
+ * binary_heap_build of every engine skips nodes already inserted into a heap and repeated entries of the array.
+ */
+
+#if defined(BINARY_HEAP_ENGINE_INDEXED)
+
+#include "indexed_binary_heap.h"
+
+#define BINARY_HEAP_ENGINE_NAME "indexed"
+
+typedef indexed_binary_heap_t binary_heap_t;
+typedef indexed_binary_heap_node_t binary_heap_node_t;
+
+#define binary_heap_init indexed_binary_heap_init
+#define binary_heap_init_keyed(heap, visualizer) indexed_binary_heap_init_keyed((heap), (visualizer))
+#define binary_heap_destroy indexed_binary_heap_destroy
+#define binary_heap_node_init indexed_binary_heap_node_init
+#define binary_heap_node_set_key_u64 indexed_binary_heap_node_set_key_u64
+#define binary_heap_size indexed_binary_heap_size
+#define binary_heap_version indexed_binary_heap_version
+#define binary_heap_contains_node indexed_binary_heap_contains_node
+#define binary_heap_push indexed_binary_heap_push
+#define binary_heap_build indexed_binary_heap_build
+#define binary_heap_remove indexed_binary_heap_remove
+#define binary_heap_update indexed_binary_heap_update
+#define binary_heap_decrease indexed_binary_heap_decrease
+#define binary_heap_increase indexed_binary_heap_increase
+#define binary_heap_pop indexed_binary_heap_pop
+#define binary_heap_peek indexed_binary_heap_peek
+#define binary_heap_verify indexed_binary_heap_verify
+
+#elif defined(BINARY_HEAP_ENGINE_DARY)
+
+#include "dary_heap.h"
+
+#define BINARY_HEAP_ENGINE_STRINGIFY_VALUE(value) #value
+#define BINARY_HEAP_ENGINE_STRINGIFY(value) BINARY_HEAP_ENGINE_STRINGIFY_VALUE(value)
+#define BINARY_HEAP_ENGINE_NAME "dary" BINARY_HEAP_ENGINE_STRINGIFY(DARY_HEAP_ARITY)
+
+typedef dary_heap_t binary_heap_t;
+typedef dary_heap_node_t binary_heap_node_t;
+
+#define binary_heap_init dary_heap_init
+#define binary_heap_init_keyed(heap, visualizer) dary_heap_init_keyed((heap), (visualizer))
+#define binary_heap_destroy dary_heap_destroy
+#define binary_heap_node_init dary_heap_node_init
+#define binary_heap_node_set_key_u64 dary_heap_node_set_key_u64
+#define binary_heap_size dary_heap_size
+#define binary_heap_version dary_heap_version
+#define binary_heap_contains_node dary_heap_contains_node
+#define binary_heap_push dary_heap_push
+#define binary_heap_build dary_heap_build
+#define binary_heap_remove dary_heap_remove
+#define binary_heap_update dary_heap_update
+#define binary_heap_decrease dary_heap_decrease
+#define binary_heap_increase dary_heap_increase
+#define binary_heap_pop dary_heap_pop
+#define binary_heap_peek dary_heap_peek
+#define binary_heap_verify dary_heap_verify
+
+#else
+
+#include "linked_binary_heap.h"
+
+#define BINARY_HEAP_ENGINE_NAME "linked"
+
+typedef linked_binary_heap_t binary_heap_t;
+typedef linked_binary_heap_node_t binary_heap_node_t;
+
+#define binary_heap_init linked_binary_heap_init
+#define binary_heap_init_keyed(heap, visualizer) linked_binary_heap_init_keyed((heap), LINKED_BINARY_HEAP_KEY_U64, (visualizer))
+#define binary_heap_destroy(heap) ((void)(heap))
+#define binary_heap_node_init linked_binary_heap_node_init
+#define binary_heap_node_set_key_u64 linked_binary_heap_node_set_key_u64
+#define binary_heap_size linked_binary_heap_size
+#define binary_heap_version linked_binary_heap_version
+#define binary_heap_contains_node linked_binary_heap_contains_node
+#define binary_heap_push linked_binary_heap_push
+#define binary_heap_build linked_binary_heap_build
+#define binary_heap_remove linked_binary_heap_remove
+#define binary_heap_update linked_binary_heap_update
+#define binary_heap_decrease linked_binary_heap_decrease
+#define binary_heap_increase linked_binary_heap_increase
+#define binary_heap_pop linked_binary_heap_pop
+#define binary_heap_peek linked_binary_heap_peek
+#define binary_heap_verify linked_binary_heap_verify
+
+/* only linked heap can move the last node down bottom up on pop */
+#define BINARY_HEAP_ENGINE_HAS_BOTTOM_UP_POP 1
+#define binary_heap_set_bottom_up_pop(heap) linked_binary_heap_set_pop_mode((heap), LINKED_BINARY_HEAP_POP_BOTTOM_UP)
+
+#endif
+
+#endif
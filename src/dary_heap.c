@@ -0,0 +1,708 @@
+#include "dary_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__) && DARY_HEAP_ARITY >= 4 && (defined(__GNUC__) || defined(__clang__))
+#define DARY_HEAP_SIMD
+#include <immintrin.h>
+#endif
+
+#if defined(LINKED_BINARY_HEAP_DEBUG)
+#define DARY_HEAP_VERIFY_MUTATE_FUNCTIONS
+#endif
+
+#if defined(LINKED_BINARY_HEAP_STATS)
+#define DARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (heap)->stats.counter += (value); } while (0)
+#else
+#define DARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (void)(heap); } while (0)
+#endif
+
+#define UINT32_GT(a, b) (((b) - (a)) & 0x80000000)
+
+#define DARY_HEAP_MIN_CAPACITY 16
+
+// node with index i keeps its key at keys[i + DARY_HEAP_KEYS_OFFSET], so children
+// d * i + 1 ... d * i + d start at multiple of d and share one cache line
+#define DARY_HEAP_KEYS_OFFSET (DARY_HEAP_ARITY - 1)
+
+#define DARY_HEAP_CACHE_LINE 64
+
+// keys are stored with flipped sign bit, so signed comparison orders them as u64,
+// key of empty slots is the largest one
+#define DARY_HEAP_KEY_BIAS 0x8000000000000000ull
+#define DARY_HEAP_EMPTY_KEY INT64_MAX
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static inline int64_t
+dary_heap_biased_key(
+    uint64_t key)
+{
+    return (int64_t)(key ^ DARY_HEAP_KEY_BIAS);
+}
+
+
+static inline int
+dary_heap_node_compare_sequence(
+    const dary_heap_node_t* a,
+    const dary_heap_node_t* b)
+{
+    if (a->sequence == b->sequence)
+    {
+        ASSERT_WITH_MSG(a == b, "Only possible when compared to itself");
+        return 0;
+    }
+    // break equal priorities by order of push into heap
+    return UINT32_GT(a->sequence, b->sequence) ? 1 : -1;
+}
+
+
+static int
+dary_heap_node_compare_data(
+    const linked_binary_heap_node_data_comparer comparer,
+    const dary_heap_node_t* a,
+    const dary_heap_node_t* b)
+{
+    if (a == b)
+    {
+        return 0;
+    }
+    if (comparer == NULL)
+    {
+        if (a->key != b->key)
+        {
+            return a->key < b->key ? -1 : 1;
+        }
+    }
+    else
+    {
+        const int cmp = comparer(a->data, b->data);
+        if (cmp != 0)
+        {
+            return cmp;
+        }
+    }
+    return dary_heap_node_compare_sequence(a, b);
+}
+
+
+static inline int
+dary_heap_compare_at(
+    dary_heap_t* heap,
+    size_t index,
+    const dary_heap_node_t* node)
+{
+    DARY_HEAP_STATS_ADD(heap, comparisons, 1);
+    // keyed heaps compare cached key of node at index without touching the node itself
+    if (heap->keys != NULL)
+    {
+        const int64_t key = heap->keys[index + DARY_HEAP_KEYS_OFFSET];
+        const int64_t node_key = dary_heap_biased_key(node->key);
+        if (key != node_key)
+        {
+            return key < node_key ? -1 : 1;
+        }
+        return dary_heap_node_compare_sequence(heap->nodes[index], node);
+    }
+    return dary_heap_node_compare_data(heap->comparer, heap->nodes[index], node);
+}
+
+
+static inline void
+dary_heap_place(
+    dary_heap_t* heap,
+    dary_heap_node_t* node,
+    size_t index)
+{
+    heap->nodes[index] = node;
+    node->index = index;
+    if (heap->keys != NULL)
+    {
+        heap->keys[index + DARY_HEAP_KEYS_OFFSET] = dary_heap_biased_key(node->key);
+    }
+}
+
+
+#if defined(DARY_HEAP_SIMD)
+static size_t
+dary_heap_min_key_child_with_ties(
+    const dary_heap_t* heap,
+    size_t first,
+    unsigned mask)
+{
+    // several children share the smallest key, pick the earliest pushed one
+    size_t best = first + (size_t)__builtin_ctz(mask);
+    for (mask &= mask - 1; mask != 0; mask &= mask - 1)
+    {
+        const size_t child = first + (size_t)__builtin_ctz(mask);
+        if (dary_heap_node_compare_sequence(heap->nodes[child], heap->nodes[best]) < 0)
+        {
+            best = child;
+        }
+    }
+    return best;
+}
+#endif
+
+
+static inline size_t
+dary_heap_min_key_child(
+    const dary_heap_t* heap,
+    size_t first,
+    size_t count)
+{
+    const int64_t* const keys = heap->keys + first + DARY_HEAP_KEYS_OFFSET;
+#if defined(DARY_HEAP_SIMD)
+    // whole group of children is loaded at once, slots past the last node hold the largest key
+    const __m256i lo = _mm256_load_si256((const __m256i*)keys);
+#if DARY_HEAP_ARITY == 8
+    const __m256i hi = _mm256_load_si256((const __m256i*)(keys + 4));
+    __m256i min = _mm256_blendv_epi8(lo, hi, _mm256_cmpgt_epi64(lo, hi));
+#else
+    __m256i min = lo;
+#endif
+    __m256i other = _mm256_permute4x64_epi64(min, 0x4E);
+    min = _mm256_blendv_epi8(min, other, _mm256_cmpgt_epi64(min, other));
+    other = _mm256_shuffle_epi32(min, 0x4E);
+    min = _mm256_blendv_epi8(min, other, _mm256_cmpgt_epi64(min, other));
+    unsigned mask = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(lo, min)));
+#if DARY_HEAP_ARITY == 8
+    mask |= (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(hi, min))) << 4;
+#endif
+    mask &= (1u << count) - 1;
+    if ((mask & (mask - 1)) == 0)
+    {
+        return first + (size_t)__builtin_ctz(mask);
+    }
+    return dary_heap_min_key_child_with_ties(heap, first, mask);
+#else
+    size_t best = 0;
+    for (size_t i = 1; i < count; i++)
+    {
+        if (keys[i] < keys[best]
+            || (keys[i] == keys[best]
+                && dary_heap_node_compare_sequence(heap->nodes[first + i], heap->nodes[first + best]) < 0))
+        {
+            best = i;
+        }
+    }
+    return first + best;
+#endif
+}
+
+
+static inline size_t
+dary_heap_min_child(
+    const dary_heap_t* heap,
+    size_t first,
+    size_t count)
+{
+    if (heap->keys != NULL)
+    {
+        return dary_heap_min_key_child(heap, first, count);
+    }
+    size_t best = first;
+    for (size_t child = first + 1; child < first + count; child++)
+    {
+        if (dary_heap_node_compare_data(heap->comparer, heap->nodes[child], heap->nodes[best]) < 0)
+        {
+            best = child;
+        }
+    }
+    return best;
+}
+
+
+static void
+dary_heap_bubble_up(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    // move parents down into the hole until node's place is found
+    size_t index = node->index;
+    while (index > 0)
+    {
+        const size_t parent_index = (index - 1) / DARY_HEAP_ARITY;
+        if (dary_heap_compare_at(heap, parent_index, node) < 0)
+        {
+            break;
+        }
+        dary_heap_place(heap, heap->nodes[parent_index], index);
+        index = parent_index;
+        DARY_HEAP_STATS_ADD(heap, swaps, 1);
+    }
+    dary_heap_place(heap, node, index);
+}
+
+
+static void
+dary_heap_bubble_down(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    // move smallest children up into the hole until node's place is found
+    const size_t size = heap->size;
+    size_t index = node->index;
+    for (;;)
+    {
+        const size_t first = DARY_HEAP_ARITY * index + 1;
+        if (first >= size)
+        {
+            break;
+        }
+        const size_t count = size - first < DARY_HEAP_ARITY ? size - first : DARY_HEAP_ARITY;
+        const size_t smallest = dary_heap_min_child(heap, first, count);
+        // picking smallest of the group is counted as one comparison per child after the first
+        DARY_HEAP_STATS_ADD(heap, comparisons, count - 1);
+        if (dary_heap_compare_at(heap, smallest, node) > 0)
+        {
+            break;
+        }
+        dary_heap_place(heap, heap->nodes[smallest], index);
+        index = smallest;
+        DARY_HEAP_STATS_ADD(heap, swaps, 1);
+    }
+    dary_heap_place(heap, node, index);
+}
+
+
+static int
+dary_heap_grow(
+    dary_heap_t* heap,
+    size_t required)
+{
+    if (required <= heap->capacity)
+    {
+        return 0;
+    }
+    size_t capacity = heap->capacity < DARY_HEAP_MIN_CAPACITY ? DARY_HEAP_MIN_CAPACITY : heap->capacity;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+    dary_heap_node_t** nodes = (dary_heap_node_t**)realloc(heap->nodes, capacity * sizeof(dary_heap_node_t*));
+    if (nodes == NULL)
+    {
+        return -1;
+    }
+    heap->nodes = nodes;
+
+    if (heap->comparer == NULL)
+    {
+        // keys array has room for a whole group of children of any node and is
+        // aligned manually, since aligned allocation is not portable
+        const size_t keys_count = capacity + 2 * DARY_HEAP_ARITY;
+        void* allocation = malloc(keys_count * sizeof(int64_t) + DARY_HEAP_CACHE_LINE);
+        if (allocation == NULL)
+        {
+            return -1;
+        }
+        int64_t* keys = (int64_t*)(((uintptr_t)allocation + DARY_HEAP_CACHE_LINE - 1)
+            & ~(uintptr_t)(DARY_HEAP_CACHE_LINE - 1));
+        const size_t used = heap->keys != NULL ? heap->size + DARY_HEAP_KEYS_OFFSET : 0;
+        if (used > 0)
+        {
+            memcpy(keys, heap->keys, used * sizeof(int64_t));
+        }
+        for (size_t i = used; i < keys_count; i++)
+        {
+            keys[i] = DARY_HEAP_EMPTY_KEY;
+        }
+        free(heap->keys_allocation);
+        heap->keys_allocation = allocation;
+        heap->keys = keys;
+    }
+    heap->capacity = capacity;
+    return 0;
+}
+
+
+void
+dary_heap_init(
+    dary_heap_t* heap,
+    linked_binary_heap_node_data_comparer comparer,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    memset(heap, 0, sizeof(*heap));
+    heap->comparer = comparer;
+    heap->data_visualizer = data_visualizer;
+}
+
+
+void
+dary_heap_init_keyed(
+    dary_heap_t* heap,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    dary_heap_init(heap, NULL, data_visualizer);
+}
+
+
+void
+dary_heap_destroy(
+    dary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    for (size_t i = 0; i < heap->size; i++)
+    {
+        heap->nodes[i]->heap = NULL;
+    }
+    free(heap->nodes);
+    free(heap->keys_allocation);
+    heap->nodes = NULL;
+    heap->keys = NULL;
+    heap->keys_allocation = NULL;
+    heap->capacity = 0;
+    heap->size = 0;
+}
+
+
+int
+dary_heap_reserve(
+    dary_heap_t* heap,
+    size_t capacity)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    return dary_heap_grow(heap, capacity);
+}
+
+
+void
+dary_heap_node_init(
+    dary_heap_node_t* node,
+    void* data)
+{
+    memset(node, 0, sizeof(*node));
+    node->data = data;
+}
+
+
+void
+dary_heap_node_set_key_u64(
+    dary_heap_node_t* node,
+    uint64_t key)
+{
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->heap == NULL)
+    {
+        node->key = key;
+        return;
+    }
+    ASSERT_WITH_MSG(node->heap->comparer == NULL, "Node must belong to keyed heap");
+    if (node->key == key)
+    {
+        return;
+    }
+    const int decreased = key < node->key;
+    node->key = key;
+    if (decreased)
+    {
+        dary_heap_decrease(node->heap, node);
+    }
+    else
+    {
+        dary_heap_increase(node->heap, node);
+    }
+}
+
+
+size_t
+dary_heap_size(
+    const dary_heap_t* heap)
+{
+    return heap->size;
+}
+
+
+uint32_t
+dary_heap_version(
+    const dary_heap_t* heap)
+{
+    return heap->mod_count;
+}
+
+
+int
+dary_heap_contains_node(
+    const dary_heap_t* heap,
+    const dary_heap_node_t* node)
+{
+    return heap == node->heap;
+}
+
+
+int
+dary_heap_push(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->heap != NULL)
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return -1;
+    }
+    if (0 != dary_heap_grow(heap, heap->size + 1))
+    {
+        return -1;
+    }
+    node->heap = heap;
+    node->index = heap->size;
+    node->sequence = heap->mod_count;
+    heap->size += 1;
+    heap->mod_count += 1;
+    dary_heap_bubble_up(heap, node);
+#if defined(DARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    dary_heap_verify(heap);
+#endif
+    return 0;
+}
+
+
+int
+dary_heap_build(
+    dary_heap_t* heap,
+    dary_heap_node_t** nodes,
+    size_t count)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(nodes != NULL || count == 0, "Nodes pointer must not be null");
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (0 != dary_heap_grow(heap, heap->size + count))
+    {
+        return -1;
+    }
+
+    // node is marked as inserted when appended, so nodes of any heap and repeated entries of the array are skipped
+    const size_t old_size = heap->size;
+    for (size_t i = 0; i < count; i++)
+    {
+        dary_heap_node_t* const node = nodes[i];
+        if (node->heap != NULL)
+        {
+            continue;
+        }
+        node->heap = heap;
+        node->sequence = heap->mod_count;
+        dary_heap_place(heap, node, heap->size);
+        heap->mod_count += 1;
+        heap->size += 1;
+    }
+    if (heap->size == old_size)
+    {
+        return 0;
+    }
+
+    // Floyd's heapify of parents of appended nodes and their ancestors, level by level,
+    // parents of index range [lo, hi] form range [(lo - 1) / d, (hi - 1) / d]
+    size_t processed = heap->size;
+    size_t lo = old_size;
+    size_t hi = heap->size - 1;
+    while (hi > 0)
+    {
+        const size_t parent_lo = lo > 0 ? (lo - 1) / DARY_HEAP_ARITY : 0;
+        size_t parent_hi = (hi - 1) / DARY_HEAP_ARITY;
+        if (parent_hi >= processed)
+        {
+            parent_hi = processed - 1;
+        }
+        for (size_t index = parent_hi + 1; index-- > parent_lo;)
+        {
+            dary_heap_bubble_down(heap, heap->nodes[index]);
+        }
+        processed = parent_lo;
+        lo = parent_lo;
+        hi = parent_lo == 0 ? 0 : parent_hi;
+    }
+#if defined(DARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    dary_heap_verify(heap);
+#endif
+    return 0;
+}
+
+
+void
+dary_heap_remove(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->size -= 1;
+    heap->mod_count += 1;
+    dary_heap_node_t* const last_node = heap->nodes[heap->size];
+    if (heap->keys != NULL)
+    {
+        heap->keys[heap->size + DARY_HEAP_KEYS_OFFSET] = DARY_HEAP_EMPTY_KEY;
+    }
+    if (last_node != node)
+    {
+        dary_heap_place(heap, last_node, node->index);
+        dary_heap_bubble_down(heap, last_node);
+        dary_heap_bubble_up(heap, last_node);
+    }
+
+    node->heap = NULL;
+    node->index = 0;
+    node->sequence = 0;
+#if defined(DARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    dary_heap_verify(heap);
+#endif
+}
+
+
+void
+dary_heap_update(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    if (node->index > 0 && dary_heap_compare_at(heap, (node->index - 1) / DARY_HEAP_ARITY, node) > 0)
+    {
+        dary_heap_bubble_up(heap, node);
+    }
+    else
+    {
+        dary_heap_bubble_down(heap, node);
+    }
+}
+
+
+void
+dary_heap_decrease(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    dary_heap_bubble_up(heap, node);
+}
+
+
+void
+dary_heap_increase(
+    dary_heap_t* heap,
+    dary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    dary_heap_bubble_down(heap, node);
+}
+
+
+int
+dary_heap_peek(
+    const dary_heap_t* heap,
+    dary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (heap->size > 0)
+    {
+        *out_node = heap->nodes[0];
+        return 0;
+    }
+    return -1;
+}
+
+
+int
+dary_heap_pop(
+    dary_heap_t* heap,
+    dary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (0 != dary_heap_peek(heap, out_node))
+    {
+        return -1;
+    }
+    dary_heap_remove(heap, *out_node);
+    return 0;
+}
+
+
+int
+dary_heap_verify(
+    const dary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (heap->size > heap->capacity)
+    {
+        ASSERT_WITH_MSG(0, "Heap size exceeds capacity");
+        return -1;
+    }
+    for (size_t i = 0; i < heap->size; i++)
+    {
+        const dary_heap_node_t* const node = heap->nodes[i];
+        if (node->heap != heap || node->index != i)
+        {
+            ASSERT_WITH_MSG(0, "Node has wrong pointer to heap or index");
+            return -1;
+        }
+        if (heap->keys != NULL && heap->keys[i + DARY_HEAP_KEYS_OFFSET] != dary_heap_biased_key(node->key))
+        {
+            ASSERT_WITH_MSG(0, "Cached key does not match node's key");
+            return -1;
+        }
+        if (i > 0 && dary_heap_node_compare_data(heap->comparer, heap->nodes[(i - 1) / DARY_HEAP_ARITY], node) > 0)
+        {
+            ASSERT_WITH_MSG(0, "Node's parent has bigger priority");
+            return -1;
+        }
+    }
+    if (heap->keys != NULL)
+    {
+        for (size_t i = heap->size; i < heap->capacity + DARY_HEAP_ARITY; i++)
+        {
+            if (heap->keys[i + DARY_HEAP_KEYS_OFFSET] != DARY_HEAP_EMPTY_KEY)
+            {
+                ASSERT_WITH_MSG(0, "Key slot past the last node is not empty");
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,168 @@
+#ifndef _DARY_HEAP_H_
+#define _DARY_HEAP_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Array backed d-ary heap with the same API as linked_binary_heap_t.
+ * Arity is selected at compile time with DARY_HEAP_ARITY (2, 4 or 8, 8 by default)
+ * and must be the same for the whole program. Keys of keyed heaps are cached in
+ * an array laid out so that all children of a node share one 64 byte cache line,
+ * minimum of children is found with AVX2 when it is enabled at compile time.
+ */
+
+#if !defined(DARY_HEAP_ARITY)
+#define DARY_HEAP_ARITY 8
+#endif
+
+#if DARY_HEAP_ARITY != 2 && DARY_HEAP_ARITY != 4 && DARY_HEAP_ARITY != 8
+#error "DARY_HEAP_ARITY must be 2, 4 or 8"
+#endif
+
+typedef struct dary_heap_node dary_heap_node_t;
+
+typedef struct dary_heap dary_heap_t;
+
+/* structure representing heap node */
+struct dary_heap_node
+{
+    void* data; /* pointer to data associated with heap node */
+    dary_heap_t* heap; /* pointer to a heap containing this node */
+    size_t index; /* index of the node in heap's arrays */
+    uint64_t key; /* key of the node, compared instead of data in keyed heaps */
+    uint32_t sequence; /* sequence number of this node, used to resolve priority collision in push order */
+};
+
+/* structure representing heap */
+struct dary_heap
+{
+    int64_t* keys; /* cache line aligned array of sign flipped keys, children of a node start at cache line boundary */
+    dary_heap_node_t** nodes; /* array of pointers to nodes in level order */
+    void* keys_allocation; /* allocation backing keys array */
+    size_t capacity; /* number of nodes arrays can hold */
+    size_t size; /* number of nodes stored in this heap */
+    uint32_t mod_count; /* number of heap modification operations executed */
+    linked_binary_heap_node_data_comparer comparer; /* function to compare data associated with nodes, null for keyed heap */
+    linked_binary_heap_node_data_visualizer data_visualizer; /* optional user-provided function to provide human readable representation of node's data */
+#if defined(LINKED_BINARY_HEAP_STATS)
+    linked_binary_heap_stats_t stats; /* counters of internal operations */
+#endif
+};
+
+
+void
+dary_heap_init(
+    dary_heap_t*,
+    linked_binary_heap_node_data_comparer,
+    linked_binary_heap_node_data_visualizer);
+
+
+/* initializes heap ordered by u64 key cached in nodes instead of comparer */
+void
+dary_heap_init_keyed(
+    dary_heap_t*,
+    linked_binary_heap_node_data_visualizer);
+
+
+/* releases heap arrays, nodes still in the heap are detached */
+void
+dary_heap_destroy(
+    dary_heap_t*);
+
+
+/* preallocates heap arrays for at least given number of nodes, returns -1 on allocation failure */
+int
+dary_heap_reserve(
+    dary_heap_t*,
+    size_t);
+
+
+void
+dary_heap_node_init(
+    dary_heap_node_t*,
+    void*);
+
+
+/* key setter of keyed heap nodes, node already inserted into the heap is moved according to the new key */
+void
+dary_heap_node_set_key_u64(
+    dary_heap_node_t*,
+    uint64_t);
+
+
+size_t
+dary_heap_size(
+    const dary_heap_t*);
+
+
+uint32_t
+dary_heap_version(
+    const dary_heap_t*);
+
+
+int
+dary_heap_contains_node(
+    const dary_heap_t*,
+    const dary_heap_node_t*);
+
+
+/* returns -1 if heap arrays can not be grown */
+int
+dary_heap_push(
+    dary_heap_t*,
+    dary_heap_node_t*);
+
+
+/* appends array of initialized nodes to the heap, nodes already inserted into a heap
+ * and repeated entries of the array are skipped, returns -1 on allocation failure */
+int
+dary_heap_build(
+    dary_heap_t*,
+    dary_heap_node_t**,
+    size_t);
+
+
+void
+dary_heap_remove(
+    dary_heap_t*,
+    dary_heap_node_t*);
+
+
+void
+dary_heap_update(
+    dary_heap_t*,
+    dary_heap_node_t*);
+
+
+void
+dary_heap_decrease(
+    dary_heap_t*,
+    dary_heap_node_t*);
+
+
+void
+dary_heap_increase(
+    dary_heap_t*,
+    dary_heap_node_t*);
+
+
+int
+dary_heap_pop(
+    dary_heap_t*,
+    dary_heap_node_t**);
+
+
+int
+dary_heap_peek(
+    const dary_heap_t*,
+    dary_heap_node_t**);
+
+
+int
+dary_heap_verify(
+    const dary_heap_t*);
+
+#endif
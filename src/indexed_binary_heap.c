@@ -0,0 +1,523 @@
+#include "indexed_binary_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(LINKED_BINARY_HEAP_DEBUG)
+#define INDEXED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS
+#endif
+
+#if defined(LINKED_BINARY_HEAP_STATS)
+#define INDEXED_BINARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (heap)->stats.counter += (value); } while (0)
+#else
+#define INDEXED_BINARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (void)(heap); } while (0)
+#endif
+
+#define UINT32_GT(a, b) (((b) - (a)) & 0x80000000)
+
+#define INDEXED_BINARY_HEAP_MIN_CAPACITY 16
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static int
+indexed_binary_heap_node_compare_data(
+    const linked_binary_heap_node_data_comparer comparer,
+    const indexed_binary_heap_node_t* a,
+    const indexed_binary_heap_node_t* b)
+{
+    if (a == b)
+    {
+        return 0;
+    }
+    if (comparer == NULL)
+    {
+        if (a->key != b->key)
+        {
+            return a->key < b->key ? -1 : 1;
+        }
+    }
+    else
+    {
+        const int cmp = comparer(a->data, b->data);
+        if (cmp != 0)
+        {
+            return cmp;
+        }
+    }
+    if (a->sequence == b->sequence)
+    {
+        ASSERT_WITH_MSG(0, "Only possible when compared to itself");
+        return 0;
+    }
+    // break equal priorities by order of push into heap
+    return UINT32_GT(a->sequence, b->sequence) ? 1 : -1;
+}
+
+
+static inline int
+indexed_binary_heap_compare(
+    indexed_binary_heap_t* heap,
+    const indexed_binary_heap_node_t* a,
+    const indexed_binary_heap_node_t* b)
+{
+    INDEXED_BINARY_HEAP_STATS_ADD(heap, comparisons, 1);
+    return indexed_binary_heap_node_compare_data(heap->comparer, a, b);
+}
+
+
+static void
+indexed_binary_heap_bubble_up(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    // move parents down into the hole until node's place is found
+    indexed_binary_heap_node_t** const nodes = heap->nodes;
+    size_t index = node->index;
+    while (index > 0)
+    {
+        const size_t parent_index = (index - 1) / 2;
+        indexed_binary_heap_node_t* const parent = nodes[parent_index];
+        if (indexed_binary_heap_compare(heap, node, parent) > 0)
+        {
+            break;
+        }
+        nodes[index] = parent;
+        parent->index = index;
+        index = parent_index;
+        INDEXED_BINARY_HEAP_STATS_ADD(heap, swaps, 1);
+    }
+    nodes[index] = node;
+    node->index = index;
+}
+
+
+static void
+indexed_binary_heap_bubble_down(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    // move smaller children up into the hole until node's place is found
+    indexed_binary_heap_node_t** const nodes = heap->nodes;
+    const size_t size = heap->size;
+    size_t index = node->index;
+    for (;;)
+    {
+        const size_t left = 2 * index + 1;
+        if (left >= size)
+        {
+            break;
+        }
+        size_t smallest = left;
+        if (left + 1 < size && indexed_binary_heap_compare(heap, nodes[left + 1], nodes[left]) < 0)
+        {
+            smallest = left + 1;
+        }
+        if (indexed_binary_heap_compare(heap, nodes[smallest], node) > 0)
+        {
+            break;
+        }
+        nodes[index] = nodes[smallest];
+        nodes[index]->index = index;
+        index = smallest;
+        INDEXED_BINARY_HEAP_STATS_ADD(heap, swaps, 1);
+    }
+    nodes[index] = node;
+    node->index = index;
+}
+
+
+static int
+indexed_binary_heap_grow(
+    indexed_binary_heap_t* heap,
+    size_t required)
+{
+    if (required <= heap->capacity)
+    {
+        return 0;
+    }
+    size_t capacity = heap->capacity < INDEXED_BINARY_HEAP_MIN_CAPACITY ? INDEXED_BINARY_HEAP_MIN_CAPACITY : heap->capacity;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+    indexed_binary_heap_node_t** nodes =
+        (indexed_binary_heap_node_t**)realloc(heap->nodes, capacity * sizeof(indexed_binary_heap_node_t*));
+    if (nodes == NULL)
+    {
+        return -1;
+    }
+    heap->nodes = nodes;
+    heap->capacity = capacity;
+    return 0;
+}
+
+
+void
+indexed_binary_heap_init(
+    indexed_binary_heap_t* heap,
+    linked_binary_heap_node_data_comparer comparer,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    memset(heap, 0, sizeof(*heap));
+    heap->comparer = comparer;
+    heap->data_visualizer = data_visualizer;
+}
+
+
+void
+indexed_binary_heap_init_keyed(
+    indexed_binary_heap_t* heap,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    indexed_binary_heap_init(heap, NULL, data_visualizer);
+}
+
+
+void
+indexed_binary_heap_destroy(
+    indexed_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    for (size_t i = 0; i < heap->size; i++)
+    {
+        heap->nodes[i]->heap = NULL;
+    }
+    free(heap->nodes);
+    heap->nodes = NULL;
+    heap->capacity = 0;
+    heap->size = 0;
+}
+
+
+int
+indexed_binary_heap_reserve(
+    indexed_binary_heap_t* heap,
+    size_t capacity)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    return indexed_binary_heap_grow(heap, capacity);
+}
+
+
+void
+indexed_binary_heap_node_init(
+    indexed_binary_heap_node_t* node,
+    void* data)
+{
+    memset(node, 0, sizeof(*node));
+    node->data = data;
+}
+
+
+void
+indexed_binary_heap_node_set_key_u64(
+    indexed_binary_heap_node_t* node,
+    uint64_t key)
+{
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->heap == NULL)
+    {
+        node->key = key;
+        return;
+    }
+    ASSERT_WITH_MSG(node->heap->comparer == NULL, "Node must belong to keyed heap");
+    if (node->key == key)
+    {
+        return;
+    }
+    const int decreased = key < node->key;
+    node->key = key;
+    if (decreased)
+    {
+        indexed_binary_heap_decrease(node->heap, node);
+    }
+    else
+    {
+        indexed_binary_heap_increase(node->heap, node);
+    }
+}
+
+
+size_t
+indexed_binary_heap_size(
+    const indexed_binary_heap_t* heap)
+{
+    return heap->size;
+}
+
+
+uint32_t
+indexed_binary_heap_version(
+    const indexed_binary_heap_t* heap)
+{
+    return heap->mod_count;
+}
+
+
+int
+indexed_binary_heap_contains_node(
+    const indexed_binary_heap_t* heap,
+    const indexed_binary_heap_node_t* node)
+{
+    return heap == node->heap;
+}
+
+
+int
+indexed_binary_heap_push(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->heap != NULL)
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return -1;
+    }
+    if (0 != indexed_binary_heap_grow(heap, heap->size + 1))
+    {
+        return -1;
+    }
+    node->heap = heap;
+    node->index = heap->size;
+    node->sequence = heap->mod_count;
+    heap->nodes[heap->size] = node;
+    heap->size += 1;
+    heap->mod_count += 1;
+    indexed_binary_heap_bubble_up(heap, node);
+#if defined(INDEXED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    indexed_binary_heap_verify(heap);
+#endif
+    return 0;
+}
+
+
+int
+indexed_binary_heap_build(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t** nodes,
+    size_t count)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(nodes != NULL || count == 0, "Nodes pointer must not be null");
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (0 != indexed_binary_heap_grow(heap, heap->size + count))
+    {
+        return -1;
+    }
+
+    // node is marked as inserted when appended, so nodes of any heap and repeated entries of the array are skipped
+    const size_t old_size = heap->size;
+    for (size_t i = 0; i < count; i++)
+    {
+        indexed_binary_heap_node_t* const node = nodes[i];
+        if (node->heap != NULL)
+        {
+            continue;
+        }
+        node->heap = heap;
+        node->index = heap->size;
+        node->sequence = heap->mod_count;
+        heap->nodes[heap->size] = node;
+        heap->mod_count += 1;
+        heap->size += 1;
+    }
+    if (heap->size == old_size)
+    {
+        return 0;
+    }
+
+    // Floyd's heapify of parents of appended nodes and their ancestors, level by level,
+    // parents of index range [lo, hi] form range [(lo - 1) / 2, (hi - 1) / 2]
+    size_t processed = heap->size;
+    size_t lo = old_size;
+    size_t hi = heap->size - 1;
+    while (hi > 0)
+    {
+        const size_t parent_lo = lo > 0 ? (lo - 1) / 2 : 0;
+        size_t parent_hi = (hi - 1) / 2;
+        if (parent_hi >= processed)
+        {
+            parent_hi = processed - 1;
+        }
+        for (size_t index = parent_hi + 1; index-- > parent_lo;)
+        {
+            indexed_binary_heap_bubble_down(heap, heap->nodes[index]);
+        }
+        processed = parent_lo;
+        lo = parent_lo;
+        hi = parent_lo == 0 ? 0 : parent_hi;
+    }
+#if defined(INDEXED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    indexed_binary_heap_verify(heap);
+#endif
+    return 0;
+}
+
+
+void
+indexed_binary_heap_remove(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->size -= 1;
+    heap->mod_count += 1;
+    indexed_binary_heap_node_t* const last_node = heap->nodes[heap->size];
+    if (last_node != node)
+    {
+        last_node->index = node->index;
+        heap->nodes[node->index] = last_node;
+        indexed_binary_heap_bubble_down(heap, last_node);
+        indexed_binary_heap_bubble_up(heap, last_node);
+    }
+
+    node->heap = NULL;
+    node->index = 0;
+    node->sequence = 0;
+#if defined(INDEXED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    indexed_binary_heap_verify(heap);
+#endif
+}
+
+
+void
+indexed_binary_heap_update(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    if (node->index > 0
+        && indexed_binary_heap_compare(heap, node, heap->nodes[(node->index - 1) / 2]) < 0)
+    {
+        indexed_binary_heap_bubble_up(heap, node);
+    }
+    else
+    {
+        indexed_binary_heap_bubble_down(heap, node);
+    }
+}
+
+
+void
+indexed_binary_heap_decrease(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    indexed_binary_heap_bubble_up(heap, node);
+}
+
+
+void
+indexed_binary_heap_increase(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    indexed_binary_heap_bubble_down(heap, node);
+}
+
+
+int
+indexed_binary_heap_peek(
+    const indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (heap->size > 0)
+    {
+        *out_node = heap->nodes[0];
+        return 0;
+    }
+    return -1;
+}
+
+
+int
+indexed_binary_heap_pop(
+    indexed_binary_heap_t* heap,
+    indexed_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (0 != indexed_binary_heap_peek(heap, out_node))
+    {
+        return -1;
+    }
+    indexed_binary_heap_remove(heap, *out_node);
+    return 0;
+}
+
+
+int
+indexed_binary_heap_verify(
+    const indexed_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (heap->size > heap->capacity)
+    {
+        ASSERT_WITH_MSG(0, "Heap size exceeds capacity");
+        return -1;
+    }
+    for (size_t i = 0; i < heap->size; i++)
+    {
+        const indexed_binary_heap_node_t* const node = heap->nodes[i];
+        if (node->heap != heap || node->index != i)
+        {
+            ASSERT_WITH_MSG(0, "Node has wrong pointer to heap or index");
+            return -1;
+        }
+        if (i > 0 && indexed_binary_heap_node_compare_data(heap->comparer, heap->nodes[(i - 1) / 2], node) > 0)
+        {
+            ASSERT_WITH_MSG(0, "Node's parent has bigger priority");
+            return -1;
+        }
+    }
+    return 0;
+}
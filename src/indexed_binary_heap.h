@@ -0,0 +1,156 @@
+#ifndef _INDEXED_BINARY_HEAP_H_
+#define _INDEXED_BINARY_HEAP_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Array backed binary heap with the same API as linked_binary_heap_t.
+ * Heap keeps pointers to nodes in a contiguous growable array in level order,
+ * every node stores its array index, so remove and update of arbitrary nodes stay O(log n).
+ */
+
+typedef struct indexed_binary_heap_node indexed_binary_heap_node_t;
+
+typedef struct indexed_binary_heap indexed_binary_heap_t;
+
+/* structure representing heap node */
+struct indexed_binary_heap_node
+{
+    void* data; /* pointer to data associated with heap node */
+    indexed_binary_heap_t* heap; /* pointer to a heap containing this node */
+    size_t index; /* index of the node in heap's array */
+    uint64_t key; /* key of the node, compared instead of data in keyed heaps */
+    uint32_t sequence; /* sequence number of this node, used to resolve priority collision in push order */
+};
+
+/* structure representing heap */
+struct indexed_binary_heap
+{
+    indexed_binary_heap_node_t** nodes; /* array of pointers to nodes in level order */
+    size_t capacity; /* number of node pointers allocated in the array */
+    size_t size; /* number of nodes stored in this heap */
+    uint32_t mod_count; /* number of heap modification operations executed */
+    linked_binary_heap_node_data_comparer comparer; /* function to compare data associated with nodes, null for keyed heap */
+    linked_binary_heap_node_data_visualizer data_visualizer; /* optional user-provided function to provide human readable representation of node's data */
+#if defined(LINKED_BINARY_HEAP_STATS)
+    linked_binary_heap_stats_t stats; /* counters of internal operations */
+#endif
+};
+
+
+void
+indexed_binary_heap_init(
+    indexed_binary_heap_t*,
+    linked_binary_heap_node_data_comparer,
+    linked_binary_heap_node_data_visualizer);
+
+
+/* initializes heap ordered by u64 key cached in nodes instead of comparer */
+void
+indexed_binary_heap_init_keyed(
+    indexed_binary_heap_t*,
+    linked_binary_heap_node_data_visualizer);
+
+
+/* releases node array, nodes still in the heap are detached */
+void
+indexed_binary_heap_destroy(
+    indexed_binary_heap_t*);
+
+
+/* preallocates node array for at least given number of nodes, returns -1 on allocation failure */
+int
+indexed_binary_heap_reserve(
+    indexed_binary_heap_t*,
+    size_t);
+
+
+void
+indexed_binary_heap_node_init(
+    indexed_binary_heap_node_t*,
+    void*);
+
+
+/* key setter of keyed heap nodes, node already inserted into the heap is moved according to the new key */
+void
+indexed_binary_heap_node_set_key_u64(
+    indexed_binary_heap_node_t*,
+    uint64_t);
+
+
+size_t
+indexed_binary_heap_size(
+    const indexed_binary_heap_t*);
+
+
+uint32_t
+indexed_binary_heap_version(
+    const indexed_binary_heap_t*);
+
+
+int
+indexed_binary_heap_contains_node(
+    const indexed_binary_heap_t*,
+    const indexed_binary_heap_node_t*);
+
+
+/* returns -1 if node array can not be grown */
+int
+indexed_binary_heap_push(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t*);
+
+
+/* appends array of initialized nodes to the heap and restores heap order in O(n), nodes already inserted into a heap
+ * and repeated entries of the array are skipped, returns -1 on allocation failure */
+int
+indexed_binary_heap_build(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t**,
+    size_t);
+
+
+void
+indexed_binary_heap_remove(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t*);
+
+
+void
+indexed_binary_heap_update(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t*);
+
+
+void
+indexed_binary_heap_decrease(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t*);
+
+
+void
+indexed_binary_heap_increase(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t*);
+
+
+int
+indexed_binary_heap_pop(
+    indexed_binary_heap_t*,
+    indexed_binary_heap_node_t**);
+
+
+int
+indexed_binary_heap_peek(
+    const indexed_binary_heap_t*,
+    indexed_binary_heap_node_t**);
+
+
+int
+indexed_binary_heap_verify(
+    const indexed_binary_heap_t*);
+
+#endif
@@ -0,0 +1,315 @@
+#include "indexed_binary_heap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+typedef struct item
+{
+    indexed_binary_heap_node_t heap_node;
+    int32_t priority;
+} item_t;
+
+
+int
+item_comparer(const void* x, const void* y)
+{
+    const item_t* X = x;
+    const item_t* Y = y;
+    return X->priority - Y->priority;
+}
+
+
+int
+always_equal_comparer(const void *x, const void *y)
+{
+    (void)x;
+    (void)y;
+    return 0;
+}
+
+
+void
+shuffle_array(uint32_t *a, size_t size)
+{
+    for (size_t i = size - 1; i >= 1; i--)
+    {
+        const size_t r = (size_t)1 * RAND_MAX * rand() + rand();
+        size_t j = r % (i + 1);
+        uint32_t temp = a[j];
+        a[j] = a[i];
+        a[i] = temp;
+    }
+}
+
+
+void
+test_indexed_binary_heap_push_pop_random_items(void)
+{
+    const size_t items_count = 1024 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    indexed_binary_heap_t heap;
+    indexed_binary_heap_init(&heap, item_comparer, NULL);
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = (int32_t)(rand() % items_count);
+        indexed_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        if (0 != indexed_binary_heap_push(&heap, &items[i].heap_node)
+            || indexed_binary_heap_size(&heap) != i + 1)
+        {
+            printf("%s test FAILED: heap size expected to be %zu\n", __func__, i + 1);
+            goto free_mem;
+        }
+    }
+
+    if (0 != indexed_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid\n", __func__);
+        goto free_mem;
+    }
+
+    int32_t root_priority = INT32_MIN;
+    indexed_binary_heap_node_t* top;
+    while (0 == indexed_binary_heap_pop(&heap, &top))
+    {
+        const int32_t next_priority = ((item_t*)top->data)->priority;
+        if (root_priority > next_priority)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item is less than previously popped %"PRId32" \n",
+                __func__, next_priority, root_priority);
+            goto free_mem;
+        }
+        root_priority = next_priority;
+    }
+
+    if (indexed_binary_heap_size(&heap) != 0)
+    {
+        printf("%s test FAILED: heap size expected to be 0\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    indexed_binary_heap_destroy(&heap);
+    free(items);
+}
+
+
+void
+test_indexed_binary_heap_priority_collision_handled_in_push_order(void)
+{
+    item_t items[512];
+    indexed_binary_heap_node_t* nodes[512];
+
+    indexed_binary_heap_t heap;
+    indexed_binary_heap_init(&heap, always_equal_comparer, NULL);
+
+    for (size_t i = 0; i < 512; i++)
+    {
+        items[i].priority = (int32_t)i;
+        indexed_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        nodes[i] = &items[i].heap_node;
+    }
+    for (size_t i = 0; i < 100; i++)
+    {
+        indexed_binary_heap_push(&heap, nodes[i]);
+    }
+    indexed_binary_heap_build(&heap, &nodes[100], 300);
+    for (size_t i = 400; i < 512; i++)
+    {
+        indexed_binary_heap_push(&heap, nodes[i]);
+    }
+
+    if (0 != indexed_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid\n", __func__);
+        goto free_mem;
+    }
+
+    for (size_t i = 0; i < 512; i++)
+    {
+        indexed_binary_heap_node_t* node;
+        indexed_binary_heap_pop(&heap, &node);
+        item_t* item = (item_t*)node->data;
+        if (item->priority != (int32_t)i)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item does not match push order %zu\n",
+                __func__, item->priority, i);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    indexed_binary_heap_destroy(&heap);
+}
+
+
+void
+test_indexed_binary_heap_build_random_items(void)
+{
+    const size_t items_count = 256 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    indexed_binary_heap_node_t** nodes = (indexed_binary_heap_node_t**)malloc(items_count * sizeof(indexed_binary_heap_node_t*));
+    indexed_binary_heap_t heap;
+    indexed_binary_heap_init(&heap, item_comparer, NULL);
+    if (items == NULL || nodes == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    const size_t batches[] = { items_count / 2, 1, 3, items_count / 8, items_count / 4 };
+    size_t built = 0;
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+    {
+        for (size_t i = 0; i < batches[b]; i++)
+        {
+            items[built + i].priority = (int32_t)(rand() % items_count);
+            indexed_binary_heap_node_init(&items[built + i].heap_node, &items[built + i]);
+            nodes[i] = &items[built + i].heap_node;
+        }
+        indexed_binary_heap_build(&heap, nodes, batches[b]);
+        built += batches[b];
+        if (indexed_binary_heap_size(&heap) != built || 0 != indexed_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap is not valid after build of %zu nodes\n", __func__, batches[b]);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    indexed_binary_heap_destroy(&heap);
+    free(items);
+    free(nodes);
+}
+
+
+void
+test_indexed_binary_heap_build_skips_inserted_nodes(void)
+{
+    item_t items[20];
+    indexed_binary_heap_node_t* nodes[13];
+    indexed_binary_heap_t heap;
+    indexed_binary_heap_init(&heap, item_comparer, NULL);
+
+    for (size_t i = 0; i < 20; i++)
+    {
+        items[i].priority = (int32_t)i;
+        indexed_binary_heap_node_init(&items[i].heap_node, &items[i]);
+    }
+    for (size_t i = 0; i < 10; i++)
+    {
+        indexed_binary_heap_push(&heap, &items[i].heap_node);
+    }
+    // already inserted node and repeated entry are skipped, the rest of the batch is still appended
+    nodes[0] = &items[5].heap_node;
+    for (size_t i = 10; i < 20; i++)
+    {
+        nodes[i - 9] = &items[i].heap_node;
+    }
+    nodes[11] = &items[12].heap_node;
+    nodes[12] = &items[0].heap_node;
+    if (0 != indexed_binary_heap_build(&heap, nodes, 13) || indexed_binary_heap_size(&heap) != 20
+        || 0 != indexed_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid after build of partially inserted nodes\n", __func__);
+        goto free_mem;
+    }
+
+    for (size_t i = 0; i < 20; i++)
+    {
+        indexed_binary_heap_node_t* node;
+        indexed_binary_heap_pop(&heap, &node);
+        item_t* item = (item_t*)node->data;
+        if (item->priority != (int32_t)i)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item does not match expected %zu\n",
+                __func__, item->priority, i);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    indexed_binary_heap_destroy(&heap);
+}
+
+
+void
+test_indexed_binary_heap_random_remove_and_update(void)
+{
+    const uint32_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    uint32_t* order = (uint32_t*)malloc(items_count * sizeof(uint32_t));
+    indexed_binary_heap_t heap;
+    indexed_binary_heap_init_keyed(&heap, NULL);
+    if (items == NULL || order == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        order[i] = i;
+        items[i].priority = rand() % items_count;
+        indexed_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        indexed_binary_heap_node_set_key_u64(&items[i].heap_node, (uint64_t)items[i].priority);
+        indexed_binary_heap_push(&heap, &items[i].heap_node);
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        item_t* item = &items[rand() % items_count];
+        item->priority = rand() % items_count;
+        indexed_binary_heap_node_set_key_u64(&item->heap_node, (uint64_t)item->priority);
+    }
+    if (0 != indexed_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap state is invalid after update\n", __func__);
+        goto free_mem;
+    }
+
+    shuffle_array(order, items_count);
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        indexed_binary_heap_remove(&heap, &items[order[i]].heap_node);
+        if (i % 1024 == 0 && 0 != indexed_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap state is invalid after remove\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    if (indexed_binary_heap_size(&heap) != 0)
+    {
+        printf("%s test FAILED: heap size expected to be 0\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    indexed_binary_heap_destroy(&heap);
+    free(items);
+    free(order);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_indexed_binary_heap_push_pop_random_items();
+    test_indexed_binary_heap_priority_collision_handled_in_push_order();
+    test_indexed_binary_heap_build_random_items();
+    test_indexed_binary_heap_build_skips_inserted_nodes();
+    test_indexed_binary_heap_random_remove_and_update();
+}
@@ -1,16 +1,111 @@
+// snapshot maps files with POSIX calls, which strict ISO C modes do not declare
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "linked_binary_heap.h"
 
 #include <inttypes.h>
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define LINKED_BINARY_HEAP_SNAPSHOT_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #if defined(LINKED_BINARY_HEAP_DEBUG)
 #define LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS
+#define LINKED_BINARY_HEAP_VERIFY_LINEAR_FUNCTIONS
+#elif defined(LINKED_BINARY_HEAP_DEBUG_LOCAL)
+// only nodes touched by mutation are verified in O(log n), whole heap is verified every period mutations
+#define LINKED_BINARY_HEAP_VERIFY_LOCAL
+#define LINKED_BINARY_HEAP_VERIFY_LINEAR_FUNCTIONS
+#if !defined(LINKED_BINARY_HEAP_DEBUG_FULL_VERIFY_PERIOD)
+#define LINKED_BINARY_HEAP_DEBUG_FULL_VERIFY_PERIOD 4096
+#endif
+#endif
+
+// capacity of small heap mode set by init, it changes only the initial value of heap field and not the heap layout
+#if !defined(LINKED_BINARY_HEAP_SMALL_DEFAULT_CAPACITY)
+#define LINKED_BINARY_HEAP_SMALL_DEFAULT_CAPACITY 0
+#endif
+
+#if defined(LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+#define LINKED_BINARY_HEAP_VERIFY_LINKS(heap, node) \
+do { (void)(node); linked_binary_heap_node_verify_connectivity((heap), (heap)->root); } while (0)
+#define LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node) \
+do { (void)(node); linked_binary_heap_verify(heap); } while (0)
+#elif defined(LINKED_BINARY_HEAP_VERIFY_LOCAL)
+#define LINKED_BINARY_HEAP_VERIFY_LINKS(heap, node) \
+do { linked_binary_heap_node_verify_path_links((heap), (node)); } while (0)
+#define LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node) \
+do { linked_binary_heap_verify_local((heap), (node)); } while (0)
+#else
+#define LINKED_BINARY_HEAP_VERIFY_LINKS(heap, node) \
+do { (void)(heap); (void)(node); } while (0)
+#define LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node) \
+do { (void)(heap); (void)(node); } while (0)
+#endif
+
+#if defined(LINKED_BINARY_HEAP_STATS)
+#define LINKED_BINARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (heap)->stats.counter += (value); } while (0)
+#define LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap) \
+do { if ((heap)->size > (heap)->stats.peak_size) { (heap)->stats.peak_size = (heap)->size; } } while (0)
+#else
+#define LINKED_BINARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (void)(heap); } while (0)
+#define LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap) \
+do { (void)(heap); } while (0)
+#endif
+
+#if defined(LINKED_BINARY_HEAP_STATS) && defined(LINKED_BINARY_HEAP_STATS_LATENCY)
+#include <time.h>
+#define LINKED_BINARY_HEAP_LATENCY_BEGIN() \
+const uint64_t latency_start_ns = linked_binary_heap_stats_now_ns()
+#define LINKED_BINARY_HEAP_LATENCY_END(heap, operation) \
+linked_binary_heap_stats_record_latency((heap), (operation), linked_binary_heap_stats_now_ns() - latency_start_ns)
+#else
+#define LINKED_BINARY_HEAP_LATENCY_BEGIN() \
+do { } while (0)
+#define LINKED_BINARY_HEAP_LATENCY_END(heap, operation) \
+do { (void)(heap); } while (0)
 #endif
 
+// push_batch heapifies appended nodes when batch size is at least heap size divided by this ratio
+#define LINKED_BINARY_HEAP_BATCH_BUILD_RATIO 4
+
+// node was removed in lazy remove mode, but is still linked into the heap
+#define LINKED_BINARY_HEAP_NODE_DEAD 0x1u
+
+#define LINKED_BINARY_HEAP_SNAPSHOT_MAGIC "LBHSNAP"
+
+#define LINKED_BINARY_HEAP_SNAPSHOT_VERSION 1
+
+// snapshot entry is u64 key, u32 sequence, u32 padding and data record padded to 8 bytes
+#define LINKED_BINARY_HEAP_SNAPSHOT_ENTRY_HEADER_SIZE 16
+
+// header of snapshot file, followed by count entries in level order
+typedef struct linked_binary_heap_snapshot_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t key_type;
+    uint64_t count;
+    uint32_t mod_count;
+    uint32_t record_size;
+} linked_binary_heap_snapshot_header_t;
+
 #define UINT32_GT(a, b) (((b) - (a)) & 0x80000000)
 
+#define UINT64_SIGN_BIT (((uint64_t)1) << 63)
+
 #if defined(NDEBUG)
 #define ASSERT_WITH_MSG(expression, msg) \
 do { (void)((void) (expression), (void)(msg)); } while (0)
@@ -30,10 +125,21 @@ linked_binary_heap_node_compare_data(
     {
         return 0;
     }
-    const int cmp = comparer(a->data, b->data);
-    if (cmp != 0)
+    if (comparer == NULL)
+    {
+        // keyed heap, keys are stored in the nodes themselves
+        if (a->key != b->key)
+        {
+            return a->key < b->key ? -1 : 1;
+        }
+    }
+    else
     {
-        return cmp;
+        const int cmp = comparer(a->data, b->data);
+        if (cmp != 0)
+        {
+            return cmp;
+        }
     }
     if (a->sequence == b->sequence)
     {
@@ -45,80 +151,175 @@ linked_binary_heap_node_compare_data(
 }
 
 
+static inline int
+linked_binary_heap_compare(
+    linked_binary_heap_t* heap,
+    const linked_binary_heap_node_t* a,
+    const linked_binary_heap_node_t* b)
+{
+    LINKED_BINARY_HEAP_STATS_ADD(heap, comparisons, 1);
+    return linked_binary_heap_node_compare_data(heap->comparer, a, b);
+}
+
+
+#if defined(LINKED_BINARY_HEAP_STATS) && defined(LINKED_BINARY_HEAP_STATS_LATENCY)
+static uint64_t
+linked_binary_heap_stats_now_ns(void)
+{
+    struct timespec now;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    timespec_get(&now, TIME_UTC);
+#endif
+    return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+
+static void
+linked_binary_heap_stats_record_latency(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_stats_operation_t operation,
+    uint64_t latency_ns)
+{
+    uint32_t bucket = 0;
+    while (latency_ns > 1)
+    {
+        latency_ns >>= 1;
+        bucket++;
+    }
+    heap->stats.latency[operation][bucket] += 1;
+}
+#endif
+
+
+// walks subtree in pre-order following parent pointers back up, so corrupted or degenerate tree can not overflow the stack
 static int
-linked_binary_heap_node_verify_priorities(
+linked_binary_heap_node_verify_subtree(
     const linked_binary_heap_t* heap,
-    const linked_binary_heap_node_t* node)
+    const linked_binary_heap_node_t* top,
+    int check_priorities,
+    size_t* out_count,
+    size_t* out_dead_count)
 {
     ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
-    if (node == NULL)
+    size_t count = 0;
+    size_t dead_count = 0;
+    const linked_binary_heap_node_t* node = top;
+    while (node != NULL)
     {
-        return 0;
-    }
+        if (heap != node->heap)
+        {
+            ASSERT_WITH_MSG(0, "Node must have pointer to heap");
+            return -1;
+        }
+        if (node == heap->root && node->parent != NULL)
+        {
+            ASSERT_WITH_MSG(0, "Root node must have parent set to NULL");
+            return -1;
+        }
+        if (check_priorities && node != top
+            && linked_binary_heap_node_compare_data(heap->comparer, node->parent, node) > 0)
+        {
+            ASSERT_WITH_MSG(0, "Node's parent has bigger priority");
+            return -1;
+        }
+        count += 1;
+        dead_count += (node->flags & LINKED_BINARY_HEAP_NODE_DEAD) ? 1 : 0;
 
-    if (node->parent != NULL && linked_binary_heap_node_compare_data(heap->comparer, node->parent, node) > 0)
-    {
-        ASSERT_WITH_MSG(0, "Node's parent has bigger priority");
-        return -1;
-    }
+        if (node->left != NULL && node->left == node->right)
+        {
+            ASSERT_WITH_MSG(0, "Left and right subtrees are the same node");
+            return -1;
+        }
+        if (node->left != NULL && node->left->parent != node)
+        {
+            ASSERT_WITH_MSG(0, "Left subtree has wrong pointer to parent");
+            return -1;
+        }
+        if (node->right != NULL && node->right->parent != node)
+        {
+            ASSERT_WITH_MSG(0, "Right substree has wrong pointer to parent");
+            return -1;
+        }
+        if (node->left != NULL || node->right != NULL)
+        {
+            node = node->left != NULL ? node->left : node->right;
+            continue;
+        }
 
-    int err = 0;
-    if (err == 0 && node->left != NULL)
+        // climb until an ancestor with not visited right subtree is found
+        const linked_binary_heap_node_t* next = NULL;
+        while (next == NULL && node != top)
+        {
+            const linked_binary_heap_node_t* const parent = node->parent;
+            if (node == parent->left)
+            {
+                next = parent->right;
+            }
+            node = parent;
+        }
+        node = next;
+    }
+    if (out_count != NULL)
     {
-        err = linked_binary_heap_node_verify_priorities(heap, node->left);
+        *out_count = count;
     }
-    if (err == 0 && node->right != NULL)
+    if (out_dead_count != NULL)
     {
-        err = linked_binary_heap_node_verify_priorities(heap, node->right);
+        *out_dead_count = dead_count;
     }
-    return err;
+    return 0;
 }
 
 
+#if defined(LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
 static int
 linked_binary_heap_node_verify_connectivity(
     const linked_binary_heap_t* heap,
     const linked_binary_heap_node_t* node)
 {
-    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
-    if (node == NULL)
-    {
-        return 0;
-    }
-    if (heap != node->heap)
-    {
-        ASSERT_WITH_MSG(0, "Node must have pointer to heap");
-        return -1;
-    }
-    if (node == heap->root && node->parent != NULL)
-    {
-        ASSERT_WITH_MSG(0, "Root node must have parent set to NULL");
-        return -1;
-    }
+    return linked_binary_heap_node_verify_subtree(heap, node, 0, NULL, NULL);
+}
+#endif
+
 
-    int err = 0;
-    if (err == 0 && node->left != NULL)
+#if defined(LINKED_BINARY_HEAP_VERIFY_LOCAL)
+// checks links of the node and of its ancestors up to the root
+static int
+linked_binary_heap_node_verify_path_links(
+    const linked_binary_heap_t* heap,
+    const linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    const uint32_t max_depth = sizeof(size_t) * 8;
+    for (uint32_t depth = 0; node != NULL; depth++)
     {
-        if (node->left->parent != node)
+        if (depth > max_depth)
         {
-            ASSERT_WITH_MSG(0, "Left subtree has wrong pointer to parent");
+            ASSERT_WITH_MSG(0, "Path to the root is longer than maximal depth");
             return -1;
         }
-        err = linked_binary_heap_node_verify_connectivity(heap, node->left);
-    }
-
-    if (err == 0 && node->right != NULL)
-    {
-        if (node->right->parent != node)
+        if (heap != node->heap)
         {
-            ASSERT_WITH_MSG(0, "Right substree has wrong pointer to parent");
+            ASSERT_WITH_MSG(0, "Node must have pointer to heap");
+            return -1;
+        }
+        if ((node->left != NULL && node->left->parent != node) || (node->right != NULL && node->right->parent != node))
+        {
+            ASSERT_WITH_MSG(0, "Child has wrong pointer to parent");
+            return -1;
+        }
+        if (node->parent == NULL ? node != heap->root : (node->parent->left != node && node->parent->right != node))
+        {
+            ASSERT_WITH_MSG(0, "Parent has no pointer to the node");
             return -1;
         }
-        err = linked_binary_heap_node_verify_connectivity(heap, node->right);
+        node = node->parent;
     }
-
-    return err;
+    return 0;
 }
+#endif
 
 
 static void
@@ -172,6 +373,9 @@ linked_binary_heap_node_swap_non_adjacent(
         }
     }
 
+    LINKED_BINARY_HEAP_STATS_ADD(heap, swaps, 1);
+    LINKED_BINARY_HEAP_STATS_ADD(heap, swap_non_adjacent_calls, 1);
+
     linked_binary_heap_node_t** b_from_parent = NULL;
     if (b_parent != NULL)
     {
@@ -228,7 +432,7 @@ linked_binary_heap_node_swap_non_adjacent(
         *a_from_parent = b;
     }
 
-    // maybe update root
+    // maybe update root and last
     if (heap->root == a)
     {
         heap->root = b;
@@ -237,9 +441,16 @@ linked_binary_heap_node_swap_non_adjacent(
     {
         heap->root = a;
     }
-#if defined(LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
-    linked_binary_heap_node_verify_connectivity(heap, heap->root);
-#endif
+    if (heap->last == a)
+    {
+        heap->last = b;
+    }
+    else if (heap->last == b)
+    {
+        heap->last = a;
+    }
+    LINKED_BINARY_HEAP_VERIFY_LINKS(heap, a);
+    LINKED_BINARY_HEAP_VERIFY_LINKS(heap, b);
 }
 
 
@@ -290,6 +501,9 @@ linked_binary_heap_node_swap_with_parent(
         }
     }
 
+    LINKED_BINARY_HEAP_STATS_ADD(heap, swaps, 1);
+    LINKED_BINARY_HEAP_STATS_ADD(heap, swap_with_parent_calls, 1);
+
     // updated pointers (up to 10)
     node->parent = parent_parent;
     if (parent_parent_child != NULL)
@@ -333,10 +547,13 @@ linked_binary_heap_node_swap_with_parent(
     {
         heap->root = node;
     }
+    if (heap->last == node)
+    {
+        heap->last = parent;
+    }
 
-#if defined(LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
-    linked_binary_heap_node_verify_connectivity(heap, heap->root);
-#endif
+    // path from the parent goes through the node
+    LINKED_BINARY_HEAP_VERIFY_LINKS(heap, parent);
 }
 
 
@@ -387,16 +604,166 @@ linked_binary_heap_bubble_up(
     ASSERT_WITH_MSG(heap != NULL, "heap pointer must not be null");
     ASSERT_WITH_MSG(node != NULL, "node pointer must not be null");
 
-    const linked_binary_heap_node_data_comparer comparer = heap->comparer;
-    linked_binary_heap_node_t *n = node;
-    while (n->parent != NULL)
+    // find the highest ancestor to be displaced using comparisons only
+    linked_binary_heap_node_t* top = node->parent;
+    if (top == NULL || linked_binary_heap_compare(heap, node, top) > 0)
+    {
+        return;
+    }
+    uint32_t levels = 1;
+    while (top->parent != NULL && linked_binary_heap_compare(heap, node, top->parent) <= 0)
+    {
+        top = top->parent;
+        levels++;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, swaps, levels);
+    LINKED_BINARY_HEAP_STATS_ADD(heap, sift_up_levels, levels);
+
+    // shift every ancestor on the path one level down, bottom to top,
+    // left/right hold children of the position the ancestor moves into
+    linked_binary_heap_node_t* const top_parent = top->parent;
+    linked_binary_heap_node_t* left = node->left;
+    linked_binary_heap_node_t* right = node->right;
+    linked_binary_heap_node_t* below = node;
+    linked_binary_heap_node_t* ancestor = node->parent;
+    const linked_binary_heap_node_t* const lowest = ancestor;
+    if (heap->last == node)
+    {
+        heap->last = ancestor;
+    }
+    for (;;)
     {
-        if (linked_binary_heap_node_compare_data(comparer, n, n->parent) > 0)
+        linked_binary_heap_node_t* const next = ancestor->parent;
+        const int from_left = (ancestor->left == below);
+        linked_binary_heap_node_t* const sibling = from_left ? ancestor->right : ancestor->left;
+
+        ancestor->left = left;
+        if (left != NULL)
+        {
+            left->parent = ancestor;
+        }
+        ancestor->right = right;
+        if (right != NULL)
+        {
+            right->parent = ancestor;
+        }
+
+        if (from_left)
+        {
+            left = ancestor;
+            right = sibling;
+        }
+        else
+        {
+            left = sibling;
+            right = ancestor;
+        }
+        if (ancestor == top)
         {
             break;
         }
-        linked_binary_heap_node_swap_with_parent(heap, n);
+        below = ancestor;
+        ancestor = next;
+    }
+
+    // node takes place of the top ancestor
+    node->parent = top_parent;
+    if (top_parent == NULL)
+    {
+        heap->root = node;
+    }
+    else if (top_parent->left == top)
+    {
+        top_parent->left = node;
+    }
+    else
+    {
+        top_parent->right = node;
+    }
+    node->left = left;
+    left->parent = node;
+    node->right = right;
+    if (right != NULL)
+    {
+        right->parent = node;
+    }
+
+    // path from the lowest shifted ancestor goes through the node
+    LINKED_BINARY_HEAP_VERIFY_LINKS(heap, lowest);
+}
+
+
+static void
+linked_binary_heap_shift_path_up(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node,
+    size_t path,
+    uint32_t depth)
+{
+    if (depth == 0)
+    {
+        return;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, swaps, depth);
+    LINKED_BINARY_HEAP_STATS_ADD(heap, sift_down_levels, depth);
+
+    // shift every child on the path one level up, top to bottom,
+    // left/right hold children of the position the child moves out of
+    linked_binary_heap_node_t* parent = node->parent;
+    linked_binary_heap_node_t** link = &heap->root;
+    if (parent != NULL)
+    {
+        link = (parent->left == node) ? &parent->left : &parent->right;
+    }
+    linked_binary_heap_node_t* left = node->left;
+    linked_binary_heap_node_t* right = node->right;
+    for (uint32_t i = 0; i < depth; i++)
+    {
+        const int to_right = (path & (((size_t)1) << i)) != 0;
+        linked_binary_heap_node_t* const child = to_right ? right : left;
+        linked_binary_heap_node_t* const sibling = to_right ? left : right;
+        left = child->left;
+        right = child->right;
+
+        *link = child;
+        child->parent = parent;
+        if (to_right)
+        {
+            child->left = sibling;
+            link = &child->right;
+        }
+        else
+        {
+            child->right = sibling;
+            link = &child->left;
+        }
+        if (sibling != NULL)
+        {
+            sibling->parent = child;
+        }
+        parent = child;
+    }
+
+    // node takes place of the last shifted child
+    if (heap->last == parent)
+    {
+        heap->last = node;
+    }
+    *link = node;
+    node->parent = parent;
+    node->left = left;
+    if (left != NULL)
+    {
+        left->parent = node;
+    }
+    node->right = right;
+    if (right != NULL)
+    {
+        right->parent = node;
     }
+
+    // path from the node goes through every shifted child
+    LINKED_BINARY_HEAP_VERIFY_LINKS(heap, node);
 }
 
 
@@ -412,296 +779,1857 @@ linked_binary_heap_bubble_down(
     // be sufficiently enough, but having depth limit might prevent
     // some infinite loop bugs in any.
     const uint32_t max_depth = sizeof(size_t) * 8;
-    const linked_binary_heap_node_data_comparer comparer = heap->comparer;
-    for (uint32_t depth = 0; depth < max_depth; depth++)
+
+    // find final position using comparisons only, remember taken direction per level
+    size_t path = 0;
+    uint32_t depth = 0;
+    const linked_binary_heap_node_t* position = node;
+    for (; depth < max_depth; depth++)
     {
-        linked_binary_heap_node_t* smallest = node;
-        if (node->left != NULL && linked_binary_heap_node_compare_data(comparer, node->left, smallest) < 0)
+        const linked_binary_heap_node_t* smallest = node;
+        if (position->left != NULL && linked_binary_heap_compare(heap, position->left, smallest) < 0)
         {
-            smallest = node->left;
+            smallest = position->left;
         }
-        if (node->right != NULL && linked_binary_heap_node_compare_data(comparer, node->right, smallest) < 0)
+        if (position->right != NULL && linked_binary_heap_compare(heap, position->right, smallest) < 0)
         {
-            smallest = node->right;
+            smallest = position->right;
         }
         if (smallest == node)
         {
-            return;
+            break;
+        }
+        if (smallest == position->right)
+        {
+            path |= ((size_t)1) << depth;
         }
-        linked_binary_heap_node_swap_with_parent(heap, smallest);
+        position = smallest;
     }
+    linked_binary_heap_shift_path_up(heap, node, path, depth);
 }
 
 
-static size_t
-linked_binary_heap_node_parent_index(size_t index)
+static void
+linked_binary_heap_bubble_down_bottom_up(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
 {
-    ASSERT_WITH_MSG(index != 0, "parent of 0 node is undefined");
-    return (index - 1) / 2;
-}
-
+    ASSERT_WITH_MSG(heap != NULL, "heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "node pointer must not be null");
 
-static size_t
-linked_binary_heap_node_count_descendants(const linked_binary_heap_node_t* node)
-{
-    if (node == NULL)
+    // Floyd's bottom-up sift: node replacing removed one is a former leaf and most
+    // likely returns close to the leaves, so the chain of smaller children is followed
+    // to a leaf with one comparison per level, then node's place is found going back up
+    const uint32_t max_depth = sizeof(size_t) * 8;
+    size_t path = 0;
+    uint32_t depth = 0;
+    const linked_binary_heap_node_t* position = node;
+    for (; depth < max_depth && position->left != NULL; depth++)
     {
-        return 0;
+        if (position->right != NULL
+            && linked_binary_heap_compare(heap, position->right, position->left) < 0)
+        {
+            path |= ((size_t)1) << depth;
+            position = position->right;
+        }
+        else
+        {
+            position = position->left;
+        }
+    }
+    while (depth > 0 && linked_binary_heap_compare(heap, node, position) < 0)
+    {
+        position = position->parent;
+        depth--;
     }
-    return 1
-        + linked_binary_heap_node_count_descendants(node->left)
-        + linked_binary_heap_node_count_descendants(node->right);
+    linked_binary_heap_shift_path_up(heap, node, path, depth);
 }
 
 
 static void
-linked_binary_heap_node_print(linked_binary_heap_node_t *node, uint32_t space)
+linked_binary_heap_sift_replacement(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
 {
-    if (node == NULL)
-    {
-        return;
-    }
-    const uint32_t indent = 10;
-
-    space += indent;
-
-    linked_binary_heap_node_print(node->right, space);
-
-    printf("\n");
-    for (uint32_t i = indent; i < space; i++)
-    {
-        printf(" ");
-    }
-    if (node->heap->data_visualizer != NULL)
+    if (heap->pop_mode == LINKED_BINARY_HEAP_POP_BOTTOM_UP)
     {
-        char vis[11] = {0};
-        node->heap->data_visualizer(node->data, sizeof(vis) - 1, vis);
-        vis[sizeof(vis)-1] = 0;
-        printf("%s\n", vis);
+        linked_binary_heap_bubble_down_bottom_up(heap, node);
     }
     else
     {
-        printf("%p\n", node->data);
+        linked_binary_heap_bubble_down(heap, node);
     }
-    linked_binary_heap_node_print(node->left, space);
 }
 
 
-void
-linked_binary_heap_node_get_traverse_path_from_index(
-    size_t index,
-    size_t* out_path,
+static size_t
+linked_binary_heap_node_parent_index(size_t index)
+{
+    ASSERT_WITH_MSG(index != 0, "parent of 0 node is undefined");
+    return (index - 1) / 2;
+}
+
+
+static linked_binary_heap_node_t*
+linked_binary_heap_node_predecessor(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(node != NULL && node->parent != NULL, "root node does not have predecessor");
+
+    // previous node in level order, amortized O(1) for consecutive calls
+    if (node->parent->right == node)
+    {
+        return node->parent->left;
+    }
+    linked_binary_heap_node_t* n = node;
+    uint32_t levels = 0;
+    while (n->parent != NULL && n->parent->left == n)
+    {
+        n = n->parent;
+        levels++;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, levels);
+    if (n->parent == NULL)
+    {
+        // node is the first on its level, predecessor is the last node of the level above
+        levels--;
+    }
+    else
+    {
+        n = n->parent->left;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, levels);
+    for (uint32_t i = 0; i < levels; i++)
+    {
+        n = n->right;
+    }
+    return n;
+}
+
+
+static linked_binary_heap_node_t*
+linked_binary_heap_node_successor(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(node != NULL, "node pointer must not be null");
+
+    // next node in level order, amortized O(1) for consecutive calls, next node must exist
+    if (node->parent != NULL && node->parent->left == node)
+    {
+        return node->parent->right;
+    }
+    linked_binary_heap_node_t* n = node;
+    uint32_t levels = 0;
+    while (n->parent != NULL && n->parent->right == n)
+    {
+        n = n->parent;
+        levels++;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, levels);
+    if (n->parent == NULL)
+    {
+        // node is the last on its level, successor is the first node of the level below
+        levels++;
+    }
+    else
+    {
+        n = n->parent->right;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, levels);
+    for (uint32_t i = 0; i < levels; i++)
+    {
+        n = n->left;
+    }
+    return n;
+}
+
+
+static linked_binary_heap_node_t*
+linked_binary_heap_next_parent(
+    linked_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap->last != NULL, "heap must not be empty");
+
+    // parent of the next free slot in level order, amortized O(1) for consecutive calls
+    linked_binary_heap_node_t* n = heap->last;
+    if (n->parent == NULL)
+    {
+        return n;
+    }
+    if (n->parent->left == n)
+    {
+        return n->parent;
+    }
+    uint32_t levels = 0;
+    while (n->parent != NULL && n->parent->right == n)
+    {
+        n = n->parent;
+        levels++;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, levels);
+    if (n->parent == NULL)
+    {
+        // the last level is full, next slot starts a new level
+        levels++;
+    }
+    else
+    {
+        n = n->parent->right;
+    }
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, levels - 1);
+    for (uint32_t i = 1; i < levels; i++)
+    {
+        n = n->left;
+    }
+    return n;
+}
+
+
+static void
+linked_binary_heap_link_next(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    if (heap->last == NULL)
+    {
+        heap->root = node;
+        node->parent = NULL;
+    }
+    else
+    {
+        linked_binary_heap_node_t* const parent = linked_binary_heap_next_parent(heap);
+        if (parent->left == NULL)
+        {
+            parent->left = node;
+        }
+        else
+        {
+            parent->right = node;
+        }
+        node->parent = parent;
+    }
+    heap->last = node;
+}
+
+
+static int
+linked_binary_heap_node_subtree_has_index_since(size_t index, size_t since, size_t size)
+{
+    // indices in a subtree grow with depth, so only the deepest present level matters
+    size_t first = index;
+    size_t width = 1;
+    while (2 * first + 1 < size)
+    {
+        first = 2 * first + 1;
+        width *= 2;
+    }
+    const size_t last = first + width - 1 < size - 1 ? first + width - 1 : size - 1;
+    return last >= since;
+}
+
+
+static void
+linked_binary_heap_heapify_since(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node,
+    size_t index,
+    size_t since)
+{
+    ASSERT_WITH_MSG(heap != NULL, "heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "node pointer must not be null");
+
+    // Floyd's heapify restricted to subtrees containing nodes with index >= since,
+    // all other subtrees already satisfy heap property. Subtrees made only of appended
+    // nodes cost O(m) in total, each of O(log n) their common ancestors sifts down
+    // up to O(log n) levels, so m nodes appended to heap of n cost O(m + log^2 n).
+    const size_t left_index = 2 * index + 1;
+    const size_t right_index = left_index + 1;
+    if (node->left != NULL
+        && (left_index >= since || linked_binary_heap_node_subtree_has_index_since(left_index, since, heap->size)))
+    {
+        linked_binary_heap_heapify_since(heap, node->left, left_index, since);
+    }
+    if (node->right != NULL
+        && (right_index >= since || linked_binary_heap_node_subtree_has_index_since(right_index, since, heap->size)))
+    {
+        linked_binary_heap_heapify_since(heap, node->right, right_index, since);
+    }
+    linked_binary_heap_bubble_down(heap, node);
+}
+
+
+// returns the last node moved into place of the unlinked one, null if no node was moved
+static linked_binary_heap_node_t*
+linked_binary_heap_unlink(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    linked_binary_heap_node_t* relocated = NULL;
+    heap->size -= 1;
+    heap->mod_count += 1;
+    if (heap->size > 0)
+    {
+        linked_binary_heap_node_t* const last_node = heap->last;
+        linked_binary_heap_node_swap_nodes(heap, node, last_node);
+        ASSERT_WITH_MSG(heap->last == node, "Removed node must be moved to the last position");
+        heap->last = linked_binary_heap_node_predecessor(heap, node);
+        if (node->parent->left == node)
+        {
+            node->parent->left = NULL;
+        }
+        else if (node->parent->right == node)
+        {
+            node->parent->right = NULL;
+        }
+        else
+        {
+            ASSERT_WITH_MSG(0, "Wrong link from parent node");
+            return NULL;
+        }
+
+        if (last_node != node)
+        {
+            linked_binary_heap_sift_replacement(heap, last_node);
+            linked_binary_heap_bubble_up(heap, last_node);
+            relocated = last_node;
+        }
+    }
+    else
+    {
+        heap->root = NULL;
+        heap->last = NULL;
+    }
+
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = NULL;
+    node->heap = NULL;
+    node->sequence = 0;
+    node->flags = 0;
+    return relocated;
+}
+
+
+static void
+linked_binary_heap_discard_dead_root(
+    linked_binary_heap_t* heap)
+{
+    // root is never dead, so peek returns live node without modifying the heap
+    while (heap->root != NULL && (heap->root->flags & LINKED_BINARY_HEAP_NODE_DEAD))
+    {
+        linked_binary_heap_node_t* const node = heap->root;
+        linked_binary_heap_unlink(heap, node);
+        heap->dead_count -= 1;
+        if (heap->discarder != NULL)
+        {
+            heap->discarder(node);
+        }
+    }
+}
+
+
+static void
+linked_binary_heap_compact(
+    linked_binary_heap_t* heap)
+{
+    // all nodes are detached in level order like in meld, live ones are linked back
+    // keeping their sequences, so push order of equal priorities is preserved
+    linked_binary_heap_node_t* list = NULL;
+    while (heap->last != NULL)
+    {
+        linked_binary_heap_node_t* const node = heap->last;
+        if (node->parent == NULL)
+        {
+            heap->root = NULL;
+            heap->last = NULL;
+        }
+        else
+        {
+            heap->last = linked_binary_heap_node_predecessor(heap, node);
+            if (node->parent->left == node)
+            {
+                node->parent->left = NULL;
+            }
+            else
+            {
+                node->parent->right = NULL;
+            }
+        }
+        node->left = list;
+        list = node;
+    }
+
+    linked_binary_heap_node_t* dead = NULL;
+    heap->size = 0;
+    while (list != NULL)
+    {
+        linked_binary_heap_node_t* const node = list;
+        list = node->left;
+        node->left = NULL;
+        if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+        {
+            node->left = dead;
+            dead = node;
+            continue;
+        }
+        linked_binary_heap_link_next(heap, node);
+        heap->size += 1;
+    }
+    heap->dead_count = 0;
+    if (heap->root != NULL)
+    {
+        linked_binary_heap_heapify_since(heap, heap->root, 0, 0);
+    }
+
+    // discarder is called once the heap is consistent, it may free the node
+    while (dead != NULL)
+    {
+        linked_binary_heap_node_t* const node = dead;
+        dead = node->left;
+        node->left = NULL;
+        node->parent = NULL;
+        node->heap = NULL;
+        node->sequence = 0;
+        node->flags = 0;
+        if (heap->discarder != NULL)
+        {
+            heap->discarder(node);
+        }
+    }
+}
+
+
+static int
+linked_binary_heap_is_small(
+    const linked_binary_heap_t* heap)
+{
+    // nodes of small heap are in the sorted array and not linked into the tree
+    return heap->root == NULL && heap->size > 0;
+}
+
+
+static void
+linked_binary_heap_small_insert(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    // insertion sort, the smallest node is at the end of the array, so it is popped without moving others
+    size_t i = heap->size;
+    while (i > 0 && linked_binary_heap_compare(heap, heap->small[i - 1], node) < 0)
+    {
+        heap->small[i] = heap->small[i - 1];
+        i--;
+    }
+    heap->small[i] = node;
+    heap->size += 1;
+}
+
+
+static void
+linked_binary_heap_small_erase(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    size_t i = heap->size;
+    while (i > 0 && heap->small[i - 1] != node)
+    {
+        i--;
+    }
+    ASSERT_WITH_MSG(i > 0, "Node must be stored in small heap array");
+    for (; i < heap->size; i++)
+    {
+        heap->small[i - 1] = heap->small[i];
+    }
+    heap->size -= 1;
+}
+
+
+static void
+linked_binary_heap_small_reposition(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    linked_binary_heap_small_erase(heap, node);
+    linked_binary_heap_small_insert(heap, node);
+}
+
+
+static void
+linked_binary_heap_small_promote(
+    linked_binary_heap_t* heap)
+{
+    if (!linked_binary_heap_is_small(heap))
+    {
+        return;
+    }
+    // array sorted in pop order linked in level order already satisfies heap property
+    for (size_t i = heap->size; i > 0; i--)
+    {
+        linked_binary_heap_link_next(heap, heap->small[i - 1]);
+    }
+}
+
+
+static void
+linked_binary_heap_small_demote(
+    linked_binary_heap_t* heap)
+{
+    // half of capacity is left free, so heap size oscillating around capacity does not convert on every push and pop
+    if (heap->root == NULL || heap->size > heap->small_capacity / 2 || heap->dead_count > 0)
+    {
+        return;
+    }
+    linked_binary_heap_node_t* list = NULL;
+    while (heap->last != NULL)
+    {
+        linked_binary_heap_node_t* const node = heap->last;
+        if (node->parent == NULL)
+        {
+            heap->root = NULL;
+            heap->last = NULL;
+        }
+        else
+        {
+            heap->last = linked_binary_heap_node_predecessor(heap, node);
+            if (node->parent->left == node)
+            {
+                node->parent->left = NULL;
+            }
+            else
+            {
+                node->parent->right = NULL;
+            }
+        }
+        node->parent = NULL;
+        node->left = list;
+        list = node;
+    }
+    heap->size = 0;
+    while (list != NULL)
+    {
+        linked_binary_heap_node_t* const node = list;
+        list = node->left;
+        node->left = NULL;
+        linked_binary_heap_small_insert(heap, node);
+    }
+}
+
+
+// checks last node is at position size - 1 in level order and has no children
+static int
+linked_binary_heap_verify_last(
+    const linked_binary_heap_t* heap)
+{
+    const linked_binary_heap_node_t* last = NULL;
+    if (heap->size > 0)
+    {
+        size_t path = 0;
+        uint8_t depth = 0;
+        linked_binary_heap_node_get_traverse_path_from_index(heap->size - 1, &path, &depth);
+        last = heap->root;
+        for (uint8_t i = 0; i < depth && last != NULL; i++)
+        {
+            last = (path & (((size_t)1) << i)) ? last->right : last->left;
+        }
+    }
+    if (last != heap->last)
+    {
+        ASSERT_WITH_MSG(0, "Last node pointer does not match last node in level order");
+        return -1;
+    }
+    if (last != NULL && (last->left != NULL || last->right != NULL))
+    {
+        ASSERT_WITH_MSG(0, "Last node must not have children");
+        return -1;
+    }
+    return 0;
+}
+
+
+#if defined(LINKED_BINARY_HEAP_VERIFY_LOCAL)
+// checks root, last node and the node touched by mutation in O(log n), the whole heap every period mutations
+static int
+linked_binary_heap_verify_local(
+    const linked_binary_heap_t* heap,
+    const linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if ((LINKED_BINARY_HEAP_DEBUG_FULL_VERIFY_PERIOD > 0 && heap->mod_count % LINKED_BINARY_HEAP_DEBUG_FULL_VERIFY_PERIOD == 0)
+        || linked_binary_heap_is_small(heap))
+    {
+        return linked_binary_heap_verify(heap);
+    }
+
+    const linked_binary_heap_node_t* const root = heap->root;
+    if ((root == NULL) != (heap->size == 0) || heap->dead_count > heap->size)
+    {
+        ASSERT_WITH_MSG(0, "Root node does not match declared nodes count");
+        return -1;
+    }
+    if (root != NULL && (root->parent != NULL || (root->flags & LINKED_BINARY_HEAP_NODE_DEAD)))
+    {
+        ASSERT_WITH_MSG(0, "Root node must have no parent and must not be dead");
+        return -1;
+    }
+    int err = linked_binary_heap_verify_last(heap);
+    if (err == 0 && heap->last != NULL)
+    {
+        err = linked_binary_heap_node_verify_path_links(heap, heap->last);
+    }
+    if (err != 0 || node == NULL || node->heap != heap)
+    {
+        return err;
+    }
+
+    // node is in order with its parent and children
+    err = linked_binary_heap_node_verify_path_links(heap, node);
+    if (err == 0
+        && ((node->parent != NULL && linked_binary_heap_node_compare_data(heap->comparer, node->parent, node) > 0)
+            || (node->left != NULL && linked_binary_heap_node_compare_data(heap->comparer, node, node->left) > 0)
+            || (node->right != NULL && linked_binary_heap_node_compare_data(heap->comparer, node, node->right) > 0)))
+    {
+        ASSERT_WITH_MSG(0, "Node is out of order with its parent or children");
+        return -1;
+    }
+    return err;
+}
+#endif
+
+
+static void
+linked_binary_heap_node_print(linked_binary_heap_node_t *node, uint32_t space)
+{
+    if (node == NULL)
+    {
+        return;
+    }
+    const uint32_t indent = 10;
+
+    space += indent;
+
+    linked_binary_heap_node_print(node->right, space);
+
+    printf("\n");
+    for (uint32_t i = indent; i < space; i++)
+    {
+        printf(" ");
+    }
+    if (node->heap->data_visualizer != NULL)
+    {
+        char vis[11] = {0};
+        node->heap->data_visualizer(node->data, sizeof(vis) - 1, vis);
+        vis[sizeof(vis)-1] = 0;
+        printf("%s\n", vis);
+    }
+    else if (node->heap->key_type == LINKED_BINARY_HEAP_KEY_U64)
+    {
+        printf("%" PRIu64 "\n", linked_binary_heap_node_get_key_u64(node));
+    }
+    else if (node->heap->key_type == LINKED_BINARY_HEAP_KEY_I64)
+    {
+        printf("%" PRId64 "\n", linked_binary_heap_node_get_key_i64(node));
+    }
+    else if (node->heap->key_type == LINKED_BINARY_HEAP_KEY_F64)
+    {
+        printf("%g\n", linked_binary_heap_node_get_key_f64(node));
+    }
+    else
+    {
+        printf("%p\n", node->data);
+    }
+    linked_binary_heap_node_print(node->left, space);
+}
+
+
+void
+linked_binary_heap_node_get_traverse_path_from_index(
+    size_t index,
+    size_t* out_path,
     uint8_t* out_depth)
 {
-    size_t path = 0;
-    uint8_t depth = 0;
-    size_t parent = index;
-    while (parent != 0)
+    size_t path = 0;
+    uint8_t depth = 0;
+    size_t parent = index;
+    while (parent != 0)
+    {
+        path = path << 1;
+        path |= (parent % 2 == 0 ? 1 : 0);
+        parent = linked_binary_heap_node_parent_index(parent);
+        depth++;
+    }
+    *out_path = path;
+    *out_depth = depth;
+}
+
+
+int
+linked_binary_heap_get_node_by_index(
+    linked_binary_heap_t* heap,
+    size_t index,
+    linked_binary_heap_node_t **out_parent,
+    linked_binary_heap_node_t ***out_node)
+{
+    if (out_parent == NULL || out_node == NULL || index > heap->size)
+    {
+        return -1;
+    }
+    if (linked_binary_heap_is_small(heap))
+    {
+        // array sorted in pop order is in level order from its end, so the query does not convert the heap
+        if (index == heap->size)
+        {
+            return -1;
+        }
+        *out_parent = index == 0 ? NULL : heap->small[heap->size - 1 - linked_binary_heap_node_parent_index(index)];
+        *out_node = &heap->small[heap->size - 1 - index];
+        return 0;
+    }
+
+    size_t path = 0;
+    uint8_t depth = 0;
+    linked_binary_heap_node_get_traverse_path_from_index(index, &path, &depth);
+    LINKED_BINARY_HEAP_STATS_ADD(heap, path_walk_levels, depth);
+
+    linked_binary_heap_node_t *parent = NULL, **node = &heap->root;
+    for (uint8_t i = 0; i < depth; i++)
+    {
+        parent = *node;
+        if (path & (((size_t)1) << i))
+        {
+            node = &parent->right;
+        }
+        else
+        {
+            node = &parent->left;
+        }
+    }
+    *out_parent = parent;
+    *out_node = node;
+    return 0;
+}
+
+
+void
+linked_binary_heap_init(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_data_comparer comparer,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    memset(heap, 0, sizeof(*heap));
+    heap->comparer = comparer;
+    heap->data_visualizer = data_visualizer;
+    heap->small_capacity = LINKED_BINARY_HEAP_SMALL_DEFAULT_CAPACITY;
+}
+
+
+void
+linked_binary_heap_init_keyed(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_key_type_t key_type,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    ASSERT_WITH_MSG(key_type != LINKED_BINARY_HEAP_KEY_NONE, "Keyed heap requires key type");
+    memset(heap, 0, sizeof(*heap));
+    heap->key_type = key_type;
+    heap->data_visualizer = data_visualizer;
+    heap->small_capacity = LINKED_BINARY_HEAP_SMALL_DEFAULT_CAPACITY;
+}
+
+
+void
+linked_binary_heap_node_init(
+    linked_binary_heap_node_t* node,
+    void* data)
+{
+    memset(node, 0, sizeof(*node));
+    node->data = data;
+}
+
+
+static void
+linked_binary_heap_update_node(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    heap->mod_count += 1;
+    if (linked_binary_heap_is_small(heap))
+    {
+        linked_binary_heap_small_reposition(heap, node);
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+        return;
+    }
+    if (node->parent != NULL && linked_binary_heap_compare(heap, node, node->parent) < 0)
+    {
+        linked_binary_heap_bubble_up(heap, node);
+    }
+    else
+    {
+        linked_binary_heap_bubble_down(heap, node);
+    }
+    linked_binary_heap_discard_dead_root(heap);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+}
+
+
+static void
+linked_binary_heap_node_set_key(
+    linked_binary_heap_node_t* node,
+    uint64_t key)
+{
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->heap == NULL)
+    {
+        node->key = key;
+        return;
+    }
+    ASSERT_WITH_MSG(node->heap->comparer == NULL, "Node must belong to keyed heap");
+    if (node->key == key)
+    {
+        return;
+    }
+    const int decreased = key < node->key;
+    node->key = key;
+    if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+    {
+        // dead node still takes part in comparisons, so it is moved too and discarded if it reaches the root
+        linked_binary_heap_update_node(node->heap, node);
+    }
+    else if (decreased)
+    {
+        linked_binary_heap_decrease(node->heap, node);
+    }
+    else
+    {
+        linked_binary_heap_increase(node->heap, node);
+    }
+}
+
+
+void
+linked_binary_heap_node_set_key_u64(
+    linked_binary_heap_node_t* node,
+    uint64_t key)
+{
+    linked_binary_heap_node_set_key(node, key);
+}
+
+
+void
+linked_binary_heap_node_set_key_i64(
+    linked_binary_heap_node_t* node,
+    int64_t key)
+{
+    // flipping sign bit maps two's complement order onto unsigned order
+    linked_binary_heap_node_set_key(node, ((uint64_t)key) ^ UINT64_SIGN_BIT);
+}
+
+
+void
+linked_binary_heap_node_set_key_f64(
+    linked_binary_heap_node_t* node,
+    double key)
+{
+    // IEEE 754 bits of non-negative values are ordered as unsigned integers,
+    // negative values are ordered in reverse, so all their bits are flipped
+    uint64_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    bits = (bits & UINT64_SIGN_BIT) ? ~bits : (bits ^ UINT64_SIGN_BIT);
+    linked_binary_heap_node_set_key(node, bits);
+}
+
+
+uint64_t
+linked_binary_heap_node_get_key_u64(
+    const linked_binary_heap_node_t* node)
+{
+    return node->key;
+}
+
+
+int64_t
+linked_binary_heap_node_get_key_i64(
+    const linked_binary_heap_node_t* node)
+{
+    return (int64_t)(node->key ^ UINT64_SIGN_BIT);
+}
+
+
+double
+linked_binary_heap_node_get_key_f64(
+    const linked_binary_heap_node_t* node)
+{
+    const uint64_t bits = (node->key & UINT64_SIGN_BIT) ? (node->key ^ UINT64_SIGN_BIT) : ~node->key;
+    double key;
+    memcpy(&key, &bits, sizeof(key));
+    return key;
+}
+
+
+void
+linked_binary_heap_set_pop_mode(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_pop_mode_t pop_mode)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    heap->pop_mode = pop_mode;
+}
+
+
+void
+linked_binary_heap_set_small_capacity(
+    linked_binary_heap_t* heap,
+    uint32_t capacity)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(capacity <= LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY, "Small heap capacity must not exceed size of its array");
+    if (capacity > LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY)
+    {
+        capacity = LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY;
+    }
+    heap->small_capacity = capacity;
+    if (heap->size > capacity)
+    {
+        linked_binary_heap_small_promote(heap);
+    }
+    linked_binary_heap_small_demote(heap);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, NULL);
+}
+
+
+void
+linked_binary_heap_set_lazy_remove(
+    linked_binary_heap_t* heap,
+    uint32_t max_dead_percent,
+    linked_binary_heap_node_discarder discarder)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(max_dead_percent <= 100, "Percent of dead nodes must not exceed 100");
+    heap->max_dead_percent = max_dead_percent;
+    heap->discarder = discarder;
+    if (max_dead_percent == 0 && heap->dead_count > 0)
+    {
+        linked_binary_heap_compact(heap);
+    }
+}
+
+
+size_t
+linked_binary_heap_size(
+    const linked_binary_heap_t* heap)
+{
+    return heap->size - heap->dead_count;
+}
+
+
+size_t
+linked_binary_heap_dead_size(
+    const linked_binary_heap_t* heap)
+{
+    return heap->dead_count;
+}
+
+
+uint32_t
+linked_binary_heap_version(
+    const linked_binary_heap_t* heap)
+{
+    return heap->mod_count;
+}
+
+
+int
+linked_binary_heap_contains_node(
+    const linked_binary_heap_t* heap,
+    const linked_binary_heap_node_t* node)
+{
+    return heap == node->heap && !(node->flags & LINKED_BINARY_HEAP_NODE_DEAD);
+}
+
+
+void
+linked_binary_heap_build(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t** nodes,
+    size_t count)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(nodes != NULL || count == 0, "Nodes pointer must not be null");
+    if (count == 0)
+    {
+        return;
+    }
+    linked_binary_heap_small_promote(heap);
+
+    // link nodes into complete tree shape in level order, node is marked as inserted
+    // when linked, so nodes of any heap and repeated entries of the array are skipped
+    const size_t old_size = heap->size;
+    size_t since = old_size;
+    for (size_t i = 0; i < count; i++)
+    {
+        linked_binary_heap_node_t* const node = nodes[i];
+        if (node->heap == heap && (node->flags & LINKED_BINARY_HEAP_NODE_DEAD))
+        {
+            // dead node is revived in place like by push, its key may have been changed while it was dead,
+            // as may keys of other revived nodes it would be compared with, so the whole heap is heapified
+            node->flags &= ~LINKED_BINARY_HEAP_NODE_DEAD;
+            heap->dead_count -= 1;
+            node->sequence = heap->mod_count;
+            heap->mod_count += 1;
+            since = 0;
+            continue;
+        }
+        if (node->heap != NULL)
+        {
+            continue;
+        }
+        node->heap = heap;
+        node->left = NULL;
+        node->right = NULL;
+        node->sequence = heap->mod_count;
+        heap->mod_count += 1;
+        linked_binary_heap_link_next(heap, node);
+        heap->size += 1;
+    }
+    if (heap->size > old_size)
+    {
+        LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap);
+    }
+    if (heap->size > since)
+    {
+        linked_binary_heap_heapify_since(heap, heap->root, 0, since);
+    }
+    linked_binary_heap_discard_dead_root(heap);
+#if defined(LINKED_BINARY_HEAP_VERIFY_LINEAR_FUNCTIONS)
+    linked_binary_heap_verify(heap);
+#endif
+}
+
+
+static void
+linked_binary_heap_remove_node(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+    if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+    {
+        ASSERT_WITH_MSG(0, "Node is already removed from the heap");
+        return;
+    }
+
+    if (linked_binary_heap_is_small(heap))
+    {
+        linked_binary_heap_small_erase(heap, node);
+        heap->mod_count += 1;
+        node->heap = NULL;
+        node->sequence = 0;
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, NULL);
+        return;
+    }
+
+    linked_binary_heap_node_t* relocated = NULL;
+    if (heap->max_dead_percent > 0 && node != heap->root)
+    {
+        // node is left in place, it is discarded once it reaches the root or by compaction
+        node->flags |= LINKED_BINARY_HEAP_NODE_DEAD;
+        heap->dead_count += 1;
+        heap->mod_count += 1;
+        if (heap->dead_count * 100 > heap->size * heap->max_dead_percent)
+        {
+            linked_binary_heap_compact(heap);
+        }
+    }
+    else
+    {
+        relocated = linked_binary_heap_unlink(heap, node);
+        if (relocated != NULL && (relocated->flags & LINKED_BINARY_HEAP_NODE_DEAD))
+        {
+            // dead node may be discarded and released below, so only live node moved into the hole is checked
+            relocated = NULL;
+        }
+        linked_binary_heap_discard_dead_root(heap);
+    }
+    linked_binary_heap_small_demote(heap);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, relocated);
+}
+
+
+void
+linked_binary_heap_remove(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    LINKED_BINARY_HEAP_LATENCY_BEGIN();
+    linked_binary_heap_remove_node(heap, node);
+    LINKED_BINARY_HEAP_LATENCY_END(heap, LINKED_BINARY_HEAP_STATS_REMOVE);
+}
+
+
+void
+linked_binary_heap_update(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+    if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+    {
+        ASSERT_WITH_MSG(0, "Node is already removed from the heap");
+        return;
+    }
+    LINKED_BINARY_HEAP_LATENCY_BEGIN();
+    linked_binary_heap_update_node(heap, node);
+    LINKED_BINARY_HEAP_LATENCY_END(heap, LINKED_BINARY_HEAP_STATS_UPDATE);
+}
+
+
+void
+linked_binary_heap_decrease(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+    if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+    {
+        ASSERT_WITH_MSG(0, "Node is already removed from the heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    if (linked_binary_heap_is_small(heap))
+    {
+        linked_binary_heap_small_reposition(heap, node);
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+        return;
+    }
+    linked_binary_heap_bubble_up(heap, node);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+}
+
+
+void
+linked_binary_heap_increase(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (heap != node->heap)
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+    if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+    {
+        ASSERT_WITH_MSG(0, "Node is already removed from the heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    if (linked_binary_heap_is_small(heap))
+    {
+        linked_binary_heap_small_reposition(heap, node);
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+        return;
+    }
+    linked_binary_heap_bubble_down(heap, node);
+    linked_binary_heap_discard_dead_root(heap);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+}
+
+
+int
+linked_binary_heap_peek(
+    const linked_binary_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (linked_binary_heap_is_small(heap))
+    {
+        *out_node = heap->small[heap->size - 1];
+        return 0;
+    }
+    if (heap->size > 0)
+    {
+        ASSERT_WITH_MSG(heap->root != NULL, "Heap root must be not null when size is not 0");
+        *out_node = heap->root;
+        return 0;
+    }
+    return -1;
+}
+
+
+int
+linked_binary_heap_pop(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (0 != linked_binary_heap_peek(heap, out_node))
+    {
+        return -1;
+    }
+    LINKED_BINARY_HEAP_LATENCY_BEGIN();
+    linked_binary_heap_remove_node(heap, *out_node);
+    LINKED_BINARY_HEAP_LATENCY_END(heap, LINKED_BINARY_HEAP_STATS_POP);
+    return 0;
+}
+
+
+void
+linked_binary_heap_meld(
+    linked_binary_heap_t* dst,
+    linked_binary_heap_t* src)
+{
+    ASSERT_WITH_MSG(dst != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(src != NULL, "Heap pointer must not be null");
+    if (dst->comparer != src->comparer || dst->key_type != src->key_type)
+    {
+        ASSERT_WITH_MSG(0, "Heaps must have the same ordering");
+        return;
+    }
+    if (dst == src || src->size == 0)
+    {
+        return;
+    }
+    linked_binary_heap_small_promote(dst);
+    linked_binary_heap_small_promote(src);
+
+    // detach nodes of src starting from the last one, prepending them to a list
+    // linked through left pointers gives the list in level order,
+    // the oldest sequence in src is found on the way, dead nodes of src
+    // are collected apart and discarded by src, so dst gets live nodes only
+    linked_binary_heap_node_t* list = NULL;
+    linked_binary_heap_node_t* dead = NULL;
+    uint32_t oldest = src->mod_count;
+    while (src->last != NULL)
+    {
+        linked_binary_heap_node_t* const node = src->last;
+        if (node->parent == NULL)
+        {
+            src->root = NULL;
+            src->last = NULL;
+        }
+        else
+        {
+            src->last = linked_binary_heap_node_predecessor(src, node);
+            if (node->parent->left == node)
+            {
+                node->parent->left = NULL;
+            }
+            else
+            {
+                node->parent->right = NULL;
+            }
+        }
+        if (node->flags & LINKED_BINARY_HEAP_NODE_DEAD)
+        {
+            node->left = dead;
+            dead = node;
+            continue;
+        }
+        if (UINT32_GT(oldest, node->sequence))
+        {
+            oldest = node->sequence;
+        }
+        node->left = list;
+        list = node;
+    }
+
+    // src sequences are shifted past every sequence of dst, so equal priorities
+    // pop dst nodes first and src nodes in their original push order
+    const size_t old_size = dst->size;
+    const uint32_t base = dst->mod_count;
+    while (list != NULL)
+    {
+        linked_binary_heap_node_t* const node = list;
+        list = node->left;
+        node->left = NULL;
+        node->heap = dst;
+        node->sequence = base + (node->sequence - oldest);
+        linked_binary_heap_link_next(dst, node);
+    }
+    dst->size += src->size - src->dead_count;
+    LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(dst);
+    dst->mod_count = base + (src->mod_count - oldest) + 1;
+    src->size = 0;
+    src->dead_count = 0;
+    src->mod_count += 1;
+
+    if (dst->size > old_size)
+    {
+        linked_binary_heap_heapify_since(dst, dst->root, 0, old_size);
+    }
+    linked_binary_heap_discard_dead_root(dst);
+#if defined(LINKED_BINARY_HEAP_VERIFY_LINEAR_FUNCTIONS)
+    linked_binary_heap_verify(dst);
+    linked_binary_heap_verify(src);
+#endif
+
+    // discarder is called once both heaps are consistent, it may free the node
+    while (dead != NULL)
+    {
+        linked_binary_heap_node_t* const node = dead;
+        dead = node->left;
+        node->left = NULL;
+        node->parent = NULL;
+        node->heap = NULL;
+        node->sequence = 0;
+        node->flags = 0;
+        if (src->discarder != NULL)
+        {
+            src->discarder(node);
+        }
+    }
+}
+
+
+void
+linked_binary_heap_push_batch(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t** nodes,
+    size_t count)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(nodes != NULL || count == 0, "Nodes pointer must not be null");
+    if (heap->root == NULL && heap->size + count <= heap->small_capacity)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (nodes[i]->heap == NULL)
+            {
+                linked_binary_heap_push(heap, nodes[i]);
+            }
+        }
+        return;
+    }
+    linked_binary_heap_small_promote(heap);
+    if (count * LINKED_BINARY_HEAP_BATCH_BUILD_RATIO >= heap->size)
+    {
+        // sequences are assigned in batch order, so heapify gives the same pop order as pushes
+        linked_binary_heap_build(heap, nodes, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        linked_binary_heap_node_t* const node = nodes[i];
+        if (node->heap == heap && (node->flags & LINKED_BINARY_HEAP_NODE_DEAD))
+        {
+            // dead node is revived in place like by push
+            node->flags &= ~LINKED_BINARY_HEAP_NODE_DEAD;
+            heap->dead_count -= 1;
+            node->sequence = heap->mod_count;
+            linked_binary_heap_update_node(heap, node);
+            continue;
+        }
+        if (node->heap != NULL)
+        {
+            // skipped like in build, so both paths push the same nodes
+            continue;
+        }
+        node->heap = heap;
+        node->left = NULL;
+        node->right = NULL;
+        linked_binary_heap_link_next(heap, node);
+        node->sequence = heap->mod_count;
+        heap->size += 1;
+        heap->mod_count += 1;
+        LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap);
+        linked_binary_heap_bubble_up(heap, node);
+    }
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, NULL);
+}
+
+
+size_t
+linked_binary_heap_pop_batch(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t** out_nodes,
+    size_t max_count)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_nodes != NULL || max_count == 0, "Pointer to out nodes must not be null");
+    size_t count = 0;
+    linked_binary_heap_node_t* relocated = NULL;
+    if (linked_binary_heap_is_small(heap))
+    {
+        // smallest node is at the end of sorted array, so nodes are taken from the end without shifting the rest
+        for (; count < max_count && heap->size > 0; count++)
+        {
+            heap->size -= 1;
+            linked_binary_heap_node_t* const node = heap->small[heap->size];
+            node->heap = NULL;
+            node->sequence = 0;
+            out_nodes[count] = node;
+        }
+        if (count > 0)
+        {
+            heap->mod_count += 1;
+        }
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, NULL);
+        return count;
+    }
+    for (; count < max_count && heap->size > 0; count++)
+    {
+        // last node is detached and takes links of the root directly, unlike remove
+        // of arbitrary node it never needs general swap or bubble up
+        linked_binary_heap_node_t* const root = heap->root;
+        heap->size -= 1;
+        if (heap->size == 0)
+        {
+            heap->root = NULL;
+            heap->last = NULL;
+        }
+        else
+        {
+            linked_binary_heap_node_t* const last_node = heap->last;
+            heap->last = linked_binary_heap_node_predecessor(heap, last_node);
+            if (last_node->parent->left == last_node)
+            {
+                last_node->parent->left = NULL;
+            }
+            else
+            {
+                last_node->parent->right = NULL;
+            }
+            last_node->parent = NULL;
+            last_node->left = root->left;
+            last_node->right = root->right;
+            if (last_node->left != NULL)
+            {
+                last_node->left->parent = last_node;
+            }
+            if (last_node->right != NULL)
+            {
+                last_node->right->parent = last_node;
+            }
+            heap->root = last_node;
+            if (heap->last == root)
+            {
+                heap->last = last_node;
+            }
+            linked_binary_heap_sift_replacement(heap, last_node);
+            relocated = (last_node->flags & LINKED_BINARY_HEAP_NODE_DEAD) ? NULL : last_node;
+        }
+
+        root->left = NULL;
+        root->right = NULL;
+        root->parent = NULL;
+        root->heap = NULL;
+        root->sequence = 0;
+        out_nodes[count] = root;
+        linked_binary_heap_discard_dead_root(heap);
+    }
+    // whole batch is a single modification of the heap
+    if (count > 0)
     {
-        path = path << 1;
-        path |= (parent % 2 == 0 ? 1 : 0);
-        parent = linked_binary_heap_node_parent_index(parent);
-        depth++;
+        heap->mod_count += 1;
     }
-    *out_path = path;
-    *out_depth = depth;
+    linked_binary_heap_small_demote(heap);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, relocated);
+    return count;
 }
 
 
 int
-linked_binary_heap_get_node_by_index(
+linked_binary_heap_replace_top(
     linked_binary_heap_t* heap,
-    size_t index,
-    linked_binary_heap_node_t **out_parent,
-    linked_binary_heap_node_t ***out_node)
+    linked_binary_heap_node_t* node,
+    linked_binary_heap_node_t** out_node)
 {
-    if (out_parent == NULL || out_node == NULL || index > heap->size)
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (0 != linked_binary_heap_peek(heap, out_node))
     {
         return -1;
     }
-
-    size_t path = 0;
-    uint8_t depth = 0;
-    linked_binary_heap_node_get_traverse_path_from_index(index, &path, &depth);
-
-    linked_binary_heap_node_t *parent = NULL, **node = &heap->root;
-    for (uint8_t i = 0; i < depth; i++)
+    linked_binary_heap_node_t* const root = *out_node;
+    if (linked_binary_heap_is_small(heap))
     {
-        parent = *node;
-        if (path & (((size_t)1) << i))
+        if (node != root && node->heap != NULL)
         {
-            node = &parent->right;
+            ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+            return -1;
         }
-        else
+        // size is unchanged, so small heap stays an array
+        linked_binary_heap_small_erase(heap, root);
+        root->heap = NULL;
+        root->sequence = 0;
+        node->heap = heap;
+        node->sequence = heap->mod_count;
+        heap->mod_count += 1;
+        linked_binary_heap_small_insert(heap, node);
+        if (node == root)
         {
-            node = &parent->left;
+            *out_node = NULL;
         }
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+        return 0;
     }
-    *out_parent = parent;
-    *out_node = node;
+    if (node == root)
+    {
+        // re-push of the root, e.g. rescheduled timer, is a move down with the new sequence,
+        // nothing is detached from the heap
+        node->sequence = heap->mod_count;
+        heap->mod_count += 1;
+        linked_binary_heap_bubble_down(heap, node);
+        linked_binary_heap_discard_dead_root(heap);
+        *out_node = NULL;
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+        return 0;
+    }
+    if (node->heap != NULL)
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return -1;
+    }
+
+    // new node takes links of the root, size and last position are unchanged
+    node->heap = heap;
+    node->parent = NULL;
+    node->left = root->left;
+    node->right = root->right;
+    if (node->left != NULL)
+    {
+        node->left->parent = node;
+    }
+    if (node->right != NULL)
+    {
+        node->right->parent = node;
+    }
+    heap->root = node;
+    if (heap->last == root)
+    {
+        heap->last = node;
+    }
+    node->sequence = heap->mod_count;
+    heap->mod_count += 1;
+    linked_binary_heap_bubble_down(heap, node);
+
+    root->left = NULL;
+    root->right = NULL;
+    root->parent = NULL;
+    root->heap = NULL;
+    root->sequence = 0;
+    linked_binary_heap_discard_dead_root(heap);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
     return 0;
 }
 
 
 void
-linked_binary_heap_init(
+linked_binary_heap_pushpop(
     linked_binary_heap_t* heap,
-    linked_binary_heap_node_data_comparer comparer,
-    linked_binary_heap_node_data_visualizer data_visualizer)
-{
-    memset(heap, 0, sizeof(*heap));
-    heap->comparer = comparer;
-    heap->data_visualizer = data_visualizer;
-}
-
-
-void
-linked_binary_heap_node_init(
     linked_binary_heap_node_t* node,
-    void* data)
+    linked_binary_heap_node_t** out_node)
 {
-    memset(node, 0, sizeof(*node));
-    node->data = data;
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    ASSERT_WITH_MSG(node->heap == NULL, "Node is already inserted into the heap");
+
+    // node pushed now is later than any node in the heap, so it loses on equal priorities
+    node->sequence = heap->mod_count;
+    linked_binary_heap_node_t* top;
+    if (0 != linked_binary_heap_peek(heap, &top) || linked_binary_heap_compare(heap, node, top) < 0)
+    {
+        node->sequence = 0;
+        *out_node = node;
+        return;
+    }
+    linked_binary_heap_replace_top(heap, node, out_node);
 }
 
 
-size_t
-linked_binary_heap_size(
-    const linked_binary_heap_t* heap)
+static void
+linked_binary_heap_push_node(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
 {
-    return heap->size;
+    if (node->heap == heap && (node->flags & LINKED_BINARY_HEAP_NODE_DEAD))
+    {
+        // dead node is still linked, so it is revived in place as if pushed now
+        node->flags &= ~LINKED_BINARY_HEAP_NODE_DEAD;
+        heap->dead_count -= 1;
+        node->sequence = heap->mod_count;
+        linked_binary_heap_update_node(heap, node);
+        return;
+    }
+    if (node->heap != NULL)
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return;
+    }
+    if (heap->root == NULL && heap->size < heap->small_capacity)
+    {
+        node->heap = heap;
+        node->sequence = heap->mod_count;
+        heap->mod_count += 1;
+        linked_binary_heap_small_insert(heap, node);
+        LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap);
+        LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
+        return;
+    }
+    linked_binary_heap_small_promote(heap);
+    node->heap = heap;
+    linked_binary_heap_link_next(heap, node);
+    node->sequence = heap->mod_count;
+    heap->size += 1;
+    heap->mod_count += 1;
+    LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap);
+    linked_binary_heap_bubble_up(heap, node);
+    LINKED_BINARY_HEAP_VERIFY_MUTATION(heap, node);
 }
 
-uint32_t
-linked_binary_heap_version(
-    const linked_binary_heap_t* heap)
+
+void
+linked_binary_heap_push(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node)
 {
-    return heap->mod_count;
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    LINKED_BINARY_HEAP_LATENCY_BEGIN();
+    linked_binary_heap_push_node(heap, node);
+    LINKED_BINARY_HEAP_LATENCY_END(heap, LINKED_BINARY_HEAP_STATS_PUSH);
 }
 
 
-int
-linked_binary_heap_contains_node(
-    const linked_binary_heap_t* heap,
-    const linked_binary_heap_node_t* node)
+static linked_binary_heap_node_t*
+linked_binary_heap_level_order_next(
+    linked_binary_heap_t* heap,
+    linked_binary_heap_node_t* node,
+    size_t index)
 {
-    return heap == node->heap;
+    if (linked_binary_heap_is_small(heap))
+    {
+        // array sorted in pop order is level order of a valid heap
+        return heap->small[heap->size - 1 - index];
+    }
+    return index == 0 ? heap->root : linked_binary_heap_node_successor(heap, node);
 }
 
 
-void
-linked_binary_heap_remove(
+int
+linked_binary_heap_snapshot(
     linked_binary_heap_t* heap,
-    linked_binary_heap_node_t* node)
+    const char* path,
+    size_t record_size,
+    linked_binary_heap_node_serializer serializer,
+    void* arg)
 {
-    if (heap != node->heap)
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(path != NULL, "Path must not be null");
+    ASSERT_WITH_MSG(serializer != NULL || record_size == 0, "Serializer must not be null for non empty records");
+    if (record_size > UINT32_MAX)
     {
-        ASSERT_WITH_MSG(0, "Node belong to different heap");
-        return;
+        return -1;
+    }
+    if (heap->dead_count > 0)
+    {
+        linked_binary_heap_compact(heap);
     }
 
-    heap->size -= 1;
-    heap->mod_count += 1;
-    if (heap->size > 0)
+    const size_t entry_size = LINKED_BINARY_HEAP_SNAPSHOT_ENTRY_HEADER_SIZE + ((record_size + 7) & ~(size_t)7);
+    uint8_t* const entry = (uint8_t*)calloc(1, entry_size);
+    FILE* const file = entry != NULL ? fopen(path, "wb") : NULL;
+    if (file == NULL)
     {
-        linked_binary_heap_node_t* parent;
-        linked_binary_heap_node_t* last_node, **last_node_loc;
-        int ret = linked_binary_heap_get_node_by_index(heap, heap->size, &parent, &last_node_loc);
-        ASSERT_WITH_MSG(ret == 0, "Node lookup must succeed");
-        last_node = *last_node_loc;
+        free(entry);
+        return -1;
+    }
 
-        linked_binary_heap_node_swap_nodes(heap, node, last_node);
-        if (node->parent->left == node)
-        {
-            node->parent->left = NULL;
-        }
-        else if (node->parent->right == node)
+    linked_binary_heap_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LINKED_BINARY_HEAP_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = LINKED_BINARY_HEAP_SNAPSHOT_VERSION;
+    header.key_type = (uint32_t)heap->key_type;
+    header.count = heap->size;
+    header.mod_count = heap->mod_count;
+    header.record_size = (uint32_t)record_size;
+    int result = 1 == fwrite(&header, sizeof(header), 1, file) ? 0 : -1;
+
+    linked_binary_heap_node_t* node = NULL;
+    for (size_t i = 0; i < heap->size && result == 0; i++)
+    {
+        node = linked_binary_heap_level_order_next(heap, node, i);
+        memcpy(entry, &node->key, sizeof(node->key));
+        memcpy(entry + sizeof(node->key), &node->sequence, sizeof(node->sequence));
+        if (serializer != NULL)
         {
-            node->parent->right = NULL;
+            serializer(node, entry + LINKED_BINARY_HEAP_SNAPSHOT_ENTRY_HEADER_SIZE, arg);
         }
-        else
+        if (1 != fwrite(entry, entry_size, 1, file))
         {
-            ASSERT_WITH_MSG(0, "Wrong link from parent node");
-            return;
+            result = -1;
         }
+    }
+    if (0 != fclose(file))
+    {
+        result = -1;
+    }
+    free(entry);
+    return result;
+}
 
-        linked_binary_heap_bubble_down(heap, last_node);
-        linked_binary_heap_bubble_up(heap, last_node);
+
+static int
+linked_binary_heap_restore_entries(
+    linked_binary_heap_t* heap,
+    const uint8_t* contents,
+    size_t length,
+    linked_binary_heap_node_deserializer deserializer,
+    void* arg)
+{
+    linked_binary_heap_snapshot_header_t header;
+    if (length < sizeof(header))
+    {
+        return -1;
     }
-    else
+    memcpy(&header, contents, sizeof(header));
+    const size_t entry_size = LINKED_BINARY_HEAP_SNAPSHOT_ENTRY_HEADER_SIZE + ((header.record_size + 7) & ~(size_t)7);
+    if (0 != memcmp(header.magic, LINKED_BINARY_HEAP_SNAPSHOT_MAGIC, sizeof(header.magic))
+        || header.version != LINKED_BINARY_HEAP_SNAPSHOT_VERSION
+        || header.key_type != (uint32_t)heap->key_type
+        || header.count > (length - sizeof(header)) / entry_size)
     {
-        heap->root = NULL;
+        return -1;
     }
 
-    node->left = NULL;
-    node->right = NULL;
-    node->parent = NULL;
-    node->heap = NULL;
-    node->sequence = 0;
-#if defined(LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    // saved level order already satisfies heap property, so nodes are linked without comparisons
+    int result = 0;
+    const uint8_t* entry = contents + sizeof(header);
+    for (uint64_t i = 0; i < header.count; i++, entry += entry_size)
+    {
+        linked_binary_heap_node_t* const node = deserializer(entry + LINKED_BINARY_HEAP_SNAPSHOT_ENTRY_HEADER_SIZE, arg);
+        if (node == NULL || node->heap != NULL)
+        {
+            ASSERT_WITH_MSG(node == NULL, "Node is already inserted into the heap");
+            result = -1;
+            break;
+        }
+        memcpy(&node->key, entry, sizeof(node->key));
+        memcpy(&node->sequence, entry + sizeof(node->key), sizeof(node->sequence));
+        node->heap = heap;
+        node->left = NULL;
+        node->right = NULL;
+        node->flags = 0;
+        linked_binary_heap_link_next(heap, node);
+        heap->size += 1;
+    }
+    heap->mod_count = header.mod_count;
+    LINKED_BINARY_HEAP_STATS_UPDATE_PEAK(heap);
+    linked_binary_heap_small_demote(heap);
+#if defined(LINKED_BINARY_HEAP_VERIFY_LINEAR_FUNCTIONS)
     linked_binary_heap_verify(heap);
 #endif
+    return result;
 }
 
 
 int
-linked_binary_heap_peek(
-    const linked_binary_heap_t* heap,
-    linked_binary_heap_node_t** out_node)
+linked_binary_heap_restore(
+    linked_binary_heap_t* heap,
+    const char* path,
+    linked_binary_heap_node_deserializer deserializer,
+    void* arg)
 {
     ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
-    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
-    if (heap->size > 0)
+    ASSERT_WITH_MSG(path != NULL, "Path must not be null");
+    ASSERT_WITH_MSG(deserializer != NULL, "Deserializer must not be null");
+    if (heap->size != 0)
     {
-        ASSERT_WITH_MSG(heap->root != NULL, "Heap root must be not null when size is not 0");
-        *out_node = heap->root;
-        return 0;
+        ASSERT_WITH_MSG(0, "Heap must be empty");
+        return -1;
     }
-    return -1;
+
+#if defined(LINKED_BINARY_HEAP_SNAPSHOT_MMAP)
+    // file is mapped and read once front to back, so restore is bounded by memory bandwidth
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    struct stat file_stat;
+    if (0 != fstat(fd, &file_stat) || file_stat.st_size <= 0)
+    {
+        close(fd);
+        return -1;
+    }
+    const size_t length = (size_t)file_stat.st_size;
+    void* const contents = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (contents == MAP_FAILED)
+    {
+        return -1;
+    }
+    posix_madvise(contents, length, POSIX_MADV_SEQUENTIAL);
+    const int result = linked_binary_heap_restore_entries(heap, (const uint8_t*)contents, length, deserializer, arg);
+    munmap(contents, length);
+    return result;
+#else
+    FILE* const file = fopen(path, "rb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+    long length = -1;
+    if (0 == fseek(file, 0, SEEK_END))
+    {
+        length = ftell(file);
+    }
+    uint8_t* const contents = length > 0 ? (uint8_t*)malloc((size_t)length) : NULL;
+    const int read = contents != NULL && 0 == fseek(file, 0, SEEK_SET)
+        && 1 == fread(contents, (size_t)length, 1, file);
+    fclose(file);
+    const int result = read ? linked_binary_heap_restore_entries(heap, contents, (size_t)length, deserializer, arg) : -1;
+    free(contents);
+    return result;
+#endif
 }
 
 
-int
-linked_binary_heap_pop(
-    linked_binary_heap_t* heap,
-    linked_binary_heap_node_t** out_node)
+#if defined(LINKED_BINARY_HEAP_STATS)
+void
+linked_binary_heap_get_stats(
+    const linked_binary_heap_t* heap,
+    linked_binary_heap_stats_t* out_stats)
 {
     ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
-    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
-    if (0 != linked_binary_heap_peek(heap, out_node))
-    {
-        return -1;
-    }
-    linked_binary_heap_remove(heap, *out_node);
-    return 0;
+    ASSERT_WITH_MSG(out_stats != NULL, "Pointer to out stats must not be null");
+    *out_stats = heap->stats;
 }
 
 
 void
-linked_binary_heap_push(
-    linked_binary_heap_t* heap,
-    linked_binary_heap_node_t* node)
+linked_binary_heap_reset_stats(
+    linked_binary_heap_t* heap)
 {
     ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
-    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
-    if (node->heap != NULL)
-    {
-        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
-        return;
-    }
-    linked_binary_heap_node_t* parent, **next;
-    linked_binary_heap_get_node_by_index(heap, heap->size, &parent, &next);
-    *next = node;
-    node->heap = heap;
-    node->parent = parent;
-    node->sequence = heap->mod_count;
-    heap->size += 1;
-    heap->mod_count += 1;
-    linked_binary_heap_bubble_up(heap, node);
-#if defined(LINKED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
-    linked_binary_heap_verify(heap);
-#endif
+    memset(&heap->stats, 0, sizeof(heap->stats));
+    heap->stats.peak_size = heap->size;
 }
+#endif
 
 
 int
@@ -710,19 +2638,55 @@ linked_binary_heap_verify(
 {
     ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
 
-    const size_t actual_nodes_count = linked_binary_heap_node_count_descendants(heap->root);
+    if (linked_binary_heap_is_small(heap))
+    {
+        if (heap->size > heap->small_capacity || heap->last != NULL || heap->dead_count != 0)
+        {
+            ASSERT_WITH_MSG(0, "Small heap must fit its array and have no dead nodes");
+            return -1;
+        }
+        for (size_t i = 0; i < heap->size; i++)
+        {
+            const linked_binary_heap_node_t* const node = heap->small[i];
+            if (node->heap != heap || node->parent != NULL || node->left != NULL || node->right != NULL)
+            {
+                ASSERT_WITH_MSG(0, "Node of small heap must not be linked");
+                return -1;
+            }
+            if (i > 0 && linked_binary_heap_node_compare_data(heap->comparer, heap->small[i - 1], node) < 0)
+            {
+                ASSERT_WITH_MSG(0, "Small heap array must be sorted in pop order");
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    size_t actual_nodes_count = 0;
+    size_t actual_dead_count = 0;
+    int err = linked_binary_heap_node_verify_subtree(heap, heap->root, 1, &actual_nodes_count, &actual_dead_count);
+    if (err != 0)
+    {
+        return err;
+    }
     if (actual_nodes_count != heap->size)
     {
         ASSERT_WITH_MSG(0, "Actual and declared nodes count mismatch");
         return -1;
     }
 
-    int err = linked_binary_heap_node_verify_connectivity(heap, heap->root);
-    if (err != 0)
+    if (heap->root != NULL && (heap->root->flags & LINKED_BINARY_HEAP_NODE_DEAD))
     {
-        return err;
+        ASSERT_WITH_MSG(0, "Root node must not be dead");
+        return -1;
+    }
+    if (actual_dead_count != heap->dead_count)
+    {
+        ASSERT_WITH_MSG(0, "Actual and declared dead nodes count mismatch");
+        return -1;
     }
-    return linked_binary_heap_node_verify_priorities(heap, heap->root);
+
+    return linked_binary_heap_verify_last(heap);
 }
 
 
@@ -731,5 +2695,13 @@ linked_binary_heap_print(
     const linked_binary_heap_t* heap)
 {
     ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (linked_binary_heap_is_small(heap))
+    {
+        for (size_t i = heap->size; i > 0; i--)
+        {
+            linked_binary_heap_node_print(heap->small[i - 1], 0);
+        }
+        return;
+    }
     linked_binary_heap_node_print(heap->root, 0);
 }
@@ -4,6 +4,9 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+/* size of sorted array inside the heap, the biggest capacity of small heap mode */
+#define LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY 8
+
 
 typedef struct linked_binary_heap_node linked_binary_heap_node_t;
 
@@ -15,6 +18,31 @@ typedef int (*linked_binary_heap_node_data_comparer)(const void*, const void*);
 /* function to visualize node's data as a string */
 typedef void (*linked_binary_heap_node_data_visualizer)(const void*, size_t max_len, char *out_buffer);
 
+/* function called for removed node when heap discards it in lazy remove mode */
+typedef void (*linked_binary_heap_node_discarder)(linked_binary_heap_node_t*);
+
+/* function writing fixed size record of node's data into heap snapshot */
+typedef void (*linked_binary_heap_node_serializer)(const linked_binary_heap_node_t*, void* out_record, void* arg);
+
+/* function returning initialized node for data record read from heap snapshot, null stops restore */
+typedef linked_binary_heap_node_t* (*linked_binary_heap_node_deserializer)(const void* record, void* arg);
+
+/* type of the key cached in heap nodes, LINKED_BINARY_HEAP_KEY_NONE means nodes are ordered by comparer */
+typedef enum linked_binary_heap_key_type
+{
+    LINKED_BINARY_HEAP_KEY_NONE = 0,
+    LINKED_BINARY_HEAP_KEY_U64,
+    LINKED_BINARY_HEAP_KEY_I64,
+    LINKED_BINARY_HEAP_KEY_F64,
+} linked_binary_heap_key_type_t;
+
+/* way of moving the last node down after it replaced removed node */
+typedef enum linked_binary_heap_pop_mode
+{
+    LINKED_BINARY_HEAP_POP_SIFT_DOWN = 0, /* compare with both children on every level until node is placed */
+    LINKED_BINARY_HEAP_POP_BOTTOM_UP, /* follow smaller children to a leaf and move back up, about half of comparisons */
+} linked_binary_heap_pop_mode_t;
+
 /* structure representing heap node */
 struct linked_binary_heap_node
 {
@@ -23,17 +51,61 @@ struct linked_binary_heap_node
     linked_binary_heap_node_t* left; /* pointer to left child of node in heap, can be null */
     linked_binary_heap_node_t* right; /* pointer to right child of the heap, can be null */
     linked_binary_heap_t* heap; /* pointer to a heap containing this node */
+    uint64_t key; /* order preserving encoding of the node's key, compared instead of data in keyed heaps */
     uint32_t sequence; /* sequence number of this node, used to resolve priority collision in push order */
+    uint32_t flags; /* internal state of the node, e.g. removed but not discarded yet in lazy remove mode */
 };
 
+#if defined(LINKED_BINARY_HEAP_STATS)
+/* operations with latency histograms, recorded only when LINKED_BINARY_HEAP_STATS_LATENCY is defined as well */
+typedef enum linked_binary_heap_stats_operation
+{
+    LINKED_BINARY_HEAP_STATS_PUSH = 0,
+    LINKED_BINARY_HEAP_STATS_POP,
+    LINKED_BINARY_HEAP_STATS_REMOVE,
+    LINKED_BINARY_HEAP_STATS_UPDATE,
+    LINKED_BINARY_HEAP_STATS_OPERATIONS_COUNT
+} linked_binary_heap_stats_operation_t;
+
+/* number of buckets of latency histogram, bucket i counts operations which took [2^i, 2^(i + 1)) ns, bucket 0 counts 0 ns too */
+#define LINKED_BINARY_HEAP_STATS_LATENCY_BUCKETS 64
+
+/* structure holding counters of heap internal operations, only available in stats build */
+typedef struct linked_binary_heap_stats
+{
+    uint64_t swaps; /* number of node swaps executed while restoring heap order, a node moved by one level counts as one swap */
+    uint64_t comparisons; /* number of node comparisons made by heap operations, comparisons of verify are not counted */
+    uint64_t swap_with_parent_calls; /* number of removed nodes swapped with the last node being their child, sifting is counted in levels */
+    uint64_t swap_non_adjacent_calls; /* number of removed nodes swapped with the last node which is not their child */
+    uint64_t sift_up_levels; /* number of levels nodes moved up */
+    uint64_t sift_down_levels; /* number of levels nodes moved down */
+    uint64_t path_walk_levels; /* number of levels walked to find node by level order index or neighbour of node in level order */
+    size_t peak_size; /* maximal number of nodes in the heap since init or reset */
+#if defined(LINKED_BINARY_HEAP_STATS_LATENCY)
+    uint64_t latency[LINKED_BINARY_HEAP_STATS_OPERATIONS_COUNT][LINKED_BINARY_HEAP_STATS_LATENCY_BUCKETS]; /* log2 histograms of operation latency */
+#endif
+} linked_binary_heap_stats_t;
+#endif
+
 /* structure representing heap  */
 struct linked_binary_heap
 {
     linked_binary_heap_node_t* root; /* pointer to root node of the heap */
+    linked_binary_heap_node_t* last; /* pointer to the last node of the heap in level order, null for empty heap */
     uint32_t mod_count; /* number of heap modification operations executed */
     size_t size; /* number of nodes stored in this heap */
-    linked_binary_heap_node_data_comparer comparer; /* function to compare data associated with nodes */
+    linked_binary_heap_node_data_comparer comparer; /* function to compare data associated with nodes, null for keyed heap */
+    linked_binary_heap_key_type_t key_type; /* type of the key cached in nodes of keyed heap */
     linked_binary_heap_node_data_visualizer data_visualizer; /* optional user-provided function to provide human readable representation of node's data */
+    linked_binary_heap_pop_mode_t pop_mode; /* how node replacing popped or removed one is moved down */
+    size_t dead_count; /* number of removed nodes still linked into the heap, counted in size */
+    uint32_t max_dead_percent; /* percent of dead nodes in size triggering compaction, 0 disables lazy remove */
+    linked_binary_heap_node_discarder discarder; /* optional function called for every discarded dead node */
+    uint32_t small_capacity; /* number of nodes kept in the sorted array instead of the tree, 0 disables small heap mode */
+    linked_binary_heap_node_t* small[LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY]; /* nodes of small heap sorted from the last to pop, used while root is null */
+#if defined(LINKED_BINARY_HEAP_STATS)
+    linked_binary_heap_stats_t stats; /* counters of internal operations */
+#endif
 };
 
 
@@ -44,6 +116,8 @@ linked_binary_heap_node_get_traverse_path_from_index(
     uint8_t*);
 
 
+/* finds parent and link to node at level order index, index equal to size gives link of the next pushed node,
+ * in small heap mode link is the entry of sorted array and index equal to size is rejected */
 int
 linked_binary_heap_get_node_by_index(
     linked_binary_heap_t*,
@@ -59,17 +133,90 @@ linked_binary_heap_init(
     linked_binary_heap_node_data_visualizer);
 
 
+/* initializes heap ordered by key cached in nodes instead of comparer */
+void
+linked_binary_heap_init_keyed(
+    linked_binary_heap_t*,
+    linked_binary_heap_key_type_t,
+    linked_binary_heap_node_data_visualizer);
+
+
 void
 linked_binary_heap_node_init(
     linked_binary_heap_node_t*,
     void*);
 
 
+/* key setters of keyed heap nodes, node already inserted into the heap is moved according to the new key */
+void
+linked_binary_heap_node_set_key_u64(
+    linked_binary_heap_node_t*,
+    uint64_t);
+
+
+void
+linked_binary_heap_node_set_key_i64(
+    linked_binary_heap_node_t*,
+    int64_t);
+
+
+void
+linked_binary_heap_node_set_key_f64(
+    linked_binary_heap_node_t*,
+    double);
+
+
+uint64_t
+linked_binary_heap_node_get_key_u64(
+    const linked_binary_heap_node_t*);
+
+
+int64_t
+linked_binary_heap_node_get_key_i64(
+    const linked_binary_heap_node_t*);
+
+
+double
+linked_binary_heap_node_get_key_f64(
+    const linked_binary_heap_node_t*);
+
+
+/* selects how pop and remove move the last node down, bottom up pop pays off with expensive comparer */
+void
+linked_binary_heap_set_pop_mode(
+    linked_binary_heap_t*,
+    linked_binary_heap_pop_mode_t);
+
+
+/* enables small heap mode when capacity is not 0: up to capacity nodes, at most LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY,
+ * are kept in sorted array, heap becomes a tree when it grows past capacity and an array again when it shrinks to half of it */
+void
+linked_binary_heap_set_small_capacity(
+    linked_binary_heap_t*,
+    uint32_t);
+
+
+/* enables lazy remove mode when percent is not 0: removed nodes are only marked dead in O(1), they are discarded
+ * once they reach the root or when heap is compacted after dead nodes exceed given percent of all linked nodes */
+void
+linked_binary_heap_set_lazy_remove(
+    linked_binary_heap_t*,
+    uint32_t,
+    linked_binary_heap_node_discarder);
+
+
+/* number of live nodes in the heap */
 size_t
 linked_binary_heap_size(
     const linked_binary_heap_t*);
 
 
+/* number of removed nodes not discarded yet in lazy remove mode */
+size_t
+linked_binary_heap_dead_size(
+    const linked_binary_heap_t*);
+
+
 uint32_t
 linked_binary_heap_version(
     const linked_binary_heap_t*);
@@ -87,12 +234,46 @@ linked_binary_heap_push(
     linked_binary_heap_node_t*);
 
 
+/* appends array of initialized nodes to the heap and restores heap order in O(n), nodes already inserted into a heap
+ * and repeated entries of the array are skipped, dead nodes of lazy remove mode are revived like by push,
+ * their keys may have changed while they were dead, so reviving any of them heapifies the whole heap */
+void
+linked_binary_heap_build(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t**,
+    size_t);
+
+
+/* removes the node, in lazy remove mode node stays linked as dead until discarded, it must not be pushed into
+ * other heap or freed before discarder is called, pushing it back into the same heap revives it,
+ * update, decrease and increase of dead node are rejected */
 void
 linked_binary_heap_remove(
     linked_binary_heap_t*,
     linked_binary_heap_node_t*);
 
 
+/* restores heap order after priority of the node in the heap was changed in any direction */
+void
+linked_binary_heap_update(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+/* restores heap order after priority of the node was decreased, so it can only move towards the root */
+void
+linked_binary_heap_decrease(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+/* restores heap order after priority of the node was increased, so it can only move towards the leaves */
+void
+linked_binary_heap_increase(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t*);
+
+
 int
 linked_binary_heap_pop(
     linked_binary_heap_t*,
@@ -105,6 +286,89 @@ linked_binary_heap_peek(
     linked_binary_heap_node_t**);
 
 
+/* moves all nodes of the second heap into the first one in O(m + log^2 n), heaps must have the same ordering,
+ * moved nodes are treated as pushed after all nodes of the first heap, keeping their own push order,
+ * dead nodes of the second heap are discarded by its discarder instead of being moved */
+void
+linked_binary_heap_meld(
+    linked_binary_heap_t*,
+    linked_binary_heap_t*);
+
+
+/* pushes array of nodes in order, large batches are appended and heapified at once, nodes already inserted into a heap
+ * and repeated entries of the array are skipped, dead nodes of lazy remove mode are revived like by push */
+void
+linked_binary_heap_push_batch(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t**,
+    size_t);
+
+
+/* pops up to given number of smallest nodes in order, returns number of popped nodes,
+ * batch is counted as one modification, but every popped node still costs a sift, so k nodes take O(k log n) */
+size_t
+linked_binary_heap_pop_batch(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t**,
+    size_t);
+
+
+/* replaces root with the new node using single sift-down and returns removed root, returns -1 if heap is empty,
+ * when the node is the root itself it is moved down as if popped and pushed again and out node is set to null */
+int
+linked_binary_heap_replace_top(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t*,
+    linked_binary_heap_node_t**);
+
+
+/* pushes node and pops the smallest one, node itself is returned without touching the heap when it is the smallest */
+void
+linked_binary_heap_pushpop(
+    linked_binary_heap_t*,
+    linked_binary_heap_node_t*,
+    linked_binary_heap_node_t**);
+
+
+/* writes key, sequence and serialized data record of every node in level order into file, records of record size bytes
+ * are written by serializer which can be null when record size is 0, dead nodes of lazy remove mode are discarded first,
+ * snapshot is in native byte order, returns -1 on I/O failure */
+int
+linked_binary_heap_snapshot(
+    linked_binary_heap_t*,
+    const char*,
+    size_t,
+    linked_binary_heap_node_serializer,
+    void*);
+
+
+/* restores snapshot into empty heap with the same ordering, nodes returned by deserializer are linked in saved order
+ * without comparisons, push order of equal priorities is kept, returns -1 when file can not be read, does not match
+ * the heap or deserializer returns null, nodes restored before failure form a valid heap,
+ * linked_binary_heap_verify checks the snapshot was taken from the heap with the same comparer */
+int
+linked_binary_heap_restore(
+    linked_binary_heap_t*,
+    const char*,
+    linked_binary_heap_node_deserializer,
+    void*);
+
+
+#if defined(LINKED_BINARY_HEAP_STATS)
+/* copies counters of internal operations */
+void
+linked_binary_heap_get_stats(
+    const linked_binary_heap_t*,
+    linked_binary_heap_stats_t*);
+
+
+/* zeroes counters of internal operations, peak size starts from the current size */
+void
+linked_binary_heap_reset_stats(
+    linked_binary_heap_t*);
+#endif
+
+
 int
 linked_binary_heap_verify(
     const linked_binary_heap_t*);
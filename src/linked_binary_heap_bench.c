@@ -0,0 +1,475 @@
+#include "binary_heap_engine.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Microbenchmark of heap operations.
+ *
+ * Every measurement is printed as a single CSV line:
+ *   engine,operation,distribution,size,ops,ns_per_op,comparisons_per_op,swaps_per_op
+ *
+ * Usage: linked_binary_heap_bench|indexed_binary_heap_bench|dary_heap_bench [--min-size N] [--max-size N] [--seed N] [--keyed] [--bottom-up-pop]
+ *
+ * With --keyed the heap is ordered by u64 keys cached in nodes instead of comparer.
+ * With --bottom-up-pop the linked heap moves the last node down bottom up on pop and remove,
+ * compare comparisons_per_op of pop operations with the default run.
+ * Heap engine is selected at compile time, see binary_heap_engine.h.
+ * Timing targets are built without LINKED_BINARY_HEAP_STATS and leave comparisons_per_op and swaps_per_op empty,
+ * *_bench_stats targets count them at the cost of slower ns_per_op.
+ */
+
+/* minimal number of operations measured for every size, small heaps are repeated */
+#define BENCH_MIN_OPS_PER_MEASUREMENT 1000000
+
+/* number of distinct priorities in "duplicates" distribution */
+#define BENCH_DUPLICATES_RANGE 16
+
+typedef struct bench_item
+{
+    binary_heap_node_t heap_node;
+    uint32_t priority;
+} bench_item_t;
+
+
+typedef enum bench_distribution
+{
+    BENCH_DISTRIBUTION_SEQUENTIAL,
+    BENCH_DISTRIBUTION_REVERSE,
+    BENCH_DISTRIBUTION_RANDOM,
+    BENCH_DISTRIBUTION_DUPLICATES,
+    BENCH_DISTRIBUTION_COUNT
+} bench_distribution_t;
+
+
+static const char* const bench_distribution_names[BENCH_DISTRIBUTION_COUNT] = {
+    "sequential",
+    "reverse",
+    "random",
+    "duplicates",
+};
+
+
+typedef struct bench_result
+{
+    uint64_t ops;
+    uint64_t ns;
+    uint64_t comparisons;
+    uint64_t swaps;
+} bench_result_t;
+
+
+static int bench_keyed = 0;
+
+static int bench_bottom_up_pop = 0;
+
+static uint64_t bench_rng_state = 0x9E3779B97F4A7C15ull;
+
+
+static uint64_t
+bench_rand(void)
+{
+    // xorshift64*, reproducible across platforms unlike rand()
+    uint64_t x = bench_rng_state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    bench_rng_state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+
+static uint64_t
+bench_now_ns(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+static int
+bench_item_comparer(const void* x, const void* y)
+{
+    const bench_item_t* X = x;
+    const bench_item_t* Y = y;
+    return (X->priority > Y->priority) - (X->priority < Y->priority);
+}
+
+
+static uint32_t
+bench_priority(bench_distribution_t distribution, size_t i)
+{
+    switch (distribution)
+    {
+    case BENCH_DISTRIBUTION_SEQUENTIAL:
+        return (uint32_t)i;
+    case BENCH_DISTRIBUTION_REVERSE:
+        return (uint32_t)(UINT32_MAX - i);
+    case BENCH_DISTRIBUTION_RANDOM:
+        return (uint32_t)bench_rand();
+    case BENCH_DISTRIBUTION_DUPLICATES:
+    default:
+        return (uint32_t)(bench_rand() % BENCH_DUPLICATES_RANGE);
+    }
+}
+
+
+static void
+bench_shuffle(size_t* a, size_t size)
+{
+    for (size_t i = size - 1; i >= 1; i--)
+    {
+        const size_t j = (size_t)(bench_rand() % (i + 1));
+        const size_t temp = a[j];
+        a[j] = a[i];
+        a[i] = temp;
+    }
+}
+
+
+static uint64_t
+bench_heap_comparisons(const binary_heap_t* heap)
+{
+#if defined(LINKED_BINARY_HEAP_STATS)
+    return heap->stats.comparisons;
+#else
+    (void)heap;
+    return 0;
+#endif
+}
+
+
+static uint64_t
+bench_heap_swaps(const binary_heap_t* heap)
+{
+#if defined(LINKED_BINARY_HEAP_STATS)
+    return heap->stats.swaps;
+#else
+    (void)heap;
+    return 0;
+#endif
+}
+
+
+static void
+bench_set_priority(bench_item_t* item, uint32_t priority)
+{
+    item->priority = priority;
+    if (bench_keyed)
+    {
+        binary_heap_node_set_key_u64(&item->heap_node, priority);
+    }
+}
+
+
+static void
+bench_fill(binary_heap_t* heap, bench_item_t* items, size_t size, bench_distribution_t distribution)
+{
+    if (bench_keyed)
+    {
+        binary_heap_init_keyed(heap, NULL);
+    }
+    else
+    {
+        binary_heap_init(heap, bench_item_comparer, NULL);
+    }
+#if defined(BINARY_HEAP_ENGINE_HAS_BOTTOM_UP_POP)
+    if (bench_bottom_up_pop)
+    {
+        binary_heap_set_bottom_up_pop(heap);
+    }
+#endif
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_node_init(&items[i].heap_node, &items[i]);
+        bench_set_priority(&items[i], bench_priority(distribution, i));
+    }
+}
+
+
+static void
+bench_measure_begin(const binary_heap_t* heap, bench_result_t* result, uint64_t* start_ns)
+{
+    result->comparisons -= bench_heap_comparisons(heap);
+    result->swaps -= bench_heap_swaps(heap);
+    *start_ns = bench_now_ns();
+}
+
+
+static void
+bench_measure_end(const binary_heap_t* heap, bench_result_t* result, uint64_t start_ns, uint64_t ops)
+{
+    result->ns += bench_now_ns() - start_ns;
+    result->comparisons += bench_heap_comparisons(heap);
+    result->swaps += bench_heap_swaps(heap);
+    result->ops += ops;
+}
+
+
+static void
+bench_push(binary_heap_t* heap, bench_item_t* items, size_t size, bench_distribution_t distribution,
+    bench_result_t* result)
+{
+    uint64_t start_ns;
+    bench_fill(heap, items, size, distribution);
+    bench_measure_begin(heap, result, &start_ns);
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_push(heap, &items[i].heap_node);
+    }
+    bench_measure_end(heap, result, start_ns, size);
+    binary_heap_destroy(heap);
+}
+
+
+static void
+bench_build(binary_heap_t* heap, bench_item_t* items, binary_heap_node_t** nodes, size_t size,
+    bench_distribution_t distribution, bench_result_t* result)
+{
+    uint64_t start_ns;
+    bench_fill(heap, items, size, distribution);
+    for (size_t i = 0; i < size; i++)
+    {
+        nodes[i] = &items[i].heap_node;
+    }
+    bench_measure_begin(heap, result, &start_ns);
+    binary_heap_build(heap, nodes, size);
+    bench_measure_end(heap, result, start_ns, size);
+    binary_heap_destroy(heap);
+}
+
+
+static void
+bench_pop_until_empty(binary_heap_t* heap, bench_item_t* items, size_t size, bench_distribution_t distribution,
+    bench_result_t* result)
+{
+    uint64_t start_ns;
+    bench_fill(heap, items, size, distribution);
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_push(heap, &items[i].heap_node);
+    }
+    binary_heap_node_t* node;
+    bench_measure_begin(heap, result, &start_ns);
+    while (0 == binary_heap_pop(heap, &node))
+    {
+    }
+    bench_measure_end(heap, result, start_ns, size);
+    binary_heap_destroy(heap);
+}
+
+
+static void
+bench_pop_push_steady_state(binary_heap_t* heap, bench_item_t* items, size_t size,
+    bench_distribution_t distribution, bench_result_t* result)
+{
+    uint64_t start_ns;
+    bench_fill(heap, items, size, distribution);
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_push(heap, &items[i].heap_node);
+    }
+    binary_heap_node_t* node;
+    bench_measure_begin(heap, result, &start_ns);
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_pop(heap, &node);
+        bench_item_t* item = (bench_item_t*)node->data;
+        // keep distribution going past the initial fill, e.g. sequential keys keep growing
+        bench_set_priority(item, bench_priority(distribution, size + i));
+        binary_heap_push(heap, node);
+    }
+    bench_measure_end(heap, result, start_ns, size);
+    binary_heap_destroy(heap);
+}
+
+
+static void
+bench_random_remove(binary_heap_t* heap, bench_item_t* items, size_t* order, size_t size,
+    bench_distribution_t distribution, bench_result_t* result)
+{
+    uint64_t start_ns;
+    bench_fill(heap, items, size, distribution);
+    for (size_t i = 0; i < size; i++)
+    {
+        order[i] = i;
+        binary_heap_push(heap, &items[i].heap_node);
+    }
+    bench_shuffle(order, size);
+    bench_measure_begin(heap, result, &start_ns);
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_remove(heap, &items[order[i]].heap_node);
+    }
+    bench_measure_end(heap, result, start_ns, size);
+    binary_heap_destroy(heap);
+}
+
+
+static void
+bench_random_update(binary_heap_t* heap, bench_item_t* items, size_t size, bench_distribution_t distribution,
+    bench_result_t* result)
+{
+    uint64_t start_ns;
+    bench_fill(heap, items, size, distribution);
+    for (size_t i = 0; i < size; i++)
+    {
+        binary_heap_push(heap, &items[i].heap_node);
+    }
+    bench_measure_begin(heap, result, &start_ns);
+    for (size_t i = 0; i < size; i++)
+    {
+        bench_item_t* item = &items[bench_rand() % size];
+        if (bench_keyed)
+        {
+            // key setter moves the node itself
+            bench_set_priority(item, bench_priority(distribution, size + i));
+        }
+        else
+        {
+            item->priority = bench_priority(distribution, size + i);
+            binary_heap_update(heap, &item->heap_node);
+        }
+    }
+    bench_measure_end(heap, result, start_ns, size);
+    binary_heap_destroy(heap);
+}
+
+
+static void
+bench_report(const char* operation, bench_distribution_t distribution, size_t size, const bench_result_t* result)
+{
+    const double ops = result->ops > 0 ? (double)result->ops : 1.0;
+    printf("%s%s%s,%s,%s,%zu,%" PRIu64 ",%.2f",
+        BINARY_HEAP_ENGINE_NAME,
+        bench_keyed ? "_keyed" : "",
+        bench_bottom_up_pop ? "_bottom_up" : "",
+        operation,
+        bench_distribution_names[distribution],
+        size,
+        result->ops,
+        (double)result->ns / ops);
+#if defined(LINKED_BINARY_HEAP_STATS)
+    printf(",%.2f,%.2f\n", (double)result->comparisons / ops, (double)result->swaps / ops);
+#else
+    // counters are not collected by timing build, empty columns are not mistaken for zero
+    printf(",,\n");
+#endif
+    fflush(stdout);
+}
+
+
+static int
+bench_parse_size(const char* arg, size_t* out)
+{
+    char* end = NULL;
+    const unsigned long long value = strtoull(arg, &end, 10);
+    if (end == arg || *end != '\0' || value == 0)
+    {
+        return -1;
+    }
+    *out = (size_t)value;
+    return 0;
+}
+
+
+int main(int argc, char** argv)
+{
+    size_t min_size = 10;
+    size_t max_size = 10000000;
+    size_t seed = 42;
+
+    for (int i = 1; i < argc; i++)
+    {
+        size_t* target = NULL;
+        if (strcmp(argv[i], "--keyed") == 0)
+        {
+            bench_keyed = 1;
+            continue;
+        }
+#if defined(BINARY_HEAP_ENGINE_HAS_BOTTOM_UP_POP)
+        if (strcmp(argv[i], "--bottom-up-pop") == 0)
+        {
+            bench_bottom_up_pop = 1;
+            continue;
+        }
+#endif
+        if (strcmp(argv[i], "--min-size") == 0)
+        {
+            target = &min_size;
+        }
+        else if (strcmp(argv[i], "--max-size") == 0)
+        {
+            target = &max_size;
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            target = &seed;
+        }
+        if (target == NULL || i + 1 >= argc || 0 != bench_parse_size(argv[i + 1], target))
+        {
+            fprintf(stderr, "usage: %s [--min-size N] [--max-size N] [--seed N] [--keyed] [--bottom-up-pop]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    bench_item_t* items = (bench_item_t*)malloc(max_size * sizeof(bench_item_t));
+    size_t* order = (size_t*)malloc(max_size * sizeof(size_t));
+    binary_heap_node_t** nodes = (binary_heap_node_t**)malloc(max_size * sizeof(binary_heap_node_t*));
+    if (items == NULL || order == NULL || nodes == NULL)
+    {
+        fprintf(stderr, "failed to allocate memory for %zu items\n", max_size);
+        free(items);
+        free(order);
+        free(nodes);
+        return 1;
+    }
+
+    printf("engine,operation,distribution,size,ops,ns_per_op,comparisons_per_op,swaps_per_op\n");
+
+    binary_heap_t heap;
+    for (size_t size = min_size; size <= max_size; size *= 10)
+    {
+        const size_t rounds = size >= BENCH_MIN_OPS_PER_MEASUREMENT ? 1 : BENCH_MIN_OPS_PER_MEASUREMENT / size;
+        for (int d = 0; d < BENCH_DISTRIBUTION_COUNT; d++)
+        {
+            const bench_distribution_t distribution = (bench_distribution_t)d;
+            bench_result_t push = {0}, build = {0}, pop = {0}, steady = {0}, remove = {0}, update = {0};
+
+            bench_rng_state = 0x9E3779B97F4A7C15ull ^ (uint64_t)seed;
+            for (size_t r = 0; r < rounds; r++)
+            {
+                bench_push(&heap, items, size, distribution, &push);
+                bench_build(&heap, items, nodes, size, distribution, &build);
+                bench_pop_until_empty(&heap, items, size, distribution, &pop);
+                bench_pop_push_steady_state(&heap, items, size, distribution, &steady);
+                bench_random_remove(&heap, items, order, size, distribution, &remove);
+                bench_random_update(&heap, items, size, distribution, &update);
+            }
+            bench_report("push", distribution, size, &push);
+            bench_report("build", distribution, size, &build);
+            bench_report("pop_until_empty", distribution, size, &pop);
+            bench_report("pop_push_steady_state", distribution, size, &steady);
+            bench_report("random_remove", distribution, size, &remove);
+            bench_report("random_update", distribution, size, &update);
+        }
+        if (size > max_size / 10)
+        {
+            break;
+        }
+    }
+
+    free(items);
+    free(order);
+    free(nodes);
+    return 0;
+}
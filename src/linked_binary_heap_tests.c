@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define UINT32_GT(a, b) (((b) - (a)) & 0x80000000)
 
@@ -30,6 +31,24 @@ item_visualizer(const void* x, size_t max_len, char *out_buffer)
 }
 
 
+static uint64_t comparer_calls = 0;
+
+// verify after mutation of debug builds calls the comparer too
+#if defined(LINKED_BINARY_HEAP_DEBUG) || defined(LINKED_BINARY_HEAP_DEBUG_LOCAL)
+#define VERIFY_CALLS_COMPARER 1
+#else
+#define VERIFY_CALLS_COMPARER 0
+#endif
+
+
+int
+counting_item_comparer(const void* x, const void* y)
+{
+    comparer_calls++;
+    return item_comparer(x, y);
+}
+
+
 int
 always_equal_comparer(const void *x, const void *y)
 {
@@ -164,6 +183,7 @@ test_linked_binary_heap_get_node_by_index_simple(void)
     root.heap_node.right = &right.heap_node;
     right.heap_node.parent = &root.heap_node;
     right.heap_node.heap = &heap;
+    heap.last = &right.heap_node;
     heap.size = 3;
     if (0 != linked_binary_heap_verify(&heap))
     {
@@ -284,13 +304,14 @@ test_linked_binary_heap_push_simple(void)
     item3.priority = 5;
     linked_binary_heap_node_init(&item3.heap_node, &item3);
 
+    linked_binary_heap_node_t* top;
     linked_binary_heap_push(&heap, &item1.heap_node);
     if (linked_binary_heap_size(&heap) != 1)
     {
         printf("%s test FAILED: Heap size must be 1 after insert\n", __func__);
         return;
     }
-    if (heap.root != &item1.heap_node)
+    if (0 != linked_binary_heap_peek(&heap, &top) || top != &item1.heap_node)
     {
         printf("%s test FAILED: Item 1 with priority %"PRId32" must be at heap root after insert\n",
             __func__, item1.priority);
@@ -303,7 +324,7 @@ test_linked_binary_heap_push_simple(void)
         printf("%s test FAILED: Heap size must be 2 after insert\n", __func__);
         return;
     }
-    if (heap.root != &item2.heap_node)
+    if (0 != linked_binary_heap_peek(&heap, &top) || top != &item2.heap_node)
     {
         printf("%s test FAILED: Item 2 with priority %"PRId32" must be at heap root after insert\n",
             __func__, item2.priority);
@@ -316,7 +337,7 @@ test_linked_binary_heap_push_simple(void)
         printf("%s test FAILED: Heap size must be 3 after insert\n", __func__);
         return;
     }
-    if (heap.root != &item3.heap_node)
+    if (0 != linked_binary_heap_peek(&heap, &top) || top != &item3.heap_node)
     {
         printf("%s test FAILED: Item 3 with priority %"PRId32" must be at heap root after insert\n",
             __func__, item3.priority);
@@ -658,6 +679,1503 @@ free_mem:
 }
 
 
+void
+test_update_random_items(void)
+{
+    const uint32_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n",
+            __func__);
+        return;
+    }
+
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = (int32_t)(rand() % items_count);
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_push(&heap, &items[i].heap_node);
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        item_t* item = &items[rand() % items_count];
+        const int32_t old_priority = item->priority;
+        item->priority = (int32_t)(rand() % items_count);
+        switch (i % 3)
+        {
+        case 0:
+            linked_binary_heap_update(&heap, &item->heap_node);
+            break;
+        case 1:
+            if (item->priority < old_priority)
+            {
+                linked_binary_heap_decrease(&heap, &item->heap_node);
+            }
+            else
+            {
+                linked_binary_heap_increase(&heap, &item->heap_node);
+            }
+            break;
+        default:
+            // reference path: remove and push again
+            linked_binary_heap_remove(&heap, &item->heap_node);
+            linked_binary_heap_push(&heap, &item->heap_node);
+            break;
+        }
+
+        if (i % 1024 == 0 && 0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap state is invalid after update\n",
+                __func__);
+            goto free_mem;
+        }
+    }
+
+    if (linked_binary_heap_size(&heap) != items_count)
+    {
+        printf("%s test FAILED: heap size expected to be %" PRIu32 "\n",
+            __func__, items_count);
+        goto free_mem;
+    }
+
+    int32_t root_priority = INT32_MIN;
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_pop(&heap, &top))
+    {
+        const int32_t next_priority = ((item_t*)top->data)->priority;
+        if (root_priority > next_priority)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item is less than previously popped %"PRId32" \n",
+                __func__, next_priority, root_priority);
+            goto free_mem;
+        }
+        root_priority = next_priority;
+    }
+
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    if (items != NULL)
+    {
+        free(items);
+        items = NULL;
+    }
+}
+
+
+void
+test_build_random_items(void)
+{
+    const size_t items_count = 256 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    linked_binary_heap_node_t** nodes = (linked_binary_heap_node_t**)malloc(items_count * sizeof(linked_binary_heap_node_t*));
+    if (items == NULL || nodes == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n",
+            __func__);
+        goto free_mem;
+    }
+
+    // build from scratch, then append a few batches onto non-empty heap
+    const size_t batches[] = { items_count / 2, 1, 3, items_count / 8, items_count / 4 };
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+
+    size_t built = 0;
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+    {
+        for (size_t i = 0; i < batches[b]; i++)
+        {
+            items[built + i].priority = (int32_t)(rand() % items_count);
+            linked_binary_heap_node_init(&items[built + i].heap_node, &items[built + i]);
+            nodes[i] = &items[built + i].heap_node;
+        }
+        linked_binary_heap_build(&heap, nodes, batches[b]);
+        built += batches[b];
+
+        if (linked_binary_heap_size(&heap) != built)
+        {
+            printf("%s test FAILED: heap size expected to be %zu\n",
+                __func__, built);
+            goto free_mem;
+        }
+        if (0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap is not valid after build of %zu nodes\n", __func__, batches[b]);
+            goto free_mem;
+        }
+    }
+
+    int32_t root_priority = INT32_MIN;
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_pop(&heap, &top))
+    {
+        const int32_t next_priority = ((item_t*)top->data)->priority;
+        if (root_priority > next_priority)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item is less than previously popped %"PRId32" \n",
+                __func__, next_priority, root_priority);
+            goto free_mem;
+        }
+        root_priority = next_priority;
+    }
+
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+    free(nodes);
+}
+
+
+void
+test_build_priority_collision_handled_in_push_order(void)
+{
+    item_t items[512];
+    linked_binary_heap_node_t* nodes[512];
+
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, always_equal_comparer, item_visualizer);
+
+    // mix plain pushes with bulk appends, pop order must match insertion order
+    for (size_t i = 0; i < 512; i++)
+    {
+        items[i].priority = (int32_t)i;
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        nodes[i] = &items[i].heap_node;
+    }
+    for (size_t i = 0; i < 100; i++)
+    {
+        linked_binary_heap_push(&heap, nodes[i]);
+    }
+    linked_binary_heap_build(&heap, &nodes[100], 300);
+    for (size_t i = 400; i < 512; i++)
+    {
+        linked_binary_heap_push(&heap, nodes[i]);
+    }
+
+    if (0 != linked_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid\n", __func__);
+        return;
+    }
+
+    for (size_t i = 0; i < 512; i++)
+    {
+        linked_binary_heap_node_t* node;
+        linked_binary_heap_pop(&heap, &node);
+        item_t* item = (item_t*)node->data;
+        if (item->priority != (int32_t)i)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item does not match insertion order %zu\n",
+                __func__, item->priority, i);
+            return;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_keyed_heap_push_pop_random_keys(void)
+{
+    const size_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    const linked_binary_heap_key_type_t key_types[] = {
+        LINKED_BINARY_HEAP_KEY_U64,
+        LINKED_BINARY_HEAP_KEY_I64,
+        LINKED_BINARY_HEAP_KEY_F64,
+    };
+    for (size_t k = 0; k < sizeof(key_types) / sizeof(key_types[0]); k++)
+    {
+        linked_binary_heap_t heap;
+        linked_binary_heap_init_keyed(&heap, key_types[k], NULL);
+
+        for (size_t i = 0; i < items_count; i++)
+        {
+            // small range of signed priorities gives both negative keys and collisions
+            items[i].priority = (int32_t)(rand() % 2048) - 1024;
+            linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+            switch (key_types[k])
+            {
+            case LINKED_BINARY_HEAP_KEY_U64:
+                linked_binary_heap_node_set_key_u64(&items[i].heap_node, (uint64_t)(items[i].priority + 1024));
+                break;
+            case LINKED_BINARY_HEAP_KEY_I64:
+                linked_binary_heap_node_set_key_i64(&items[i].heap_node, (int64_t)items[i].priority * 1000000000000ll);
+                break;
+            default:
+                linked_binary_heap_node_set_key_f64(&items[i].heap_node, items[i].priority / 3.0);
+                break;
+            }
+            linked_binary_heap_push(&heap, &items[i].heap_node);
+        }
+
+        if (0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap is not valid\n", __func__);
+            goto free_mem;
+        }
+
+        // move some nodes through key setters
+        for (size_t i = 0; i < items_count / 4; i++)
+        {
+            item_t* item = &items[rand() % items_count];
+            item->priority = (int32_t)(rand() % 2048) - 1024;
+            switch (key_types[k])
+            {
+            case LINKED_BINARY_HEAP_KEY_U64:
+                linked_binary_heap_node_set_key_u64(&item->heap_node, (uint64_t)(item->priority + 1024));
+                break;
+            case LINKED_BINARY_HEAP_KEY_I64:
+                linked_binary_heap_node_set_key_i64(&item->heap_node, (int64_t)item->priority * 1000000000000ll);
+                break;
+            default:
+                linked_binary_heap_node_set_key_f64(&item->heap_node, item->priority / 3.0);
+                break;
+            }
+        }
+
+        if (0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap is not valid after key updates\n", __func__);
+            goto free_mem;
+        }
+
+        int32_t root_priority = INT32_MIN;
+        uint32_t root_sequence = 0;
+        linked_binary_heap_node_t* top;
+        while (0 == linked_binary_heap_peek(&heap, &top))
+        {
+            const uint32_t sequence = top->sequence;
+            linked_binary_heap_pop(&heap, &top);
+            item_t* item = (item_t*)top->data;
+            if (root_priority > item->priority
+                || (root_priority == item->priority && UINT32_GT(root_sequence, sequence)))
+            {
+                printf("%s test FAILED: Priority %"PRId32" of popped item is less than previously popped %"PRId32" \n",
+                    __func__, item->priority, root_priority);
+                goto free_mem;
+            }
+            if (key_types[k] == LINKED_BINARY_HEAP_KEY_F64
+                && linked_binary_heap_node_get_key_f64(top) != item->priority / 3.0)
+            {
+                printf("%s test FAILED: f64 key does not round trip\n", __func__);
+                goto free_mem;
+            }
+            if (key_types[k] == LINKED_BINARY_HEAP_KEY_I64
+                && linked_binary_heap_node_get_key_i64(top) != (int64_t)item->priority * 1000000000000ll)
+            {
+                printf("%s test FAILED: i64 key does not round trip\n", __func__);
+                goto free_mem;
+            }
+            root_priority = item->priority;
+            root_sequence = sequence;
+        }
+    }
+
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_replace_top_k_way_merge(void)
+{
+    // merge of sorted runs, where every popped item is replaced by the next item of its run
+    const size_t runs_count = 64;
+    const size_t run_length = 1024;
+    item_t* items = (item_t*)malloc(runs_count * run_length * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, item_comparer, NULL);
+    for (size_t r = 0; r < runs_count; r++)
+    {
+        int32_t priority = 0;
+        for (size_t i = 0; i < run_length; i++)
+        {
+            priority += rand() % 16;
+            items[r * run_length + i].priority = priority;
+            linked_binary_heap_node_init(&items[r * run_length + i].heap_node, &items[r * run_length + i]);
+        }
+        linked_binary_heap_push(&heap, &items[r * run_length].heap_node);
+    }
+
+    size_t merged = 0;
+    int32_t root_priority = INT32_MIN;
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_peek(&heap, &top))
+    {
+        const size_t index = (size_t)((item_t*)top->data - items);
+        if ((index + 1) % run_length != 0)
+        {
+            linked_binary_heap_replace_top(&heap, &items[index + 1].heap_node, &top);
+        }
+        else
+        {
+            linked_binary_heap_pop(&heap, &top);
+        }
+        if (linked_binary_heap_contains_node(&heap, top) || top != &items[index].heap_node)
+        {
+            printf("%s test FAILED: replaced root is not returned\n", __func__);
+            goto free_mem;
+        }
+        if (root_priority > items[index].priority)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of merged item is less than previously merged %"PRId32" \n",
+                __func__, items[index].priority, root_priority);
+            goto free_mem;
+        }
+        root_priority = items[index].priority;
+        merged++;
+        if (merged % 1024 == 0 && 0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap is not valid\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    if (merged != runs_count * run_length)
+    {
+        printf("%s test FAILED: %zu items merged instead of %zu\n", __func__, merged, runs_count * run_length);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_pushpop_matches_push_then_pop(void)
+{
+    const size_t items_count = 16 * 1024;
+    item_t* items = (item_t*)malloc(2 * items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    // same priorities pushed to both heaps, one uses pushpop and the other push followed by pop
+    linked_binary_heap_t fused;
+    linked_binary_heap_t reference;
+    linked_binary_heap_init(&fused, item_comparer, NULL);
+    linked_binary_heap_init(&reference, item_comparer, NULL);
+    item_t* const fused_items = items;
+    item_t* const reference_items = items + items_count;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        fused_items[i].priority = reference_items[i].priority = (int32_t)(rand() % 256);
+        linked_binary_heap_node_init(&fused_items[i].heap_node, &fused_items[i]);
+        linked_binary_heap_node_init(&reference_items[i].heap_node, &reference_items[i]);
+    }
+    for (size_t i = 0; i < items_count / 2; i++)
+    {
+        linked_binary_heap_push(&fused, &fused_items[i].heap_node);
+        linked_binary_heap_push(&reference, &reference_items[i].heap_node);
+    }
+
+    for (size_t i = items_count / 2; i < items_count; i++)
+    {
+        linked_binary_heap_node_t* fused_top = NULL;
+        linked_binary_heap_node_t* reference_top = NULL;
+        linked_binary_heap_pushpop(&fused, &fused_items[i].heap_node, &fused_top);
+        linked_binary_heap_push(&reference, &reference_items[i].heap_node);
+        linked_binary_heap_pop(&reference, &reference_top);
+        if ((item_t*)fused_top->data - fused_items != (item_t*)reference_top->data - reference_items)
+        {
+            printf("%s test FAILED: pushpop returned different item at %zu\n", __func__, i);
+            goto free_mem;
+        }
+        if (i % 3 == 0)
+        {
+            // the root re-pushed in place behaves as pop followed by push of the same node
+            linked_binary_heap_peek(&fused, &fused_top);
+            linked_binary_heap_peek(&reference, &reference_top);
+            linked_binary_heap_replace_top(&fused, fused_top, &fused_top);
+            linked_binary_heap_pop(&reference, &reference_top);
+            linked_binary_heap_push(&reference, reference_top);
+            if (fused_top != NULL)
+            {
+                printf("%s test FAILED: re-pushed root is returned as replaced one\n", __func__);
+                goto free_mem;
+            }
+        }
+    }
+
+    if (0 != linked_binary_heap_verify(&fused) || linked_binary_heap_size(&fused) != items_count / 2)
+    {
+        printf("%s test FAILED: Heap is not valid\n", __func__);
+        goto free_mem;
+    }
+    linked_binary_heap_node_t* fused_top;
+    linked_binary_heap_node_t* reference_top;
+    while (0 == linked_binary_heap_pop(&fused, &fused_top))
+    {
+        linked_binary_heap_pop(&reference, &reference_top);
+        if ((item_t*)fused_top->data - fused_items != (item_t*)reference_top->data - reference_items)
+        {
+            printf("%s test FAILED: pop order differs from reference heap\n", __func__);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_batch_push_pop_matches_individual_calls(void)
+{
+    const size_t items_count = 32 * 1024;
+    item_t* items = (item_t*)malloc(2 * items_count * sizeof(item_t));
+    linked_binary_heap_node_t** nodes = (linked_binary_heap_node_t**)malloc(items_count * sizeof(linked_binary_heap_node_t*));
+    if (items == NULL || nodes == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    // batches both smaller and bigger than the heap take both push paths,
+    // narrow priority range checks FIFO order of collisions
+    linked_binary_heap_t batched;
+    linked_binary_heap_t reference;
+    linked_binary_heap_init(&batched, item_comparer, NULL);
+    linked_binary_heap_init(&reference, item_comparer, NULL);
+    item_t* const batched_items = items;
+    item_t* const reference_items = items + items_count;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        batched_items[i].priority = reference_items[i].priority = (int32_t)(rand() % 128);
+        linked_binary_heap_node_init(&batched_items[i].heap_node, &batched_items[i]);
+        linked_binary_heap_node_init(&reference_items[i].heap_node, &reference_items[i]);
+    }
+
+    const size_t batches[] = { 1000, 3, 100, 20000, 1, 500 };
+    size_t pushed = 0;
+    for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); b++)
+    {
+        // batch pop is a single modification, so versions are compared by their change
+        const uint32_t batched_version = linked_binary_heap_version(&batched);
+        const uint32_t reference_version = linked_binary_heap_version(&reference);
+        for (size_t i = 0; i < batches[b]; i++)
+        {
+            nodes[i] = &batched_items[pushed + i].heap_node;
+            linked_binary_heap_push(&reference, &reference_items[pushed + i].heap_node);
+        }
+        linked_binary_heap_push_batch(&batched, nodes, batches[b]);
+        pushed += batches[b];
+        if (linked_binary_heap_size(&batched) != linked_binary_heap_size(&reference)
+            || linked_binary_heap_version(&batched) - batched_version
+                != linked_binary_heap_version(&reference) - reference_version
+            || 0 != linked_binary_heap_verify(&batched))
+        {
+            printf("%s test FAILED: Heap is not valid after batch of %zu nodes\n", __func__, batches[b]);
+            goto free_mem;
+        }
+
+        // drain part of the heap in batches
+        const uint32_t version_before_pop = linked_binary_heap_version(&batched);
+        const size_t popped = linked_binary_heap_pop_batch(&batched, nodes, batches[b] / 2 + 1);
+        for (size_t i = 0; i < popped; i++)
+        {
+            linked_binary_heap_node_t* reference_top = NULL;
+            linked_binary_heap_pop(&reference, &reference_top);
+            if ((item_t*)nodes[i]->data - batched_items != (item_t*)reference_top->data - reference_items
+                || linked_binary_heap_contains_node(&batched, nodes[i]))
+            {
+                printf("%s test FAILED: batch pop order differs at %zu\n", __func__, i);
+                goto free_mem;
+            }
+        }
+        if (popped != batches[b] / 2 + 1 || linked_binary_heap_version(&batched) - version_before_pop != 1
+            || 0 != linked_binary_heap_verify(&batched))
+        {
+            printf("%s test FAILED: Heap is not valid after batch pop\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    const size_t remaining = linked_binary_heap_size(&batched);
+    if (remaining != linked_binary_heap_pop_batch(&batched, nodes, items_count)
+        || linked_binary_heap_size(&batched) != 0
+        || 0 != linked_binary_heap_verify(&batched))
+    {
+        printf("%s test FAILED: heap expected to be drained\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+    free(nodes);
+}
+
+
+void
+test_push_batch_skips_inserted_nodes(void)
+{
+    item_t items[4096 + 64 + 1];
+    linked_binary_heap_node_t* nodes[64];
+
+    // empty heap builds the batch at once, big heap pushes it node by node
+    const size_t heap_sizes[] = { 0, 4096 };
+    for (size_t h = 0; h < sizeof(heap_sizes) / sizeof(heap_sizes[0]); h++)
+    {
+        linked_binary_heap_t heap;
+        linked_binary_heap_t other;
+        linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+        linked_binary_heap_init(&other, item_comparer, item_visualizer);
+        for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++)
+        {
+            items[i].priority = (int32_t)(rand() % 1024);
+            linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        }
+        for (size_t i = 0; i < heap_sizes[h]; i++)
+        {
+            linked_binary_heap_push(&heap, &items[i].heap_node);
+        }
+        linked_binary_heap_node_t* const foreign = &items[4096 + 64].heap_node;
+        linked_binary_heap_push(&other, foreign);
+
+        // every 8th entry is a node of the other heap or a node already in the heap
+        size_t fresh = 0;
+        for (size_t i = 0; i < 64; i++)
+        {
+            if (i % 8 == 3)
+            {
+                nodes[i] = foreign;
+            }
+            else if (i % 8 == 5 && heap_sizes[h] > 0)
+            {
+                nodes[i] = &items[i].heap_node;
+            }
+            else
+            {
+                nodes[i] = &items[4096 + i].heap_node;
+                fresh++;
+            }
+        }
+        linked_binary_heap_push_batch(&heap, nodes, 64);
+
+        if (linked_binary_heap_size(&heap) != heap_sizes[h] + fresh || 0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap of %zu nodes is not valid after batch\n", __func__, heap_sizes[h]);
+            return;
+        }
+        if (!linked_binary_heap_contains_node(&other, foreign) || linked_binary_heap_size(&other) != 1
+            || 0 != linked_binary_heap_verify(&other))
+        {
+            printf("%s test FAILED: node of other heap is moved by batch\n", __func__);
+            return;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_push_batch_skips_repeated_nodes(void)
+{
+    item_t items[4096 + 64];
+    linked_binary_heap_node_t* nodes[64];
+
+    // empty heap builds the batch at once, big heap pushes it node by node
+    const size_t heap_sizes[] = { 0, 4096 };
+    for (size_t h = 0; h < sizeof(heap_sizes) / sizeof(heap_sizes[0]); h++)
+    {
+        linked_binary_heap_t heap;
+        linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+        for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++)
+        {
+            items[i].priority = (int32_t)(rand() % 1024);
+            linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        }
+        for (size_t i = 0; i < heap_sizes[h]; i++)
+        {
+            linked_binary_heap_push(&heap, &items[i].heap_node);
+        }
+
+        // every node of the batch is listed twice
+        for (size_t i = 0; i < 64; i++)
+        {
+            nodes[i] = &items[4096 + i / 2].heap_node;
+        }
+        linked_binary_heap_push_batch(&heap, nodes, 64);
+
+        if (linked_binary_heap_size(&heap) != heap_sizes[h] + 32 || 0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap of %zu nodes is not valid after batch\n", __func__, heap_sizes[h]);
+            return;
+        }
+        size_t popped = 0;
+        linked_binary_heap_node_t* top;
+        while (0 == linked_binary_heap_pop(&heap, &top))
+        {
+            popped++;
+        }
+        if (popped != heap_sizes[h] + 32)
+        {
+            printf("%s test FAILED: %zu nodes popped instead of %zu\n", __func__, popped, heap_sizes[h] + 32);
+            return;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+void
+test_bottom_up_pop_matches_sift_down(void)
+{
+    const size_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(2 * items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    // narrow priority range checks FIFO order of collisions
+    linked_binary_heap_t bottom_up;
+    linked_binary_heap_t sift_down;
+    linked_binary_heap_init(&bottom_up, counting_item_comparer, NULL);
+    linked_binary_heap_init(&sift_down, counting_item_comparer, NULL);
+    linked_binary_heap_set_pop_mode(&bottom_up, LINKED_BINARY_HEAP_POP_BOTTOM_UP);
+    item_t* const bottom_up_items = items;
+    item_t* const sift_down_items = items + items_count;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        bottom_up_items[i].priority = sift_down_items[i].priority = (int32_t)(rand() % 4096);
+        linked_binary_heap_node_init(&bottom_up_items[i].heap_node, &bottom_up_items[i]);
+        linked_binary_heap_node_init(&sift_down_items[i].heap_node, &sift_down_items[i]);
+        linked_binary_heap_push(&bottom_up, &bottom_up_items[i].heap_node);
+        linked_binary_heap_push(&sift_down, &sift_down_items[i].heap_node);
+    }
+    for (size_t i = 0; i < items_count / 8; i++)
+    {
+        const size_t index = (size_t)rand() % items_count;
+        if (linked_binary_heap_contains_node(&bottom_up, &bottom_up_items[index].heap_node))
+        {
+            linked_binary_heap_remove(&bottom_up, &bottom_up_items[index].heap_node);
+            linked_binary_heap_remove(&sift_down, &sift_down_items[index].heap_node);
+        }
+    }
+    if (0 != linked_binary_heap_verify(&bottom_up) || 0 != linked_binary_heap_verify(&sift_down))
+    {
+        printf("%s test FAILED: Heap is not valid after remove\n", __func__);
+        goto free_mem;
+    }
+
+    uint64_t bottom_up_calls = 0;
+    uint64_t sift_down_calls = 0;
+    while (linked_binary_heap_size(&sift_down) > 0)
+    {
+        linked_binary_heap_node_t* bottom_up_top = NULL;
+        linked_binary_heap_node_t* sift_down_top = NULL;
+        comparer_calls = 0;
+        linked_binary_heap_pop(&bottom_up, &bottom_up_top);
+        bottom_up_calls += comparer_calls;
+        comparer_calls = 0;
+        linked_binary_heap_pop(&sift_down, &sift_down_top);
+        sift_down_calls += comparer_calls;
+        if (bottom_up_top == NULL
+            || (item_t*)bottom_up_top->data - bottom_up_items != (item_t*)sift_down_top->data - sift_down_items)
+        {
+            printf("%s test FAILED: pop order differs\n", __func__);
+            goto free_mem;
+        }
+    }
+    // bottom up pop compares once per level on the way down and a few times on the way up
+    if (linked_binary_heap_size(&bottom_up) != 0 || (!VERIFY_CALLS_COMPARER && bottom_up_calls * 4 > sift_down_calls * 3))
+    {
+        printf("%s test FAILED: %" PRIu64 " comparisons of bottom up pop, %" PRIu64 " of sift down pop\n",
+            __func__, bottom_up_calls, sift_down_calls);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_meld_keeps_push_order_of_collisions(void)
+{
+    const size_t sizes[][2] = { { 1000, 3000 }, { 3000, 1000 }, { 0, 500 }, { 500, 0 }, { 1, 1 } };
+    item_t* items = (item_t*)malloc(4000 * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        // dst items come first in items array, so ties pop in array order
+        const size_t dst_count = sizes[s][0];
+        const size_t src_count = sizes[s][1];
+        linked_binary_heap_t dst;
+        linked_binary_heap_t src;
+        linked_binary_heap_init(&dst, item_comparer, NULL);
+        linked_binary_heap_init(&src, item_comparer, NULL);
+        // shift src sequences away from dst ones
+        src.mod_count = UINT32_MAX - 100;
+        for (size_t i = 0; i < dst_count + src_count; i++)
+        {
+            items[i].priority = (int32_t)(rand() % 16);
+            linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+            linked_binary_heap_push(i < dst_count ? &dst : &src, &items[i].heap_node);
+        }
+
+        linked_binary_heap_meld(&dst, &src);
+        if (linked_binary_heap_size(&dst) != dst_count + src_count || linked_binary_heap_size(&src) != 0
+            || 0 != linked_binary_heap_verify(&dst) || 0 != linked_binary_heap_verify(&src))
+        {
+            printf("%s test FAILED: Heaps are not valid after meld\n", __func__);
+            goto free_mem;
+        }
+
+        item_t* prev = NULL;
+        linked_binary_heap_node_t* top;
+        while (0 == linked_binary_heap_pop(&dst, &top))
+        {
+            item_t* item = (item_t*)top->data;
+            if (prev != NULL && (prev->priority > item->priority || (prev->priority == item->priority && prev > item)))
+            {
+                printf("%s test FAILED: item %td popped after item %td\n", __func__, item - items, prev - items);
+                goto free_mem;
+            }
+            prev = item;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+static item_t* discarded_items;
+static uint8_t* discarded_states;
+
+
+void
+discard_item(linked_binary_heap_node_t* node)
+{
+    const size_t i = (size_t)((item_t*)node->data - discarded_items);
+    discarded_states[i] = discarded_states[i] == 1 ? 2 : 3;
+}
+
+
+void
+test_lazy_remove_discards_dead_nodes(void)
+{
+    const size_t items_count = 4000;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    uint8_t* state = (uint8_t*)calloc(items_count, sizeof(uint8_t));
+    if (items == NULL || state == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    // state of item: 0 - live, 1 - removed, 2 - discarded, 3 - discarded while not removed
+    discarded_states = state;
+    discarded_items = items;
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, item_comparer, NULL);
+    linked_binary_heap_set_lazy_remove(&heap, 50, discard_item);
+    for (size_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = (int32_t)(rand() % 256);
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_push(&heap, &items[i].heap_node);
+    }
+
+    // most timers are cancelled before they fire
+    size_t live_count = items_count;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (rand() % 10 != 0)
+        {
+            // root is unlinked at once without discarder
+            state[i] = 1;
+            linked_binary_heap_remove(&heap, &items[i].heap_node);
+            state[i] = items[i].heap_node.heap == NULL ? 2 : state[i];
+            live_count--;
+        }
+        if (linked_binary_heap_size(&heap) != live_count
+            || linked_binary_heap_dead_size(&heap) * 2 > linked_binary_heap_size(&heap) + linked_binary_heap_dead_size(&heap)
+            || linked_binary_heap_contains_node(&heap, &items[i].heap_node) != (state[i] == 0)
+            || 0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap is not valid after remove of item %zu\n", __func__, i);
+            goto free_mem;
+        }
+    }
+
+    // removed nodes are pushed back whether they are still linked or discarded already
+    for (size_t i = 0; i < items_count; i += 7)
+    {
+        if (state[i] != 0)
+        {
+            linked_binary_heap_push(&heap, &items[i].heap_node);
+            state[i] = 0;
+            live_count++;
+        }
+    }
+    if (linked_binary_heap_size(&heap) != live_count || 0 != linked_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap is not valid after push of removed items\n", __func__);
+        goto free_mem;
+    }
+
+    int32_t priority = INT32_MIN;
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_pop(&heap, &top))
+    {
+        item_t* item = (item_t*)top->data;
+        if (item->priority < priority || state[item - items] != 0)
+        {
+            printf("%s test FAILED: removed or out of order item %td popped\n", __func__, item - items);
+            goto free_mem;
+        }
+        priority = item->priority;
+        live_count--;
+    }
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (state[i] == 1 || state[i] == 3 || items[i].heap_node.heap != NULL)
+        {
+            printf("%s test FAILED: removed item %zu is not discarded exactly once\n", __func__, i);
+            goto free_mem;
+        }
+    }
+    if (live_count != 0 || linked_binary_heap_dead_size(&heap) != 0)
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(state);
+    free(items);
+}
+
+
+void
+test_lazy_remove_batch_revives_dead_nodes(void)
+{
+    item_t items[4096 + 64];
+    linked_binary_heap_node_t* nodes[64];
+
+    // small heap builds the batch at once, big heap pushes it node by node
+    const size_t heap_sizes[] = { 64, 4096 };
+    for (size_t h = 0; h < sizeof(heap_sizes) / sizeof(heap_sizes[0]); h++)
+    {
+        const size_t heap_size = heap_sizes[h];
+        linked_binary_heap_t heap;
+        linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+        linked_binary_heap_set_lazy_remove(&heap, 90, NULL);
+        for (size_t i = 0; i < heap_size + 32; i++)
+        {
+            items[i].priority = (int32_t)(rand() % 64);
+            linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        }
+        for (size_t i = 0; i < heap_size; i++)
+        {
+            linked_binary_heap_push(&heap, &items[i].heap_node);
+        }
+
+        // half of the batch are removed nodes, mostly still linked as dead
+        for (size_t i = 0; i < 32; i++)
+        {
+            linked_binary_heap_remove(&heap, &items[i * 2].heap_node);
+            nodes[i * 2] = &items[i * 2].heap_node;
+            nodes[i * 2 + 1] = &items[heap_size + i].heap_node;
+        }
+        if (linked_binary_heap_dead_size(&heap) == 0)
+        {
+            printf("%s test FAILED: removed nodes expected to stay linked\n", __func__);
+            return;
+        }
+        linked_binary_heap_push_batch(&heap, nodes, 64);
+
+        if (linked_binary_heap_size(&heap) != heap_size + 32 || linked_binary_heap_dead_size(&heap) != 0
+            || 0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap of %zu nodes is not valid after batch\n", __func__, heap_size);
+            return;
+        }
+        size_t popped = 0;
+        int32_t priority = INT32_MIN;
+        linked_binary_heap_node_t* top;
+        while (0 == linked_binary_heap_pop(&heap, &top))
+        {
+            if (((item_t*)top->data)->priority < priority)
+            {
+                printf("%s test FAILED: item popped out of order\n", __func__);
+                return;
+            }
+            priority = ((item_t*)top->data)->priority;
+            popped++;
+        }
+        if (popped != heap_size + 32)
+        {
+            printf("%s test FAILED: %zu nodes popped instead of %zu\n", __func__, popped, heap_size + 32);
+            return;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_lazy_remove_batch_revives_node_with_lower_priority(void)
+{
+    // timer cancelled and rearmed earlier than any armed one goes back through build or big batch
+    item_t items[48];
+    linked_binary_heap_node_t* nodes[16];
+    for (int use_build = 0; use_build < 2; use_build++)
+    {
+        linked_binary_heap_t heap;
+        linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+        linked_binary_heap_set_lazy_remove(&heap, 90, NULL);
+        for (size_t i = 0; i < 48; i++)
+        {
+            items[i].priority = (int32_t)i;
+            linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        }
+        for (size_t i = 0; i < 32; i++)
+        {
+            linked_binary_heap_push(&heap, &items[i].heap_node);
+        }
+        linked_binary_heap_remove(&heap, &items[20].heap_node);
+        items[20].priority = -5;
+
+        // batch of 16 nodes is big enough for push_batch to build it at once
+        nodes[0] = &items[20].heap_node;
+        for (size_t i = 1; i < 16; i++)
+        {
+            nodes[i] = &items[32 + i].heap_node;
+        }
+        if (use_build)
+        {
+            linked_binary_heap_build(&heap, nodes, 1);
+        }
+        else
+        {
+            linked_binary_heap_push_batch(&heap, nodes, 16);
+        }
+
+        linked_binary_heap_node_t* top;
+        if (0 != linked_binary_heap_verify(&heap) || 0 != linked_binary_heap_peek(&heap, &top)
+            || top != &items[20].heap_node)
+        {
+            printf("%s test FAILED: revived node with lower priority is not the top after %s\n",
+                __func__, use_build ? "build" : "push batch");
+            return;
+        }
+        int32_t priority = INT32_MIN;
+        while (0 == linked_binary_heap_pop(&heap, &top))
+        {
+            if (((item_t*)top->data)->priority < priority)
+            {
+                printf("%s test FAILED: item popped out of order\n", __func__);
+                return;
+            }
+            priority = ((item_t*)top->data)->priority;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_lazy_remove_rekeyed_dead_node_is_not_popped(void)
+{
+    item_t items[1024];
+    linked_binary_heap_t heap;
+    linked_binary_heap_init_keyed(&heap, LINKED_BINARY_HEAP_KEY_U64, NULL);
+    linked_binary_heap_set_lazy_remove(&heap, 90, NULL);
+    for (size_t i = 0; i < 1024; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].heap_node, 1000 + (uint64_t)(rand() % 1000));
+        linked_binary_heap_push(&heap, &items[i].heap_node);
+    }
+
+    // dead nodes get keys smaller and bigger than any live node
+    for (size_t i = 1; i < 1024; i += 2)
+    {
+        linked_binary_heap_remove(&heap, &items[i].heap_node);
+        linked_binary_heap_node_set_key_u64(&items[i].heap_node, i % 4 == 1 ? 0 : 5000);
+    }
+    if (linked_binary_heap_size(&heap) != 512 || 0 != linked_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid after key change of dead nodes\n", __func__);
+        return;
+    }
+    uint64_t key = 0;
+    size_t popped = 0;
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_pop(&heap, &top))
+    {
+        const size_t i = (size_t)((item_t*)top->data - items);
+        if (i % 2 != 0 || linked_binary_heap_node_get_key_u64(top) < key)
+        {
+            printf("%s test FAILED: removed or out of order item %zu popped\n", __func__, i);
+            return;
+        }
+        key = linked_binary_heap_node_get_key_u64(top);
+        popped++;
+    }
+    if (popped != 512)
+    {
+        printf("%s test FAILED: %zu nodes popped instead of 512\n", __func__, popped);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+void
+test_meld_discards_dead_nodes_of_source(void)
+{
+    const size_t items_count = 2000;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    uint8_t* state = (uint8_t*)calloc(items_count, sizeof(uint8_t));
+    if (items == NULL || state == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    // state of item: 0 - live, 1 - removed, 2 - discarded, 3 - discarded while not removed
+    discarded_states = state;
+    discarded_items = items;
+    linked_binary_heap_t dst;
+    linked_binary_heap_t src;
+    linked_binary_heap_init(&dst, item_comparer, NULL);
+    linked_binary_heap_init(&src, item_comparer, NULL);
+    linked_binary_heap_set_lazy_remove(&src, 90, discard_item);
+    for (size_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = (int32_t)(rand() % 256);
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_push(i < items_count / 2 ? &dst : &src, &items[i].heap_node);
+    }
+    size_t live_count = items_count;
+    for (size_t i = items_count / 2; i < items_count; i += 3)
+    {
+        state[i] = 1;
+        linked_binary_heap_remove(&src, &items[i].heap_node);
+        state[i] = items[i].heap_node.heap == NULL ? 2 : state[i];
+        live_count--;
+    }
+    if (linked_binary_heap_dead_size(&src) == 0)
+    {
+        printf("%s test FAILED: removed nodes expected to stay linked\n", __func__);
+        goto free_mem;
+    }
+
+    // dst does not remove lazily, so it must not get dead nodes
+    linked_binary_heap_meld(&dst, &src);
+    if (linked_binary_heap_size(&dst) != live_count || linked_binary_heap_dead_size(&dst) != 0
+        || linked_binary_heap_size(&src) != 0 || linked_binary_heap_dead_size(&src) != 0
+        || 0 != linked_binary_heap_verify(&dst) || 0 != linked_binary_heap_verify(&src))
+    {
+        printf("%s test FAILED: Heaps are not valid after meld\n", __func__);
+        goto free_mem;
+    }
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (state[i] == 1 || state[i] == 3 || (state[i] == 2) == (items[i].heap_node.heap != NULL))
+        {
+            printf("%s test FAILED: removed item %zu is not discarded exactly once\n", __func__, i);
+            goto free_mem;
+        }
+    }
+
+    int32_t priority = INT32_MIN;
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_pop(&dst, &top))
+    {
+        item_t* item = (item_t*)top->data;
+        if (item->priority < priority || state[item - items] != 0)
+        {
+            printf("%s test FAILED: removed or out of order item %td popped\n", __func__, item - items);
+            goto free_mem;
+        }
+        priority = item->priority;
+        live_count--;
+    }
+    if (live_count != 0)
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(state);
+    free(items);
+}
+
+void
+test_small_heap_grows_and_shrinks(void)
+{
+    // per connection heaps hold few nodes, so size crosses small heap capacity back and forth
+    item_t items[32];
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+    linked_binary_heap_set_small_capacity(&heap, LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY);
+    for (size_t i = 0; i < 32; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+    }
+
+    for (int round = 0; round < 2000; round++)
+    {
+        item_t* item = &items[rand() % 32];
+        const int action = rand() % 4;
+        if (!linked_binary_heap_contains_node(&heap, &item->heap_node))
+        {
+            item->priority = rand() % 16;
+            linked_binary_heap_push(&heap, &item->heap_node);
+        }
+        else if (action == 0)
+        {
+            linked_binary_heap_remove(&heap, &item->heap_node);
+        }
+        else if (action == 1)
+        {
+            item->priority = rand() % 16;
+            linked_binary_heap_update(&heap, &item->heap_node);
+        }
+        else
+        {
+            // drain to a few nodes now and then
+            const size_t keep = (size_t)(rand() % 3);
+            int32_t priority = INT32_MIN;
+            linked_binary_heap_node_t* top;
+            while (linked_binary_heap_size(&heap) > keep && 0 == linked_binary_heap_pop(&heap, &top))
+            {
+                if (((item_t*)top->data)->priority < priority)
+                {
+                    printf("%s test FAILED: item popped out of order\n", __func__);
+                    return;
+                }
+                priority = ((item_t*)top->data)->priority;
+            }
+        }
+        if (0 != linked_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: Heap is not valid after round %d\n", __func__, round);
+            return;
+        }
+        // heap shrunk to half of capacity is converted back to array
+        if (heap.root != NULL && linked_binary_heap_size(&heap) <= LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY / 2)
+        {
+            printf("%s test FAILED: heap of %zu nodes is not small\n", __func__, linked_binary_heap_size(&heap));
+            return;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_small_heap_get_node_by_index(void)
+{
+    // query of small heap reads the sorted array and leaves the heap an array
+    item_t items[4];
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, item_comparer, item_visualizer);
+    linked_binary_heap_set_small_capacity(&heap, LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY);
+    for (int i = 0; i < 4; i++)
+    {
+        items[i].priority = 3 - i;
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_push(&heap, &items[i].heap_node);
+    }
+
+    linked_binary_heap_node_t* parent, **node;
+    for (size_t index = 0; index < 4; index++)
+    {
+        if (0 != linked_binary_heap_get_node_by_index(&heap, index, &parent, &node)
+            || ((item_t*)(*node)->data)->priority != (int32_t)index
+            || (index == 0 ? parent != NULL : ((item_t*)parent->data)->priority != (int32_t)((index - 1) / 2)))
+        {
+            printf("%s test FAILED: Wrong node by index %zu\n", __func__, index);
+            return;
+        }
+    }
+    if (0 == linked_binary_heap_get_node_by_index(&heap, 4, &parent, &node))
+    {
+        printf("%s test FAILED: Small heap has no link of the next node\n", __func__);
+        return;
+    }
+    if (heap.root != NULL || 0 != linked_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Query converted small heap to tree\n", __func__);
+        return;
+    }
+
+    // lowered capacity converts heap to tree and raised one back to array
+    linked_binary_heap_set_small_capacity(&heap, 2);
+    if (heap.root == NULL || 0 != linked_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap over capacity is not a tree\n", __func__);
+        return;
+    }
+    linked_binary_heap_set_small_capacity(&heap, LINKED_BINARY_HEAP_SMALL_MAX_CAPACITY);
+    if (heap.root != NULL || 0 != linked_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap within half of capacity is not small\n", __func__);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+typedef struct snapshot_record
+{
+    uint32_t index;
+    int32_t priority;
+} snapshot_record_t;
+
+
+void
+serialize_item(const linked_binary_heap_node_t* node, void* out_record, void* arg)
+{
+    const item_t* items = (const item_t*)arg;
+    const item_t* item = (const item_t*)node->data;
+    snapshot_record_t record = { (uint32_t)(item - items), item->priority };
+    memcpy(out_record, &record, sizeof(record));
+}
+
+
+linked_binary_heap_node_t*
+deserialize_item(const void* record, void* arg)
+{
+    item_t* items = (item_t*)arg;
+    snapshot_record_t saved;
+    memcpy(&saved, record, sizeof(saved));
+    item_t* item = &items[saved.index];
+    linked_binary_heap_node_init(&item->heap_node, item);
+    item->priority = saved.priority;
+    return &item->heap_node;
+}
+
+
+void
+test_snapshot_restore_keeps_pop_order(void)
+{
+    const char* const path = "linked_binary_heap_snapshot_test.bin";
+    const size_t items_count = 50000;
+    item_t* items = (item_t*)malloc(2 * items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    // narrow priority range checks FIFO order of collisions, dead nodes are not saved
+    linked_binary_heap_t saved;
+    linked_binary_heap_t restored;
+    linked_binary_heap_init(&saved, counting_item_comparer, NULL);
+    linked_binary_heap_init(&restored, counting_item_comparer, NULL);
+    linked_binary_heap_set_lazy_remove(&saved, 50, NULL);
+    item_t* const saved_items = items;
+    item_t* const restored_items = items + items_count;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        saved_items[i].priority = (int32_t)(rand() % 128);
+        linked_binary_heap_node_init(&saved_items[i].heap_node, &saved_items[i]);
+        linked_binary_heap_push(&saved, &saved_items[i].heap_node);
+    }
+    for (size_t i = 0; i < items_count / 10; i++)
+    {
+        item_t* item = &saved_items[(size_t)rand() % items_count];
+        if (linked_binary_heap_contains_node(&saved, &item->heap_node))
+        {
+            linked_binary_heap_remove(&saved, &item->heap_node);
+        }
+    }
+
+    if (0 != linked_binary_heap_snapshot(&saved, path, sizeof(snapshot_record_t), serialize_item, saved_items))
+    {
+        printf("%s test FAILED: failed to write snapshot\n", __func__);
+        goto free_mem;
+    }
+    comparer_calls = 0;
+    const int restore_result = linked_binary_heap_restore(&restored, path, deserialize_item, restored_items);
+    remove(path);
+    if (restore_result != 0 || (!VERIFY_CALLS_COMPARER && comparer_calls != 0)
+        || linked_binary_heap_size(&restored) != linked_binary_heap_size(&saved)
+        || linked_binary_heap_version(&restored) != linked_binary_heap_version(&saved)
+        || 0 != linked_binary_heap_verify(&restored))
+    {
+        printf("%s test FAILED: restored heap is not valid, %" PRIu64 " comparisons\n", __func__, comparer_calls);
+        goto free_mem;
+    }
+
+    // nodes pushed after restore lose to restored nodes with equal priority
+    size_t late = 0;
+    while (linked_binary_heap_contains_node(&saved, &saved_items[late].heap_node))
+    {
+        late++;
+    }
+    saved_items[late].priority = restored_items[late].priority = 0;
+    linked_binary_heap_node_init(&saved_items[late].heap_node, &saved_items[late]);
+    linked_binary_heap_node_init(&restored_items[late].heap_node, &restored_items[late]);
+    linked_binary_heap_push(&saved, &saved_items[late].heap_node);
+    linked_binary_heap_push(&restored, &restored_items[late].heap_node);
+    while (linked_binary_heap_size(&saved) > 0)
+    {
+        linked_binary_heap_node_t* saved_top = NULL;
+        linked_binary_heap_node_t* restored_top = NULL;
+        linked_binary_heap_pop(&saved, &saved_top);
+        if (0 != linked_binary_heap_pop(&restored, &restored_top)
+            || (item_t*)saved_top->data - saved_items != (item_t*)restored_top->data - restored_items)
+        {
+            printf("%s test FAILED: pop order differs\n", __func__);
+            goto free_mem;
+        }
+    }
+    if (0 == linked_binary_heap_restore(&restored, path, deserialize_item, restored_items))
+    {
+        printf("%s test FAILED: missing snapshot restored\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+#if defined(LINKED_BINARY_HEAP_STATS)
+void
+test_stats_counters(void)
+{
+    const size_t items_count = 10000;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    linked_binary_heap_t heap;
+    linked_binary_heap_init(&heap, counting_item_comparer, NULL);
+    linked_binary_heap_stats_t stats;
+    comparer_calls = 0;
+    size_t removed = 0;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = rand();
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_push(&heap, &items[i].heap_node);
+    }
+    for (size_t i = 0; i < items_count / 10; i++)
+    {
+        item_t* item = &items[(size_t)rand() % items_count];
+        if (linked_binary_heap_contains_node(&heap, &item->heap_node))
+        {
+            linked_binary_heap_remove(&heap, &item->heap_node);
+            removed++;
+        }
+    }
+    for (size_t i = 0; i < items_count / 10; i++)
+    {
+        item_t* item = &items[(size_t)rand() % items_count];
+        if (linked_binary_heap_contains_node(&heap, &item->heap_node))
+        {
+            item->priority = rand();
+            linked_binary_heap_update(&heap, &item->heap_node);
+        }
+    }
+    linked_binary_heap_node_t* top = NULL;
+    size_t popped = 0;
+    while (0 == linked_binary_heap_pop(&heap, &top))
+    {
+        popped++;
+    }
+
+    linked_binary_heap_get_stats(&heap, &stats);
+    // pushes and pops walk to the next free slot and to the new last node
+    if (stats.comparisons != comparer_calls || stats.peak_size != items_count || stats.path_walk_levels == 0
+        || stats.swaps != stats.sift_up_levels + stats.sift_down_levels + stats.swap_with_parent_calls + stats.swap_non_adjacent_calls)
+    {
+        printf("%s test FAILED: %" PRIu64 " comparisons counted for %" PRIu64 " comparer calls, peak size %zu, %" PRIu64 " levels walked\n",
+            __func__, stats.comparisons, comparer_calls, stats.peak_size, stats.path_walk_levels);
+        goto free_mem;
+    }
+#if defined(LINKED_BINARY_HEAP_STATS_LATENCY)
+    const uint64_t expected_counts[LINKED_BINARY_HEAP_STATS_OPERATIONS_COUNT] = {
+        [LINKED_BINARY_HEAP_STATS_PUSH] = items_count,
+        [LINKED_BINARY_HEAP_STATS_POP] = popped,
+        [LINKED_BINARY_HEAP_STATS_REMOVE] = removed,
+        [LINKED_BINARY_HEAP_STATS_UPDATE] = 0,
+    };
+    for (int op = 0; op < LINKED_BINARY_HEAP_STATS_OPERATIONS_COUNT; op++)
+    {
+        uint64_t count = 0;
+        for (int bucket = 0; bucket < LINKED_BINARY_HEAP_STATS_LATENCY_BUCKETS; bucket++)
+        {
+            count += stats.latency[op][bucket];
+        }
+        // number of updates depends on random picks, every other operation is recorded once
+        if (op == LINKED_BINARY_HEAP_STATS_UPDATE ? count == 0 : count != expected_counts[op])
+        {
+            printf("%s test FAILED: %" PRIu64 " latencies recorded for operation %d\n", __func__, count, op);
+            goto free_mem;
+        }
+    }
+#endif
+
+    // reset keeps current size as the peak
+    linked_binary_heap_push(&heap, &items[0].heap_node);
+    linked_binary_heap_reset_stats(&heap);
+    linked_binary_heap_get_stats(&heap, &stats);
+    if (stats.comparisons != 0 || stats.swaps != 0 || stats.swap_non_adjacent_calls != 0 || stats.path_walk_levels != 0
+        || stats.peak_size != 1)
+    {
+        printf("%s test FAILED: counters are not reset\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+#endif
+
+
 void
 test_timer_overflow(void)
 {
@@ -727,4 +2245,26 @@ int main(void)
     test_linked_binary_heap_priority_collision_handled_in_push_order();
     test_timer_overflow();
     test_random_remove();
+    test_update_random_items();
+    test_build_random_items();
+    test_build_priority_collision_handled_in_push_order();
+    test_keyed_heap_push_pop_random_keys();
+    test_replace_top_k_way_merge();
+    test_pushpop_matches_push_then_pop();
+    test_batch_push_pop_matches_individual_calls();
+    test_push_batch_skips_inserted_nodes();
+    test_push_batch_skips_repeated_nodes();
+    test_bottom_up_pop_matches_sift_down();
+    test_meld_keeps_push_order_of_collisions();
+    test_lazy_remove_discards_dead_nodes();
+    test_lazy_remove_batch_revives_dead_nodes();
+    test_lazy_remove_batch_revives_node_with_lower_priority();
+    test_lazy_remove_rekeyed_dead_node_is_not_popped();
+    test_meld_discards_dead_nodes_of_source();
+    test_small_heap_grows_and_shrinks();
+    test_small_heap_get_node_by_index();
+    test_snapshot_restore_keeps_pop_order();
+#if defined(LINKED_BINARY_HEAP_STATS)
+    test_stats_counters();
+#endif
 }
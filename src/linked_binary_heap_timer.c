@@ -0,0 +1,341 @@
+#include "linked_binary_heap_timer.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#endif
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static linked_binary_heap_timer_t*
+linked_binary_heap_timer_from_heap_node(
+    linked_binary_heap_node_t* heap_node)
+{
+    // heap node is the first member of the timer
+    return (linked_binary_heap_timer_t*)heap_node;
+}
+
+
+static void
+linked_binary_heap_timer_queue_notify(
+    linked_binary_heap_timer_queue_t* queue)
+{
+    if (queue->expiring)
+    {
+        return;
+    }
+    const uint64_t deadline = linked_binary_heap_timer_queue_next_deadline(queue);
+    if (deadline != queue->notified_deadline)
+    {
+        queue->notified_deadline = deadline;
+        if (queue->root_changed != NULL)
+        {
+            queue->root_changed(queue->root_changed_arg, deadline);
+        }
+    }
+}
+
+
+static void
+linked_binary_heap_timer_queue_pending_unlink(
+    linked_binary_heap_timer_queue_t* queue,
+    linked_binary_heap_timer_t* timer)
+{
+    if (timer->pending_prev != NULL)
+    {
+        timer->pending_prev->pending_next = timer->pending_next;
+    }
+    else
+    {
+        queue->pending_first = timer->pending_next;
+    }
+    if (timer->pending_next != NULL)
+    {
+        timer->pending_next->pending_prev = timer->pending_prev;
+    }
+    else
+    {
+        queue->pending_last = timer->pending_prev;
+    }
+    timer->pending_prev = NULL;
+    timer->pending_next = NULL;
+    timer->pending = 0;
+    queue->pending_count -= 1;
+}
+
+
+static void
+linked_binary_heap_timer_queue_insert(
+    linked_binary_heap_timer_queue_t* queue,
+    linked_binary_heap_timer_t* timer,
+    uint64_t deadline_ns)
+{
+    if (queue->expiring)
+    {
+        // timer armed by callback waits in arm order until expire returns, so the running
+        // expire never meets it in the heap, whatever number of mutations it waited for,
+        // its key is kept while it may be linked as dead node
+        timer->pending = 1;
+        timer->pending_deadline = deadline_ns;
+        timer->pending_prev = queue->pending_last;
+        timer->pending_next = NULL;
+        if (queue->pending_last != NULL)
+        {
+            queue->pending_last->pending_next = timer;
+        }
+        else
+        {
+            queue->pending_first = timer;
+        }
+        queue->pending_last = timer;
+        queue->pending_count += 1;
+        return;
+    }
+    // cancelled timer may still be linked as dead node in lazy remove mode,
+    // its key is replaced without moving it, push revives it at the right place
+    timer->heap_node.key = deadline_ns;
+    linked_binary_heap_push(&queue->heap, &timer->heap_node);
+}
+
+
+void
+linked_binary_heap_timer_queue_init(
+    linked_binary_heap_timer_queue_t* queue,
+    linked_binary_heap_timer_root_changed root_changed,
+    void* root_changed_arg)
+{
+    memset(queue, 0, sizeof(*queue));
+    linked_binary_heap_init_keyed(&queue->heap, LINKED_BINARY_HEAP_KEY_U64, NULL);
+    queue->root_changed = root_changed;
+    queue->root_changed_arg = root_changed_arg;
+    queue->notified_deadline = LINKED_BINARY_HEAP_TIMER_NONE;
+}
+
+
+void
+linked_binary_heap_timer_init(
+    linked_binary_heap_timer_t* timer,
+    linked_binary_heap_timer_callback callback,
+    void* data)
+{
+    linked_binary_heap_node_init(&timer->heap_node, data);
+    timer->callback = callback;
+    timer->pending_prev = NULL;
+    timer->pending_next = NULL;
+    timer->pending_deadline = 0;
+    timer->pending = 0;
+}
+
+
+void*
+linked_binary_heap_timer_data(
+    const linked_binary_heap_timer_t* timer)
+{
+    return timer->heap_node.data;
+}
+
+
+uint64_t
+linked_binary_heap_timer_deadline(
+    const linked_binary_heap_timer_t* timer)
+{
+    return timer->pending ? timer->pending_deadline : linked_binary_heap_node_get_key_u64(&timer->heap_node);
+}
+
+
+int
+linked_binary_heap_timer_is_armed(
+    const linked_binary_heap_timer_queue_t* queue,
+    const linked_binary_heap_timer_t* timer)
+{
+    return timer->pending || linked_binary_heap_contains_node(&queue->heap, &timer->heap_node);
+}
+
+
+size_t
+linked_binary_heap_timer_queue_size(
+    const linked_binary_heap_timer_queue_t* queue)
+{
+    return linked_binary_heap_size(&queue->heap) + queue->pending_count;
+}
+
+
+uint64_t
+linked_binary_heap_timer_queue_next_deadline(
+    const linked_binary_heap_timer_queue_t* queue)
+{
+    uint64_t deadline = LINKED_BINARY_HEAP_TIMER_NONE;
+    linked_binary_heap_node_t* top;
+    if (0 == linked_binary_heap_peek(&queue->heap, &top))
+    {
+        deadline = linked_binary_heap_node_get_key_u64(top);
+    }
+    // timers are pending only while expire runs callbacks
+    for (const linked_binary_heap_timer_t* timer = queue->pending_first; timer != NULL; timer = timer->pending_next)
+    {
+        if (linked_binary_heap_timer_deadline(timer) < deadline)
+        {
+            deadline = linked_binary_heap_timer_deadline(timer);
+        }
+    }
+    return deadline;
+}
+
+
+int
+linked_binary_heap_timer_arm(
+    linked_binary_heap_timer_queue_t* queue,
+    linked_binary_heap_timer_t* timer,
+    uint64_t deadline_ns)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(timer != NULL, "Timer pointer must not be null");
+    if (linked_binary_heap_timer_is_armed(queue, timer))
+    {
+        return -1;
+    }
+    linked_binary_heap_timer_queue_insert(queue, timer, deadline_ns);
+    linked_binary_heap_timer_queue_notify(queue);
+    return 0;
+}
+
+
+int
+linked_binary_heap_timer_cancel(
+    linked_binary_heap_timer_queue_t* queue,
+    linked_binary_heap_timer_t* timer)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(timer != NULL, "Timer pointer must not be null");
+    if (!linked_binary_heap_timer_is_armed(queue, timer))
+    {
+        return -1;
+    }
+    if (timer->pending)
+    {
+        linked_binary_heap_timer_queue_pending_unlink(queue, timer);
+    }
+    else
+    {
+        linked_binary_heap_remove(&queue->heap, &timer->heap_node);
+    }
+    linked_binary_heap_timer_queue_notify(queue);
+    return 0;
+}
+
+
+void
+linked_binary_heap_timer_rearm(
+    linked_binary_heap_timer_queue_t* queue,
+    linked_binary_heap_timer_t* timer,
+    uint64_t deadline_ns)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(timer != NULL, "Timer pointer must not be null");
+    // remove and push instead of key update, so timer gets the new arm order for equal deadlines
+    if (timer->pending)
+    {
+        linked_binary_heap_timer_queue_pending_unlink(queue, timer);
+    }
+    else if (linked_binary_heap_timer_is_armed(queue, timer))
+    {
+        linked_binary_heap_remove(&queue->heap, &timer->heap_node);
+    }
+    linked_binary_heap_timer_queue_insert(queue, timer, deadline_ns);
+    linked_binary_heap_timer_queue_notify(queue);
+}
+
+
+size_t
+linked_binary_heap_timer_expire(
+    linked_binary_heap_timer_queue_t* queue,
+    uint64_t now_ns)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(!queue->expiring, "Expire must not be called from timer callback");
+
+    // timers armed by callbacks are kept out of the heap until the loop ends,
+    // so every timer met in the heap was armed before this call
+    size_t count = 0;
+    linked_binary_heap_node_t* top;
+    queue->expiring = 1;
+    while (0 == linked_binary_heap_peek(&queue->heap, &top)
+        && linked_binary_heap_node_get_key_u64(top) <= now_ns)
+    {
+        linked_binary_heap_remove(&queue->heap, top);
+        linked_binary_heap_timer_t* const timer = linked_binary_heap_timer_from_heap_node(top);
+        count++;
+        if (timer->callback != NULL)
+        {
+            timer->callback(queue, timer, now_ns);
+        }
+    }
+    queue->expiring = 0;
+    while (queue->pending_first != NULL)
+    {
+        linked_binary_heap_timer_t* const timer = queue->pending_first;
+        linked_binary_heap_timer_queue_pending_unlink(queue, timer);
+        linked_binary_heap_timer_queue_insert(queue, timer, timer->pending_deadline);
+    }
+    linked_binary_heap_timer_queue_notify(queue);
+    return count;
+}
+
+
+uint64_t
+linked_binary_heap_timer_now_ns(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+#if defined(__linux__)
+int
+linked_binary_heap_timer_timerfd_set(
+    int fd,
+    uint64_t deadline_ns)
+{
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (deadline_ns != LINKED_BINARY_HEAP_TIMER_NONE)
+    {
+        // zero expiration disarms timerfd, so deadline in the past is moved to the earliest non zero one
+        spec.it_value.tv_sec = (time_t)(deadline_ns / 1000000000ull);
+        spec.it_value.tv_nsec = (long)(deadline_ns % 1000000000ull);
+        if (deadline_ns == 0)
+        {
+            spec.it_value.tv_nsec = 1;
+        }
+    }
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+
+void
+linked_binary_heap_timer_timerfd_root_changed(
+    void* arg,
+    uint64_t deadline_ns)
+{
+    ASSERT_WITH_MSG(arg != NULL, "Pointer to timerfd must not be null");
+    const int err = linked_binary_heap_timer_timerfd_set(*(const int*)arg, deadline_ns);
+    ASSERT_WITH_MSG(err == 0, "Failed to program timerfd");
+    (void)err;
+}
+#endif
@@ -0,0 +1,151 @@
+#ifndef _LINKED_BINARY_HEAP_TIMER_H_
+#define _LINKED_BINARY_HEAP_TIMER_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Timer queue built on keyed linked heap, deadline in nanoseconds is the u64 key of the timer's node,
+ * timers with equal deadlines expire in the order they were armed.
+ * Root changed callback is called only when the earliest deadline changes, so an OS timer,
+ * e.g. Linux timerfd, is reprogrammed once per change of the earliest deadline instead of once per arm.
+ * Deadlines use any monotonic clock, linked_binary_heap_timer_now_ns reads CLOCK_MONOTONIC.
+ */
+
+/* deadline reported by root changed callback when no timer is armed */
+#define LINKED_BINARY_HEAP_TIMER_NONE UINT64_MAX
+
+typedef struct linked_binary_heap_timer linked_binary_heap_timer_t;
+
+typedef struct linked_binary_heap_timer_queue linked_binary_heap_timer_queue_t;
+
+/* function called for expired timer, it may arm, rearm or cancel any timer of the queue */
+typedef void (*linked_binary_heap_timer_callback)(linked_binary_heap_timer_queue_t*, linked_binary_heap_timer_t*, uint64_t now_ns);
+
+/* function called with user argument and the new earliest deadline */
+typedef void (*linked_binary_heap_timer_root_changed)(void*, uint64_t deadline_ns);
+
+/* structure representing timer */
+struct linked_binary_heap_timer
+{
+    linked_binary_heap_node_t heap_node; /* node of the queue heap, its key is the deadline */
+    linked_binary_heap_timer_callback callback; /* function called when timer expires */
+    linked_binary_heap_timer_t* pending_prev; /* previous timer armed by callbacks of running expire */
+    linked_binary_heap_timer_t* pending_next; /* next timer armed by callbacks of running expire */
+    uint64_t pending_deadline; /* deadline of timer armed by callback, node's key is set when timer is inserted */
+    int pending; /* non zero while timer is armed by callback and waits for expire to return */
+};
+
+/* structure representing timer queue */
+struct linked_binary_heap_timer_queue
+{
+    linked_binary_heap_t heap; /* keyed heap of armed timers */
+    linked_binary_heap_timer_root_changed root_changed; /* optional function called when earliest deadline changes */
+    void* root_changed_arg; /* user argument of root changed function */
+    uint64_t notified_deadline; /* earliest deadline last reported by root changed function */
+    int expiring; /* non zero while expire runs callbacks, root change is reported once after them */
+    linked_binary_heap_timer_t* pending_first; /* timers armed by callbacks in arm order, pushed after callbacks return */
+    linked_binary_heap_timer_t* pending_last; /* the latest armed timer waiting for expire to return */
+    size_t pending_count; /* number of timers waiting for expire to return */
+};
+
+
+void
+linked_binary_heap_timer_queue_init(
+    linked_binary_heap_timer_queue_t*,
+    linked_binary_heap_timer_root_changed,
+    void*);
+
+
+void
+linked_binary_heap_timer_init(
+    linked_binary_heap_timer_t*,
+    linked_binary_heap_timer_callback,
+    void*);
+
+
+/* data pointer passed to linked_binary_heap_timer_init */
+void*
+linked_binary_heap_timer_data(
+    const linked_binary_heap_timer_t*);
+
+
+uint64_t
+linked_binary_heap_timer_deadline(
+    const linked_binary_heap_timer_t*);
+
+
+int
+linked_binary_heap_timer_is_armed(
+    const linked_binary_heap_timer_queue_t*,
+    const linked_binary_heap_timer_t*);
+
+
+/* number of armed timers */
+size_t
+linked_binary_heap_timer_queue_size(
+    const linked_binary_heap_timer_queue_t*);
+
+
+/* earliest deadline of armed timers, LINKED_BINARY_HEAP_TIMER_NONE if no timer is armed */
+uint64_t
+linked_binary_heap_timer_queue_next_deadline(
+    const linked_binary_heap_timer_queue_t*);
+
+
+/* arms timer which is not armed yet, returns -1 if timer is armed already */
+int
+linked_binary_heap_timer_arm(
+    linked_binary_heap_timer_queue_t*,
+    linked_binary_heap_timer_t*,
+    uint64_t);
+
+
+/* cancels armed timer, returns -1 if timer is not armed */
+int
+linked_binary_heap_timer_cancel(
+    linked_binary_heap_timer_queue_t*,
+    linked_binary_heap_timer_t*);
+
+
+/* arms timer with the new deadline whether it is armed or not, it expires after timers armed earlier with equal deadline */
+void
+linked_binary_heap_timer_rearm(
+    linked_binary_heap_timer_queue_t*,
+    linked_binary_heap_timer_t*,
+    uint64_t);
+
+
+/* calls callbacks of timers with deadline not later than now in deadline order, returns number of expired timers,
+ * timers armed or rearmed by callbacks are inserted once callbacks return, so they expire by the next call,
+ * root changed function reports them as due */
+size_t
+linked_binary_heap_timer_expire(
+    linked_binary_heap_timer_queue_t*,
+    uint64_t);
+
+
+/* current time of CLOCK_MONOTONIC in nanoseconds */
+uint64_t
+linked_binary_heap_timer_now_ns(void);
+
+
+#if defined(__linux__)
+/* programs timerfd created for CLOCK_MONOTONIC to expire at absolute deadline, LINKED_BINARY_HEAP_TIMER_NONE disarms it,
+ * returns -1 and sets errno on failure */
+int
+linked_binary_heap_timer_timerfd_set(
+    int,
+    uint64_t);
+
+
+/* root changed function programming timerfd, argument is pointer to int holding timerfd */
+void
+linked_binary_heap_timer_timerfd_root_changed(
+    void*,
+    uint64_t);
+#endif
+
+#endif
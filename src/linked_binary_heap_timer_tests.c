@@ -0,0 +1,301 @@
+#include "linked_binary_heap_timer.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+typedef struct item
+{
+    linked_binary_heap_timer_t timer;
+    uint32_t expired;
+    uint64_t period; /* timer is rearmed by its callback when not 0 */
+    uint64_t arm_order; /* number of arms done by the test before the last arm of this timer */
+} item_t;
+
+typedef struct notifications
+{
+    size_t count;
+    uint64_t deadline;
+} notifications_t;
+
+static uint64_t arms_count;
+static uint64_t last_expired_deadline;
+static uint64_t last_expired_arm_order;
+static int expired_out_of_order;
+
+
+void
+record_root_changed(void* arg, uint64_t deadline_ns)
+{
+    notifications_t* notifications = (notifications_t*)arg;
+    notifications->count++;
+    notifications->deadline = deadline_ns;
+}
+
+
+void
+record_expired(linked_binary_heap_timer_queue_t* queue, linked_binary_heap_timer_t* timer, uint64_t now_ns)
+{
+    item_t* item = (item_t*)linked_binary_heap_timer_data(timer);
+    const uint64_t deadline = linked_binary_heap_timer_deadline(timer);
+    // equal deadlines expire in arm order
+    if (deadline > now_ns || deadline < last_expired_deadline
+        || (deadline == last_expired_deadline && last_expired_arm_order > item->arm_order))
+    {
+        expired_out_of_order = 1;
+    }
+    last_expired_deadline = deadline;
+    last_expired_arm_order = item->arm_order;
+    item->expired++;
+    if (item->period != 0)
+    {
+        item->arm_order = arms_count++;
+        linked_binary_heap_timer_rearm(queue, timer, deadline + item->period);
+    }
+}
+
+
+void
+test_timer_expire_in_deadline_order(void)
+{
+    const size_t items_count = 5000;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    notifications_t notifications = { 0, LINKED_BINARY_HEAP_TIMER_NONE };
+    linked_binary_heap_timer_queue_t queue;
+    linked_binary_heap_timer_queue_init(&queue, record_root_changed, &notifications);
+    // most timers are cancelled before they expire
+    linked_binary_heap_set_lazy_remove(&queue.heap, 50, NULL);
+    for (size_t i = 0; i < items_count; i++)
+    {
+        linked_binary_heap_timer_init(&items[i].timer, record_expired, &items[i]);
+        items[i].expired = 0;
+        items[i].period = i % 100 == 0 ? 1000 : 0;
+        items[i].arm_order = arms_count++;
+        linked_binary_heap_timer_arm(&queue, &items[i].timer, 1000 + (uint64_t)(rand() % 10000));
+    }
+    if (0 == linked_binary_heap_timer_arm(&queue, &items[0].timer, 0))
+    {
+        printf("%s test FAILED: armed timer was armed again\n", __func__);
+        goto free_mem;
+    }
+
+    size_t cancelled = 0;
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (items[i].period == 0 && rand() % 10 != 0)
+        {
+            if (0 != linked_binary_heap_timer_cancel(&queue, &items[i].timer)
+                || 0 == linked_binary_heap_timer_cancel(&queue, &items[i].timer))
+            {
+                printf("%s test FAILED: cancel of armed timer is not accepted exactly once\n", __func__);
+                goto free_mem;
+            }
+            items[i].expired = UINT32_MAX;
+            cancelled++;
+        }
+        else if (i % 7 == 0)
+        {
+            items[i].arm_order = arms_count++;
+            linked_binary_heap_timer_rearm(&queue, &items[i].timer, 500 + (uint64_t)(rand() % 10000));
+        }
+    }
+    if (linked_binary_heap_timer_queue_size(&queue) != items_count - cancelled
+        || notifications.deadline != linked_binary_heap_timer_queue_next_deadline(&queue)
+        || 0 != linked_binary_heap_verify(&queue.heap))
+    {
+        printf("%s test FAILED: queue is not valid after cancel\n", __func__);
+        goto free_mem;
+    }
+
+    last_expired_deadline = 0;
+    last_expired_arm_order = 0;
+    expired_out_of_order = 0;
+    for (uint64_t now = 0; now <= 12000; now += 250)
+    {
+        const size_t count = notifications.count;
+        linked_binary_heap_timer_expire(&queue, now);
+        if (expired_out_of_order
+            || notifications.count > count + 1
+            || notifications.deadline != linked_binary_heap_timer_queue_next_deadline(&queue)
+            || notifications.deadline <= now)
+        {
+            printf("%s test FAILED: timers are not expired in order at %"PRIu64"\n", __func__, now);
+            goto free_mem;
+        }
+    }
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        const int armed = linked_binary_heap_timer_is_armed(&queue, &items[i].timer);
+        if ((items[i].period != 0 && (!armed || items[i].expired < 1))
+            || (items[i].period == 0 && (armed || items[i].expired == 0 || (items[i].expired > 1 && items[i].expired != UINT32_MAX))))
+        {
+            printf("%s test FAILED: timer %zu is expired %"PRIu32" times\n", __func__, i, items[i].expired);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_timer_root_changed_only_for_earliest_deadline(void)
+{
+    item_t items[4];
+    notifications_t notifications = { 0, LINKED_BINARY_HEAP_TIMER_NONE };
+    linked_binary_heap_timer_queue_t queue;
+    linked_binary_heap_timer_queue_init(&queue, record_root_changed, &notifications);
+    for (size_t i = 0; i < 4; i++)
+    {
+        linked_binary_heap_timer_init(&items[i].timer, NULL, &items[i]);
+    }
+
+    // later deadlines and cancel of not the earliest timer keep the timerfd untouched
+    linked_binary_heap_timer_arm(&queue, &items[0].timer, 100);
+    linked_binary_heap_timer_arm(&queue, &items[1].timer, 200);
+    linked_binary_heap_timer_arm(&queue, &items[2].timer, 300);
+    linked_binary_heap_timer_cancel(&queue, &items[2].timer);
+    linked_binary_heap_timer_arm(&queue, &items[3].timer, 100);
+    if (notifications.count != 1 || notifications.deadline != 100)
+    {
+        printf("%s test FAILED: root change notified %zu times\n", __func__, notifications.count);
+        return;
+    }
+    linked_binary_heap_timer_rearm(&queue, &items[0].timer, 50);
+    linked_binary_heap_timer_cancel(&queue, &items[0].timer);
+    if (notifications.count != 3 || notifications.deadline != 100)
+    {
+        printf("%s test FAILED: change of earliest deadline is not notified\n", __func__);
+        return;
+    }
+    if (2 != linked_binary_heap_timer_expire(&queue, 1000)
+        || notifications.count != 4 || notifications.deadline != LINKED_BINARY_HEAP_TIMER_NONE)
+    {
+        printf("%s test FAILED: expire is not notified once\n", __func__);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+rearm_at_now(linked_binary_heap_timer_queue_t* queue, linked_binary_heap_timer_t* timer, uint64_t now_ns)
+{
+    item_t* item = (item_t*)linked_binary_heap_timer_data(timer);
+    item->expired++;
+    linked_binary_heap_timer_rearm(queue, timer, now_ns);
+}
+
+
+void
+test_timer_expire_after_sequence_wrap(void)
+{
+    item_t items[3];
+    notifications_t notifications = { 0, LINKED_BINARY_HEAP_TIMER_NONE };
+    linked_binary_heap_timer_queue_t queue;
+    linked_binary_heap_timer_queue_init(&queue, record_root_changed, &notifications);
+    for (size_t i = 0; i < 3; i++)
+    {
+        linked_binary_heap_timer_init(&items[i].timer, i == 0 ? rearm_at_now : NULL, &items[i]);
+        items[i].expired = 0;
+    }
+    linked_binary_heap_timer_arm(&queue, &items[0].timer, 100);
+    linked_binary_heap_timer_arm(&queue, &items[1].timer, 100);
+
+    // long armed timer outlives 2^31 queue mutations, e.g. 1 hour timer at 1M operations per second
+    queue.heap.mod_count += 0x80000001u;
+    linked_binary_heap_timer_arm(&queue, &items[2].timer, 150);
+    if (3 != linked_binary_heap_timer_expire(&queue, 200) || items[0].expired != 1)
+    {
+        printf("%s test FAILED: timers armed before sequence wrap are not expired\n", __func__);
+        return;
+    }
+
+    // timer rearmed by its callback as due is left for the next expire and reported as due
+    if (!linked_binary_heap_timer_is_armed(&queue, &items[0].timer)
+        || linked_binary_heap_timer_queue_size(&queue) != 1
+        || notifications.deadline != 200
+        || 1 != linked_binary_heap_timer_expire(&queue, 200) || items[0].expired != 2)
+    {
+        printf("%s test FAILED: timer rearmed by callback is not expired by the next call\n", __func__);
+        return;
+    }
+    linked_binary_heap_timer_cancel(&queue, &items[0].timer);
+    if (linked_binary_heap_timer_queue_size(&queue) != 0 || notifications.deadline != LINKED_BINARY_HEAP_TIMER_NONE)
+    {
+        printf("%s test FAILED: queue expected to be empty\n", __func__);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+#if defined(__linux__)
+void
+test_timer_timerfd_root_changed(void)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, 0);
+    if (fd < 0)
+    {
+        printf("%s test FAILED: failed to create timerfd\n", __func__);
+        return;
+    }
+
+    item_t items[2];
+    linked_binary_heap_timer_queue_t queue;
+    linked_binary_heap_timer_queue_init(&queue, linked_binary_heap_timer_timerfd_root_changed, &fd);
+    const uint64_t now = linked_binary_heap_timer_now_ns();
+    linked_binary_heap_timer_init(&items[0].timer, NULL, &items[0]);
+    linked_binary_heap_timer_init(&items[1].timer, NULL, &items[1]);
+    linked_binary_heap_timer_arm(&queue, &items[0].timer, now + 60000000000ull);
+    linked_binary_heap_timer_arm(&queue, &items[1].timer, now + 1000000);
+
+    // blocks until the earliest deadline
+    uint64_t expirations = 0;
+    if (sizeof(expirations) != read(fd, &expirations, sizeof(expirations))
+        || linked_binary_heap_timer_now_ns() < now + 1000000
+        || 1 != linked_binary_heap_timer_expire(&queue, linked_binary_heap_timer_now_ns()))
+    {
+        printf("%s test FAILED: timerfd is not expired at the earliest deadline\n", __func__);
+        close(fd);
+        return;
+    }
+    struct itimerspec spec;
+    timerfd_gettime(fd, &spec);
+    linked_binary_heap_timer_cancel(&queue, &items[0].timer);
+    struct itimerspec disarmed;
+    timerfd_gettime(fd, &disarmed);
+    close(fd);
+    if (spec.it_value.tv_sec < 50 || disarmed.it_value.tv_sec != 0 || disarmed.it_value.tv_nsec != 0)
+    {
+        printf("%s test FAILED: timerfd is not reprogrammed\n", __func__);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+#endif
+
+
+int main(void)
+{
+    srand(42);
+    test_timer_expire_in_deadline_order();
+    test_timer_root_changed_only_for_earliest_deadline();
+    test_timer_expire_after_sequence_wrap();
+#if defined(__linux__)
+    test_timer_timerfd_root_changed();
+#endif
+}
@@ -0,0 +1,556 @@
+#ifndef _LINKED_BINARY_HEAP_TYPED_H_
+#define _LINKED_BINARY_HEAP_TYPED_H_
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Header-only generator of type specialized linked binary heaps.
+ *
+ * LINKED_BINARY_HEAP_DEFINE(prefix, node_type, member, cmp_expr) emits heap type prefix##_t
+ * and static inline functions prefix##_init/size/contains/push/pop/peek/remove/update/decrease/increase/verify
+ * operating on node_type directly. The heap hook is embedded into node_type as field `member`
+ * of type linked_binary_heap_hook_t, so no void* data indirection is needed.
+ *
+ * cmp_expr is an expression over `a` and `b` (both `const node_type*`) returning negative, zero
+ * or positive value like linked_binary_heap_node_data_comparer does. It is inlined into sifting,
+ * equal priorities are resolved in push order exactly as linked_binary_heap_t does.
+ *
+ * Example:
+ *   typedef struct timer { linked_binary_heap_hook_t hook; uint64_t deadline; } timer_t;
+ *   LINKED_BINARY_HEAP_DEFINE(timer_heap, timer_t, hook, (a->deadline > b->deadline) - (a->deadline < b->deadline))
+ */
+
+typedef struct linked_binary_heap_hook linked_binary_heap_hook_t;
+
+/* structure representing heap node embedded into user's structure */
+struct linked_binary_heap_hook
+{
+    linked_binary_heap_hook_t* parent; /* pointer to parent node in heap, can be null */
+    linked_binary_heap_hook_t* left; /* pointer to left child of node in heap, can be null */
+    linked_binary_heap_hook_t* right; /* pointer to right child of the heap, can be null */
+    const void* heap; /* pointer to a heap containing this node */
+    uint32_t sequence; /* sequence number of this node, used to resolve priority collision in push order */
+};
+
+/* structure representing heap state shared by all generated heap types */
+typedef struct linked_binary_heap_typed
+{
+    linked_binary_heap_hook_t* root; /* pointer to root node of the heap */
+    linked_binary_heap_hook_t* last; /* pointer to the last node of the heap in level order, null for empty heap */
+    uint32_t mod_count; /* number of heap modification operations executed */
+    size_t size; /* number of nodes stored in this heap */
+} linked_binary_heap_typed_t;
+
+
+#define LINKED_BINARY_HEAP_TYPED_UINT32_GT(a, b) (((b) - (a)) & 0x80000000)
+
+
+static inline linked_binary_heap_hook_t*
+linked_binary_heap_hook_predecessor(
+    linked_binary_heap_hook_t* node)
+{
+    assert(node != NULL && node->parent != NULL);
+
+    // previous node in level order, amortized O(1) for consecutive calls
+    if (node->parent->right == node)
+    {
+        return node->parent->left;
+    }
+    linked_binary_heap_hook_t* n = node;
+    uint32_t levels = 0;
+    while (n->parent != NULL && n->parent->left == n)
+    {
+        n = n->parent;
+        levels++;
+    }
+    if (n->parent == NULL)
+    {
+        levels--;
+    }
+    else
+    {
+        n = n->parent->left;
+    }
+    for (uint32_t i = 0; i < levels; i++)
+    {
+        n = n->right;
+    }
+    return n;
+}
+
+
+static inline void
+linked_binary_heap_hook_link_next(
+    linked_binary_heap_typed_t* heap,
+    linked_binary_heap_hook_t* node)
+{
+    // link node into the next free slot in level order, amortized O(1) for consecutive calls
+    linked_binary_heap_hook_t* n = heap->last;
+    if (n == NULL)
+    {
+        heap->root = node;
+        node->parent = NULL;
+        heap->last = node;
+        return;
+    }
+    if (n->parent == NULL)
+    {
+        // n is the root
+    }
+    else if (n->parent->left == n)
+    {
+        n = n->parent;
+    }
+    else
+    {
+        uint32_t levels = 0;
+        while (n->parent != NULL && n->parent->right == n)
+        {
+            n = n->parent;
+            levels++;
+        }
+        if (n->parent == NULL)
+        {
+            levels++;
+        }
+        else
+        {
+            n = n->parent->right;
+        }
+        for (uint32_t i = 1; i < levels; i++)
+        {
+            n = n->left;
+        }
+    }
+    if (n->left == NULL)
+    {
+        n->left = node;
+    }
+    else
+    {
+        n->right = node;
+    }
+    node->parent = n;
+    heap->last = node;
+}
+
+
+static inline linked_binary_heap_hook_t**
+linked_binary_heap_hook_link_from_parent(
+    linked_binary_heap_typed_t* heap,
+    linked_binary_heap_hook_t* node)
+{
+    if (node->parent == NULL)
+    {
+        return &heap->root;
+    }
+    return node->parent->left == node ? &node->parent->left : &node->parent->right;
+}
+
+
+static inline void
+linked_binary_heap_hook_move_up(
+    linked_binary_heap_typed_t* heap,
+    linked_binary_heap_hook_t* node,
+    linked_binary_heap_hook_t* top)
+{
+    // node takes position of its ancestor top, ancestors on the path shift one level down
+    linked_binary_heap_hook_t** const top_link = linked_binary_heap_hook_link_from_parent(heap, top);
+    linked_binary_heap_hook_t* const top_parent = top->parent;
+    linked_binary_heap_hook_t* left = node->left;
+    linked_binary_heap_hook_t* right = node->right;
+    linked_binary_heap_hook_t* below = node;
+    linked_binary_heap_hook_t* ancestor = node->parent;
+    if (heap->last == node)
+    {
+        heap->last = ancestor;
+    }
+    for (;;)
+    {
+        linked_binary_heap_hook_t* const next = ancestor->parent;
+        const int from_left = (ancestor->left == below);
+        linked_binary_heap_hook_t* const sibling = from_left ? ancestor->right : ancestor->left;
+
+        ancestor->left = left;
+        if (left != NULL)
+        {
+            left->parent = ancestor;
+        }
+        ancestor->right = right;
+        if (right != NULL)
+        {
+            right->parent = ancestor;
+        }
+        left = from_left ? ancestor : sibling;
+        right = from_left ? sibling : ancestor;
+        if (ancestor == top)
+        {
+            break;
+        }
+        below = ancestor;
+        ancestor = next;
+    }
+    *top_link = node;
+    node->parent = top_parent;
+    node->left = left;
+    left->parent = node;
+    node->right = right;
+    if (right != NULL)
+    {
+        right->parent = node;
+    }
+}
+
+
+static inline void
+linked_binary_heap_hook_move_down(
+    linked_binary_heap_typed_t* heap,
+    linked_binary_heap_hook_t* node,
+    size_t path,
+    uint32_t depth)
+{
+    // node moves depth levels down along path (bit set means right), children on the path shift one level up
+    linked_binary_heap_hook_t** link = linked_binary_heap_hook_link_from_parent(heap, node);
+    linked_binary_heap_hook_t* parent = node->parent;
+    linked_binary_heap_hook_t* left = node->left;
+    linked_binary_heap_hook_t* right = node->right;
+    for (uint32_t i = 0; i < depth; i++)
+    {
+        const int to_right = (path & (((size_t)1) << i)) != 0;
+        linked_binary_heap_hook_t* const child = to_right ? right : left;
+        linked_binary_heap_hook_t* const sibling = to_right ? left : right;
+        left = child->left;
+        right = child->right;
+
+        *link = child;
+        child->parent = parent;
+        if (to_right)
+        {
+            child->left = sibling;
+            link = &child->right;
+        }
+        else
+        {
+            child->right = sibling;
+            link = &child->left;
+        }
+        if (sibling != NULL)
+        {
+            sibling->parent = child;
+        }
+        parent = child;
+    }
+    if (heap->last == parent)
+    {
+        heap->last = node;
+    }
+    *link = node;
+    node->parent = parent;
+    node->left = left;
+    if (left != NULL)
+    {
+        left->parent = node;
+    }
+    node->right = right;
+    if (right != NULL)
+    {
+        right->parent = node;
+    }
+}
+
+
+static inline void
+linked_binary_heap_hook_replace(
+    linked_binary_heap_typed_t* heap,
+    linked_binary_heap_hook_t* node,
+    linked_binary_heap_hook_t* replacement)
+{
+    // replacement (detached) takes position of node in the tree
+    *linked_binary_heap_hook_link_from_parent(heap, node) = replacement;
+    replacement->parent = node->parent;
+    replacement->left = node->left;
+    replacement->right = node->right;
+    if (replacement->left != NULL)
+    {
+        replacement->left->parent = replacement;
+    }
+    if (replacement->right != NULL)
+    {
+        replacement->right->parent = replacement;
+    }
+    if (heap->last == node)
+    {
+        heap->last = replacement;
+    }
+}
+
+
+static inline void
+linked_binary_heap_hook_detach_last(
+    linked_binary_heap_typed_t* heap)
+{
+    linked_binary_heap_hook_t* const last = heap->last;
+    if (last->parent == NULL)
+    {
+        heap->root = NULL;
+        heap->last = NULL;
+        return;
+    }
+    heap->last = linked_binary_heap_hook_predecessor(last);
+    if (last->parent->left == last)
+    {
+        last->parent->left = NULL;
+    }
+    else
+    {
+        last->parent->right = NULL;
+    }
+}
+
+
+#define LINKED_BINARY_HEAP_DEFINE(prefix, node_type, member, cmp_expr) \
+\
+typedef struct prefix \
+{ \
+    linked_binary_heap_typed_t base; \
+} prefix##_t; \
+\
+static inline node_type* \
+prefix##_entry(linked_binary_heap_hook_t* hook) \
+{ \
+    return (node_type*)(void*)((char*)hook - offsetof(node_type, member)); \
+} \
+\
+static inline int \
+prefix##_compare_data(const node_type* a, const node_type* b) \
+{ \
+    return (cmp_expr); \
+} \
+\
+static inline int \
+prefix##_compare(linked_binary_heap_hook_t* x, linked_binary_heap_hook_t* y) \
+{ \
+    const int cmp = prefix##_compare_data(prefix##_entry(x), prefix##_entry(y)); \
+    if (cmp != 0) \
+    { \
+        return cmp; \
+    } \
+    if (x->sequence == y->sequence) \
+    { \
+        return 0; \
+    } \
+    return LINKED_BINARY_HEAP_TYPED_UINT32_GT(x->sequence, y->sequence) ? 1 : -1; \
+} \
+\
+static inline void \
+prefix##_bubble_up(prefix##_t* heap, linked_binary_heap_hook_t* node) \
+{ \
+    linked_binary_heap_hook_t* top = node->parent; \
+    if (top == NULL || prefix##_compare(node, top) > 0) \
+    { \
+        return; \
+    } \
+    while (top->parent != NULL && prefix##_compare(node, top->parent) <= 0) \
+    { \
+        top = top->parent; \
+    } \
+    linked_binary_heap_hook_move_up(&heap->base, node, top); \
+} \
+\
+static inline void \
+prefix##_bubble_down(prefix##_t* heap, linked_binary_heap_hook_t* node) \
+{ \
+    const uint32_t max_depth = sizeof(size_t) * 8; \
+    size_t path = 0; \
+    uint32_t depth = 0; \
+    linked_binary_heap_hook_t* position = node; \
+    for (; depth < max_depth; depth++) \
+    { \
+        linked_binary_heap_hook_t* smallest = node; \
+        if (position->left != NULL && prefix##_compare(position->left, smallest) < 0) \
+        { \
+            smallest = position->left; \
+        } \
+        if (position->right != NULL && prefix##_compare(position->right, smallest) < 0) \
+        { \
+            smallest = position->right; \
+        } \
+        if (smallest == node) \
+        { \
+            break; \
+        } \
+        if (smallest == position->right) \
+        { \
+            path |= ((size_t)1) << depth; \
+        } \
+        position = smallest; \
+    } \
+    if (depth > 0) \
+    { \
+        linked_binary_heap_hook_move_down(&heap->base, node, path, depth); \
+    } \
+} \
+\
+static inline void \
+prefix##_init(prefix##_t* heap) \
+{ \
+    heap->base.root = NULL; \
+    heap->base.last = NULL; \
+    heap->base.mod_count = 0; \
+    heap->base.size = 0; \
+} \
+\
+static inline void \
+prefix##_node_init(node_type* node) \
+{ \
+    node->member.parent = NULL; \
+    node->member.left = NULL; \
+    node->member.right = NULL; \
+    node->member.heap = NULL; \
+    node->member.sequence = 0; \
+} \
+\
+static inline size_t \
+prefix##_size(const prefix##_t* heap) \
+{ \
+    return heap->base.size; \
+} \
+\
+static inline int \
+prefix##_contains_node(const prefix##_t* heap, const node_type* node) \
+{ \
+    return node->member.heap == (const void*)heap; \
+} \
+\
+static inline void \
+prefix##_push(prefix##_t* heap, node_type* node) \
+{ \
+    linked_binary_heap_hook_t* const hook = &node->member; \
+    assert(hook->heap == NULL && "Node is already inserted into the heap"); \
+    hook->heap = heap; \
+    hook->left = NULL; \
+    hook->right = NULL; \
+    hook->sequence = heap->base.mod_count; \
+    linked_binary_heap_hook_link_next(&heap->base, hook); \
+    heap->base.size += 1; \
+    heap->base.mod_count += 1; \
+    prefix##_bubble_up(heap, hook); \
+} \
+\
+static inline void \
+prefix##_remove(prefix##_t* heap, node_type* node) \
+{ \
+    linked_binary_heap_hook_t* const hook = &node->member; \
+    assert(hook->heap == (const void*)heap && "Node belong to different heap"); \
+    linked_binary_heap_hook_t* const last = heap->base.last; \
+    heap->base.size -= 1; \
+    heap->base.mod_count += 1; \
+    linked_binary_heap_hook_detach_last(&heap->base); \
+    if (last != hook) \
+    { \
+        linked_binary_heap_hook_replace(&heap->base, hook, last); \
+        prefix##_bubble_down(heap, last); \
+        prefix##_bubble_up(heap, last); \
+    } \
+    hook->parent = NULL; \
+    hook->left = NULL; \
+    hook->right = NULL; \
+    hook->heap = NULL; \
+    hook->sequence = 0; \
+} \
+\
+static inline int \
+prefix##_peek(const prefix##_t* heap, node_type** out_node) \
+{ \
+    if (heap->base.root == NULL) \
+    { \
+        /* out node is never left unset, so inlined callers are not flagged as maybe uninitialized */ \
+        *out_node = NULL; \
+        return -1; \
+    } \
+    *out_node = prefix##_entry(heap->base.root); \
+    return 0; \
+} \
+\
+static inline int \
+prefix##_pop(prefix##_t* heap, node_type** out_node) \
+{ \
+    if (0 != prefix##_peek(heap, out_node)) \
+    { \
+        return -1; \
+    } \
+    prefix##_remove(heap, *out_node); \
+    return 0; \
+} \
+\
+static inline void \
+prefix##_update(prefix##_t* heap, node_type* node) \
+{ \
+    linked_binary_heap_hook_t* const hook = &node->member; \
+    assert(hook->heap == (const void*)heap && "Node belong to different heap"); \
+    heap->base.mod_count += 1; \
+    if (hook->parent != NULL && prefix##_compare(hook, hook->parent) < 0) \
+    { \
+        prefix##_bubble_up(heap, hook); \
+    } \
+    else \
+    { \
+        prefix##_bubble_down(heap, hook); \
+    } \
+} \
+\
+static inline void \
+prefix##_decrease(prefix##_t* heap, node_type* node) \
+{ \
+    assert(node->member.heap == (const void*)heap && "Node belong to different heap"); \
+    heap->base.mod_count += 1; \
+    prefix##_bubble_up(heap, &node->member); \
+} \
+\
+static inline void \
+prefix##_increase(prefix##_t* heap, node_type* node) \
+{ \
+    assert(node->member.heap == (const void*)heap && "Node belong to different heap"); \
+    heap->base.mod_count += 1; \
+    prefix##_bubble_down(heap, &node->member); \
+} \
+\
+static inline size_t \
+prefix##_verify_subtree(const prefix##_t* heap, linked_binary_heap_hook_t* node, int* err) \
+{ \
+    if (node == NULL || *err != 0) \
+    { \
+        return 0; \
+    } \
+    if (node->heap != (const void*)heap \
+        || (node->parent == NULL && node != heap->base.root) \
+        || (node->left != NULL && node->left->parent != node) \
+        || (node->right != NULL && node->right->parent != node) \
+        || (node->parent != NULL && prefix##_compare(node->parent, node) > 0)) \
+    { \
+        *err = -1; \
+        return 0; \
+    } \
+    return 1 + prefix##_verify_subtree(heap, node->left, err) + prefix##_verify_subtree(heap, node->right, err); \
+} \
+\
+static inline int \
+prefix##_verify(const prefix##_t* heap) \
+{ \
+    int err = 0; \
+    const size_t count = prefix##_verify_subtree(heap, heap->base.root, &err); \
+    if (err != 0 || count != heap->base.size) \
+    { \
+        return -1; \
+    } \
+    if ((heap->base.size == 0) != (heap->base.last == NULL) \
+        || (heap->base.last != NULL && (heap->base.last->left != NULL || heap->base.last->right != NULL))) \
+    { \
+        return -1; \
+    } \
+    return 0; \
+}
+
+#endif
@@ -0,0 +1,229 @@
+#include "linked_binary_heap.h"
+#include "linked_binary_heap_typed.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+typedef struct item
+{
+    linked_binary_heap_hook_t hook;
+    linked_binary_heap_node_t heap_node;
+    int32_t priority;
+} item_t;
+
+
+LINKED_BINARY_HEAP_DEFINE(item_heap, item_t, hook, (a->priority > b->priority) - (a->priority < b->priority))
+
+
+int
+item_comparer(const void* x, const void* y)
+{
+    const item_t* X = x;
+    const item_t* Y = y;
+    return (X->priority > Y->priority) - (X->priority < Y->priority);
+}
+
+
+void
+shuffle_array(uint32_t *a, size_t size)
+{
+    for (size_t i = size - 1; i >= 1; i--)
+    {
+        const size_t r = (size_t)1 * RAND_MAX * rand() + rand();
+        size_t j = r % (i + 1);
+        uint32_t temp = a[j];
+        a[j] = a[i];
+        a[i] = temp;
+    }
+}
+
+
+void
+test_typed_heap_push_pop_random_items(void)
+{
+    const size_t items_count = 256 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    item_heap_t heap;
+    item_heap_init(&heap);
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = (int32_t)(rand() % items_count);
+        item_heap_node_init(&items[i]);
+        item_heap_push(&heap, &items[i]);
+        if (item_heap_size(&heap) != i + 1)
+        {
+            printf("%s test FAILED: heap size expected to be %zu\n", __func__, i + 1);
+            goto free_mem;
+        }
+    }
+
+    if (0 != item_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid\n", __func__);
+        goto free_mem;
+    }
+
+    int32_t root_priority = INT32_MIN;
+    item_t* top;
+    while (0 == item_heap_pop(&heap, &top))
+    {
+        if (root_priority > top->priority)
+        {
+            printf("%s test FAILED: Priority %"PRId32" of popped item is less than previously popped %"PRId32" \n",
+                __func__, top->priority, root_priority);
+            goto free_mem;
+        }
+        root_priority = top->priority;
+    }
+
+    if (item_heap_size(&heap) != 0)
+    {
+        printf("%s test FAILED: heap size expected to be 0\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_typed_heap_random_remove_and_update(void)
+{
+    const uint32_t items_count = 16 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    uint32_t* order = (uint32_t*)malloc(items_count * sizeof(uint32_t));
+    if (items == NULL || order == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    item_heap_t heap;
+    item_heap_init(&heap);
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        order[i] = i;
+        items[i].priority = (int32_t)(rand() % items_count);
+        item_heap_node_init(&items[i]);
+        item_heap_push(&heap, &items[i]);
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        item_t* item = &items[rand() % items_count];
+        const int32_t old_priority = item->priority;
+        item->priority = (int32_t)(rand() % items_count);
+        if (i % 2 == 0)
+        {
+            item_heap_update(&heap, item);
+        }
+        else if (item->priority < old_priority)
+        {
+            item_heap_decrease(&heap, item);
+        }
+        else
+        {
+            item_heap_increase(&heap, item);
+        }
+    }
+    if (0 != item_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap state is invalid after update\n", __func__);
+        goto free_mem;
+    }
+
+    shuffle_array(order, items_count);
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        item_heap_remove(&heap, &items[order[i]]);
+        if (i % 256 == 0 && 0 != item_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap state is invalid after remove\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    if (item_heap_size(&heap) != 0 || 0 != item_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+    free(order);
+}
+
+
+void
+test_typed_heap_matches_linked_binary_heap(void)
+{
+    // same operations on both heaps in one binary must produce the same pop order,
+    // including FIFO resolution of equal priorities
+    const size_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    item_heap_t typed;
+    item_heap_init(&typed);
+    linked_binary_heap_t linked;
+    linked_binary_heap_init(&linked, item_comparer, NULL);
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        items[i].priority = (int32_t)(rand() % 64);
+        item_heap_node_init(&items[i]);
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        item_heap_push(&typed, &items[i]);
+        linked_binary_heap_push(&linked, &items[i].heap_node);
+    }
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        item_t* typed_top = NULL;
+        linked_binary_heap_node_t* linked_top = NULL;
+        item_heap_pop(&typed, &typed_top);
+        linked_binary_heap_pop(&linked, &linked_top);
+        if (typed_top != linked_top->data)
+        {
+            printf("%s test FAILED: pop order differs at %zu\n", __func__, i);
+            goto free_mem;
+        }
+        if (i % 3 == 0)
+        {
+            // reinsert with new priority to exercise sequence numbers
+            typed_top->priority = (int32_t)(rand() % 64);
+            item_heap_push(&typed, typed_top);
+            linked_binary_heap_push(&linked, linked_top);
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_typed_heap_push_pop_random_items();
+    test_typed_heap_random_remove_and_update();
+    test_typed_heap_matches_linked_binary_heap();
+}
@@ -0,0 +1,517 @@
+#include "min_max_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(LINKED_BINARY_HEAP_DEBUG)
+#define MIN_MAX_HEAP_VERIFY_MUTATE_FUNCTIONS
+#endif
+
+#define MIN_MAX_HEAP_MIN_CAPACITY 16
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static inline int
+min_max_heap_compare(
+    const min_max_heap_t* heap,
+    const linked_binary_heap_node_t* a,
+    const linked_binary_heap_node_t* b)
+{
+    if (heap->comparer == NULL)
+    {
+        return a->key == b->key ? 0 : (a->key < b->key ? -1 : 1);
+    }
+    return heap->comparer(a->data, b->data);
+}
+
+
+static inline int
+min_max_heap_better(
+    const min_max_heap_t* heap,
+    const linked_binary_heap_node_t* a,
+    const linked_binary_heap_node_t* b,
+    int max_level)
+{
+    // node closer to the root of min levels is smaller and of max levels is bigger
+    const int cmp = min_max_heap_compare(heap, a, b);
+    return max_level ? cmp > 0 : cmp < 0;
+}
+
+
+static inline int
+min_max_heap_is_max_level(
+    size_t index)
+{
+    // level of node is the index of the highest bit of index + 1, root level 0 is a min level
+#if defined(__GNUC__) || defined(__clang__)
+    return (int)((sizeof(unsigned long long) * 8 - 1 - (size_t)__builtin_clzll((unsigned long long)index + 1)) & 1);
+#else
+    int level = 0;
+    for (size_t i = index + 1; i > 1; i >>= 1)
+    {
+        level ^= 1;
+    }
+    return level;
+#endif
+}
+
+
+static inline void
+min_max_heap_place(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node,
+    size_t index)
+{
+    heap->nodes[index] = node;
+    node->sequence = (uint32_t)index;
+}
+
+
+static void
+min_max_heap_bubble_up(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    size_t index = node->sequence;
+    if (index == 0)
+    {
+        return;
+    }
+    int max_level = min_max_heap_is_max_level(index);
+    const size_t parent_index = (index - 1) / 2;
+    if (min_max_heap_better(heap, node, heap->nodes[parent_index], !max_level))
+    {
+        // node belongs to levels of the other kind, parent moves down into the hole
+        min_max_heap_place(heap, heap->nodes[parent_index], index);
+        index = parent_index;
+        max_level = !max_level;
+    }
+    // move grandparents down into the hole until node's place is found
+    while (index > 2)
+    {
+        const size_t grandparent_index = (index - 3) / 4;
+        if (!min_max_heap_better(heap, node, heap->nodes[grandparent_index], max_level))
+        {
+            break;
+        }
+        min_max_heap_place(heap, heap->nodes[grandparent_index], index);
+        index = grandparent_index;
+    }
+    min_max_heap_place(heap, node, index);
+}
+
+
+static void
+min_max_heap_trickle_down(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    const size_t size = heap->size;
+    size_t index = node->sequence;
+    const int max_level = min_max_heap_is_max_level(index);
+    for (;;)
+    {
+        // the best of up to 2 children and 4 grandchildren
+        const size_t first_child = 2 * index + 1;
+        if (first_child >= size)
+        {
+            break;
+        }
+        size_t best = first_child;
+        if (first_child + 1 < size && min_max_heap_better(heap, heap->nodes[first_child + 1], heap->nodes[best], max_level))
+        {
+            best = first_child + 1;
+        }
+        const size_t first_grandchild = 2 * first_child + 1;
+        for (size_t i = first_grandchild; i < first_grandchild + 4 && i < size; i++)
+        {
+            if (min_max_heap_better(heap, heap->nodes[i], heap->nodes[best], max_level))
+            {
+                best = i;
+            }
+        }
+        if (!min_max_heap_better(heap, heap->nodes[best], node, max_level))
+        {
+            break;
+        }
+        min_max_heap_place(heap, heap->nodes[best], index);
+        index = best;
+        if (best < first_grandchild)
+        {
+            break;
+        }
+        // node moved two levels down may belong to the level between, then it swaps with the parent
+        // and the parent continues down instead of it
+        const size_t parent_index = (best - 1) / 2;
+        if (min_max_heap_better(heap, heap->nodes[parent_index], node, max_level))
+        {
+            linked_binary_heap_node_t* const parent = heap->nodes[parent_index];
+            min_max_heap_place(heap, node, parent_index);
+            node = parent;
+        }
+    }
+    min_max_heap_place(heap, node, index);
+}
+
+
+static void
+min_max_heap_fix(
+    min_max_heap_t* heap,
+    size_t index)
+{
+    // node at index either violates order with its ancestors or with its descendants,
+    // if it moves up, the ancestor moved into its place may still be out of order with descendants
+    min_max_heap_bubble_up(heap, heap->nodes[index]);
+    min_max_heap_trickle_down(heap, heap->nodes[index]);
+}
+
+
+static size_t
+min_max_heap_max_index(
+    const min_max_heap_t* heap)
+{
+    if (heap->size < 3)
+    {
+        return heap->size - 1;
+    }
+    return min_max_heap_compare(heap, heap->nodes[1], heap->nodes[2]) >= 0 ? 1 : 2;
+}
+
+
+static int
+min_max_heap_grow(
+    min_max_heap_t* heap,
+    size_t required)
+{
+    if (required <= heap->capacity)
+    {
+        return 0;
+    }
+    size_t capacity = heap->capacity < MIN_MAX_HEAP_MIN_CAPACITY ? MIN_MAX_HEAP_MIN_CAPACITY : heap->capacity;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+    linked_binary_heap_node_t** nodes = (linked_binary_heap_node_t**)realloc(heap->nodes, capacity * sizeof(linked_binary_heap_node_t*));
+    if (nodes == NULL)
+    {
+        return -1;
+    }
+    heap->nodes = nodes;
+    heap->capacity = capacity;
+    return 0;
+}
+
+
+static void
+min_max_heap_detach(
+    linked_binary_heap_node_t* node)
+{
+    node->sequence = 0;
+}
+
+
+void
+min_max_heap_init(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_data_comparer comparer)
+{
+    memset(heap, 0, sizeof(*heap));
+    heap->comparer = comparer;
+}
+
+
+void
+min_max_heap_init_keyed(
+    min_max_heap_t* heap)
+{
+    min_max_heap_init(heap, NULL);
+}
+
+
+void
+min_max_heap_destroy(
+    min_max_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    for (size_t i = 0; i < heap->size; i++)
+    {
+        min_max_heap_detach(heap->nodes[i]);
+    }
+    free(heap->nodes);
+    heap->nodes = NULL;
+    heap->capacity = 0;
+    heap->size = 0;
+}
+
+
+int
+min_max_heap_reserve(
+    min_max_heap_t* heap,
+    size_t capacity)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    return min_max_heap_grow(heap, capacity);
+}
+
+
+int
+min_max_heap_set_bound(
+    min_max_heap_t* heap,
+    size_t bound)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (bound != 0 && (heap->size > bound || 0 != min_max_heap_grow(heap, bound)))
+    {
+        return -1;
+    }
+    heap->bound = bound;
+    return 0;
+}
+
+
+size_t
+min_max_heap_size(
+    const min_max_heap_t* heap)
+{
+    return heap->size;
+}
+
+
+uint32_t
+min_max_heap_version(
+    const min_max_heap_t* heap)
+{
+    return heap->mod_count;
+}
+
+
+int
+min_max_heap_contains_node(
+    const min_max_heap_t* heap,
+    const linked_binary_heap_node_t* node)
+{
+    return node->sequence < heap->size && heap->nodes[node->sequence] == node;
+}
+
+
+int
+min_max_heap_push(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->heap != NULL || min_max_heap_contains_node(heap, node))
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return -1;
+    }
+    // index of node is kept in its 32 bit sequence
+    if ((heap->bound != 0 && heap->size >= heap->bound) || heap->size >= UINT32_MAX
+        || 0 != min_max_heap_grow(heap, heap->size + 1))
+    {
+        return -1;
+    }
+    min_max_heap_place(heap, node, heap->size);
+    heap->size += 1;
+    heap->mod_count += 1;
+    min_max_heap_bubble_up(heap, node);
+#if defined(MIN_MAX_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    min_max_heap_verify(heap);
+#endif
+    return 0;
+}
+
+
+linked_binary_heap_node_t*
+min_max_heap_push_bounded(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    ASSERT_WITH_MSG(heap->bound != 0, "Heap must be bounded");
+    if (heap->size < heap->bound)
+    {
+        // array is preallocated by set bound, so push can not fail
+        const int result = min_max_heap_push(heap, node);
+        ASSERT_WITH_MSG(result == 0, "Push into not full bounded heap must succeed");
+        (void)result;
+        return NULL;
+    }
+    if (node->heap != NULL || min_max_heap_contains_node(heap, node))
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return NULL;
+    }
+    const size_t max_index = min_max_heap_max_index(heap);
+    linked_binary_heap_node_t* const evicted = heap->nodes[max_index];
+    if (min_max_heap_compare(heap, node, evicted) >= 0)
+    {
+        return node;
+    }
+    // pushed node takes the place of the evicted one, which is cheaper than remove and push
+    min_max_heap_place(heap, node, max_index);
+    min_max_heap_detach(evicted);
+    heap->mod_count += 1;
+    min_max_heap_fix(heap, max_index);
+#if defined(MIN_MAX_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    min_max_heap_verify(heap);
+#endif
+    return evicted;
+}
+
+
+void
+min_max_heap_remove(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (!min_max_heap_contains_node(heap, node))
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    const size_t index = node->sequence;
+    heap->size -= 1;
+    heap->mod_count += 1;
+    linked_binary_heap_node_t* const last_node = heap->nodes[heap->size];
+    if (last_node != node)
+    {
+        min_max_heap_place(heap, last_node, index);
+        min_max_heap_fix(heap, index);
+    }
+    min_max_heap_detach(node);
+#if defined(MIN_MAX_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    min_max_heap_verify(heap);
+#endif
+}
+
+
+void
+min_max_heap_update(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (!min_max_heap_contains_node(heap, node))
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    min_max_heap_fix(heap, node->sequence);
+#if defined(MIN_MAX_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    min_max_heap_verify(heap);
+#endif
+}
+
+
+int
+min_max_heap_peek_min(
+    const min_max_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (heap->size > 0)
+    {
+        *out_node = heap->nodes[0];
+        return 0;
+    }
+    return -1;
+}
+
+
+int
+min_max_heap_peek_max(
+    const min_max_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (heap->size > 0)
+    {
+        *out_node = heap->nodes[min_max_heap_max_index(heap)];
+        return 0;
+    }
+    return -1;
+}
+
+
+int
+min_max_heap_pop_min(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    if (0 != min_max_heap_peek_min(heap, out_node))
+    {
+        return -1;
+    }
+    min_max_heap_remove(heap, *out_node);
+    return 0;
+}
+
+
+int
+min_max_heap_pop_max(
+    min_max_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    if (0 != min_max_heap_peek_max(heap, out_node))
+    {
+        return -1;
+    }
+    min_max_heap_remove(heap, *out_node);
+    return 0;
+}
+
+
+int
+min_max_heap_verify(
+    const min_max_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (heap->size > heap->capacity || (heap->bound != 0 && heap->size > heap->bound))
+    {
+        ASSERT_WITH_MSG(0, "Heap size exceeds capacity");
+        return -1;
+    }
+    for (size_t i = 0; i < heap->size; i++)
+    {
+        const linked_binary_heap_node_t* const node = heap->nodes[i];
+        if (node->sequence != i)
+        {
+            ASSERT_WITH_MSG(0, "Node has wrong index");
+            return -1;
+        }
+        // order with the nearest ancestors of both kinds implies order with all ancestors
+        const int max_level = min_max_heap_is_max_level(i);
+        if (i > 0 && min_max_heap_better(heap, node, heap->nodes[(i - 1) / 2], !max_level))
+        {
+            ASSERT_WITH_MSG(0, "Node is out of order with its parent");
+            return -1;
+        }
+        if (i > 2 && min_max_heap_better(heap, node, heap->nodes[(i - 3) / 4], max_level))
+        {
+            ASSERT_WITH_MSG(0, "Node is out of order with its grandparent");
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#ifndef _MIN_MAX_HEAP_H_
+#define _MIN_MAX_HEAP_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Array backed min-max heap of linked_binary_heap_node_t, double ended priority queue
+ * with both the smallest and the biggest node found in O(1) and removed in O(log n).
+ * Nodes on even levels are not bigger than their descendants, nodes on odd levels are not smaller.
+ * Nodes are ordered by comparer or by u64 keys set with linked_binary_heap_node_set_key_* before push,
+ * after priority of a node in the heap is changed min_max_heap_update must be called.
+ * Node's sequence holds its array index, so nodes with equal priority are not popped in push order.
+ * Bounded heap keeps at most given number of the smallest nodes pushed into it, e.g. streaming top-K.
+ */
+
+typedef struct min_max_heap min_max_heap_t;
+
+/* structure representing heap */
+struct min_max_heap
+{
+    linked_binary_heap_node_t** nodes; /* array of pointers to nodes in level order */
+    size_t capacity; /* number of nodes array can hold */
+    size_t size; /* number of nodes stored in this heap */
+    size_t bound; /* maximal number of nodes of bounded heap, 0 for unbounded heap */
+    uint32_t mod_count; /* number of heap modification operations executed */
+    linked_binary_heap_node_data_comparer comparer; /* function to compare data associated with nodes, null for keyed heap */
+};
+
+
+void
+min_max_heap_init(
+    min_max_heap_t*,
+    linked_binary_heap_node_data_comparer);
+
+
+/* initializes heap ordered by u64 key cached in nodes instead of comparer */
+void
+min_max_heap_init_keyed(
+    min_max_heap_t*);
+
+
+/* releases heap array, nodes still in the heap are detached */
+void
+min_max_heap_destroy(
+    min_max_heap_t*);
+
+
+/* preallocates heap array for at least given number of nodes, returns -1 on allocation failure */
+int
+min_max_heap_reserve(
+    min_max_heap_t*,
+    size_t);
+
+
+/* limits number of nodes in the heap and preallocates array for them, so bounded push never allocates,
+ * 0 makes heap unbounded, returns -1 on allocation failure or when heap already has more nodes */
+int
+min_max_heap_set_bound(
+    min_max_heap_t*,
+    size_t);
+
+
+size_t
+min_max_heap_size(
+    const min_max_heap_t*);
+
+
+uint32_t
+min_max_heap_version(
+    const min_max_heap_t*);
+
+
+int
+min_max_heap_contains_node(
+    const min_max_heap_t*,
+    const linked_binary_heap_node_t*);
+
+
+/* returns -1 if heap array can not be grown or bounded heap is full */
+int
+min_max_heap_push(
+    min_max_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+/* pushes node into bounded heap, when heap is full the biggest of its nodes and the pushed one is evicted,
+ * returns evicted node which is not in the heap anymore and can be reused, or null if nothing was evicted */
+linked_binary_heap_node_t*
+min_max_heap_push_bounded(
+    min_max_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+void
+min_max_heap_remove(
+    min_max_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+/* moves node after its priority was changed in any direction */
+void
+min_max_heap_update(
+    min_max_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+int
+min_max_heap_peek_min(
+    const min_max_heap_t*,
+    linked_binary_heap_node_t**);
+
+
+int
+min_max_heap_peek_max(
+    const min_max_heap_t*,
+    linked_binary_heap_node_t**);
+
+
+int
+min_max_heap_pop_min(
+    min_max_heap_t*,
+    linked_binary_heap_node_t**);
+
+
+int
+min_max_heap_pop_max(
+    min_max_heap_t*,
+    linked_binary_heap_node_t**);
+
+
+int
+min_max_heap_verify(
+    const min_max_heap_t*);
+
+#endif
@@ -0,0 +1,199 @@
+#include "min_max_heap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+typedef struct item
+{
+    linked_binary_heap_node_t heap_node;
+    int32_t priority;
+} item_t;
+
+
+int
+item_comparer(const void* x, const void* y)
+{
+    const item_t* X = x;
+    const item_t* Y = y;
+    return X->priority - Y->priority;
+}
+
+
+int
+uint64_comparer(const void* x, const void* y)
+{
+    const uint64_t X = *(const uint64_t*)x;
+    const uint64_t Y = *(const uint64_t*)y;
+    return X == Y ? 0 : (X < Y ? -1 : 1);
+}
+
+
+void
+test_min_max_heap_pop_both_ends(void)
+{
+    const size_t items_count = 20000;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    min_max_heap_t heap;
+    min_max_heap_init(&heap, item_comparer);
+    for (size_t i = 0; i < items_count; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        items[i].priority = (int32_t)(rand() % 1000);
+        min_max_heap_push(&heap, &items[i].heap_node);
+    }
+    // remove and update random nodes, half of updated ones move to the other end
+    for (size_t i = 0; i < items_count / 4; i++)
+    {
+        item_t* item = &items[(size_t)rand() % items_count];
+        if (!min_max_heap_contains_node(&heap, &item->heap_node))
+        {
+            continue;
+        }
+        if (i % 2 == 0)
+        {
+            min_max_heap_remove(&heap, &item->heap_node);
+        }
+        else
+        {
+            item->priority = (int32_t)(rand() % 1000);
+            min_max_heap_update(&heap, &item->heap_node);
+        }
+    }
+    if (0 != min_max_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap is not valid after remove and update\n", __func__);
+        goto free_mem;
+    }
+
+    int32_t low = INT32_MIN;
+    int32_t high = INT32_MAX;
+    while (min_max_heap_size(&heap) > 0)
+    {
+        linked_binary_heap_node_t* min = NULL;
+        linked_binary_heap_node_t* max = NULL;
+        if (0 != min_max_heap_peek_min(&heap, &min) || 0 != min_max_heap_peek_max(&heap, &max)
+            || ((item_t*)min->data)->priority > ((item_t*)max->data)->priority)
+        {
+            printf("%s test FAILED: peek of non empty heap failed\n", __func__);
+            goto free_mem;
+        }
+        linked_binary_heap_node_t* top = NULL;
+        const int pop_max = rand() % 2;
+        if (pop_max ? 0 != min_max_heap_pop_max(&heap, &top) : 0 != min_max_heap_pop_min(&heap, &top))
+        {
+            printf("%s test FAILED: pop of non empty heap failed\n", __func__);
+            goto free_mem;
+        }
+        const int32_t priority = ((item_t*)top->data)->priority;
+        if (top != (pop_max ? max : min) || min_max_heap_contains_node(&heap, top)
+            || (pop_max ? priority > high : priority < low))
+        {
+            printf("%s test FAILED: %" PRId32 " popped out of order\n", __func__, priority);
+            goto free_mem;
+        }
+        if (pop_max)
+        {
+            high = priority;
+        }
+        else
+        {
+            low = priority;
+        }
+        if (min_max_heap_size(&heap) % 1000 == 0 && 0 != min_max_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap is not valid\n", __func__);
+            goto free_mem;
+        }
+    }
+    linked_binary_heap_node_t* top = NULL;
+    if (0 == min_max_heap_pop_min(&heap, &top) || 0 == min_max_heap_pop_max(&heap, &top))
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    min_max_heap_destroy(&heap);
+    free(items);
+}
+
+
+void
+test_min_max_heap_bounded_top_k(void)
+{
+    const size_t events_count = 200000;
+    const size_t k = 100;
+    uint64_t* keys = (uint64_t*)malloc(events_count * sizeof(uint64_t));
+    linked_binary_heap_node_t* nodes = (linked_binary_heap_node_t*)malloc((k + 1) * sizeof(linked_binary_heap_node_t));
+    min_max_heap_t heap;
+    min_max_heap_init_keyed(&heap);
+    if (keys == NULL || nodes == NULL || 0 != min_max_heap_set_bound(&heap, k))
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    // K + 1 nodes are enough for any stream, evicted node carries the next event
+    linked_binary_heap_node_t* spare = &nodes[k];
+    for (size_t i = 0; i < k; i++)
+    {
+        linked_binary_heap_node_init(&nodes[i], NULL);
+    }
+    linked_binary_heap_node_init(spare, NULL);
+    size_t next_node = 0;
+    for (size_t i = 0; i < events_count; i++)
+    {
+        keys[i] = ((uint64_t)rand() << 16) ^ (uint64_t)rand();
+        linked_binary_heap_node_t* node = next_node < k ? &nodes[next_node++] : spare;
+        linked_binary_heap_node_set_key_u64(node, keys[i]);
+        linked_binary_heap_node_t* evicted = min_max_heap_push_bounded(&heap, node);
+        if ((evicted == NULL) != (i < k) || (evicted != NULL && min_max_heap_contains_node(&heap, evicted)))
+        {
+            printf("%s test FAILED: wrong node evicted for event %zu\n", __func__, i);
+            goto free_mem;
+        }
+        if (evicted != NULL)
+        {
+            spare = evicted;
+        }
+    }
+    if (min_max_heap_size(&heap) != k || 0 != min_max_heap_verify(&heap)
+        || 0 == min_max_heap_push(&heap, spare))
+    {
+        printf("%s test FAILED: bounded heap is not valid\n", __func__);
+        goto free_mem;
+    }
+
+    qsort(keys, events_count, sizeof(uint64_t), uint64_comparer);
+    for (size_t i = 0; i < k; i++)
+    {
+        linked_binary_heap_node_t* top = NULL;
+        if (0 != min_max_heap_pop_min(&heap, &top) || top->key != keys[i])
+        {
+            printf("%s test FAILED: %zu smallest key is not kept\n", __func__, i);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    min_max_heap_destroy(&heap);
+    free(keys);
+    free(nodes);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_min_max_heap_pop_both_ends();
+    test_min_max_heap_bounded_top_k();
+}
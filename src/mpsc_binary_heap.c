@@ -0,0 +1,284 @@
+#include "mpsc_binary_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of inserts collected from the queue before they are pushed into the heap at once */
+#define MPSC_BINARY_HEAP_DRAIN_BATCH 256
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static mpsc_binary_heap_node_t*
+mpsc_binary_heap_node_from_heap_node(
+    linked_binary_heap_node_t* heap_node)
+{
+    // heap node is the first member of the wrapper
+    return (mpsc_binary_heap_node_t*)heap_node;
+}
+
+
+static void
+mpsc_binary_heap_enqueue(
+    mpsc_binary_heap_t* heap,
+    mpsc_binary_heap_node_t* node)
+{
+    // Vyukov's intrusive MPSC queue, producers are wait-free: the queue is
+    // briefly disconnected between exchange and store, consumer stops there
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    mpsc_binary_heap_node_t* const prev = atomic_exchange_explicit(&heap->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+
+static mpsc_binary_heap_node_t*
+mpsc_binary_heap_dequeue(
+    mpsc_binary_heap_t* heap)
+{
+    mpsc_binary_heap_node_t* tail = heap->tail;
+    mpsc_binary_heap_node_t* next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (tail == &heap->stub)
+    {
+        if (next == NULL)
+        {
+            return NULL;
+        }
+        heap->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next != NULL)
+    {
+        heap->tail = next;
+        return tail;
+    }
+    if (tail != atomic_load_explicit(&heap->head, memory_order_acquire))
+    {
+        // producer is in the middle of enqueue, its nodes are taken by the next drain
+        return NULL;
+    }
+    mpsc_binary_heap_enqueue(heap, &heap->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL)
+    {
+        heap->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+
+static void
+mpsc_binary_heap_flush(
+    mpsc_binary_heap_t* heap,
+    linked_binary_heap_node_t** batch,
+    size_t* count)
+{
+    linked_binary_heap_push_batch(&heap->heap, batch, *count);
+    *count = 0;
+}
+
+
+void
+mpsc_binary_heap_init(
+    mpsc_binary_heap_t* heap,
+    linked_binary_heap_node_data_comparer comparer,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    memset(heap, 0, sizeof(*heap));
+    linked_binary_heap_init(&heap->heap, comparer, data_visualizer);
+    mpsc_binary_heap_node_init(&heap->stub, NULL);
+    atomic_init(&heap->head, &heap->stub);
+    heap->tail = &heap->stub;
+}
+
+
+void
+mpsc_binary_heap_init_keyed(
+    mpsc_binary_heap_t* heap,
+    linked_binary_heap_key_type_t key_type,
+    linked_binary_heap_node_data_visualizer data_visualizer)
+{
+    mpsc_binary_heap_init(heap, NULL, data_visualizer);
+    linked_binary_heap_init_keyed(&heap->heap, key_type, data_visualizer);
+}
+
+
+void
+mpsc_binary_heap_node_init(
+    mpsc_binary_heap_node_t* node,
+    void* data)
+{
+    linked_binary_heap_node_init(&node->heap_node, data);
+    atomic_init(&node->next, NULL);
+    atomic_init(&node->state, MPSC_BINARY_HEAP_NODE_IDLE);
+}
+
+
+int
+mpsc_binary_heap_submit(
+    mpsc_binary_heap_t* heap,
+    mpsc_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    uint32_t expected = MPSC_BINARY_HEAP_NODE_IDLE;
+    if (!atomic_compare_exchange_strong_explicit(&node->state, &expected, MPSC_BINARY_HEAP_NODE_QUEUED_INSERT,
+            memory_order_acq_rel, memory_order_acquire))
+    {
+        return -1;
+    }
+    mpsc_binary_heap_enqueue(heap, node);
+    return 0;
+}
+
+
+int
+mpsc_binary_heap_cancel(
+    mpsc_binary_heap_t* heap,
+    mpsc_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    uint32_t state = atomic_load_explicit(&node->state, memory_order_acquire);
+    for (;;)
+    {
+        if (state == MPSC_BINARY_HEAP_NODE_QUEUED_INSERT)
+        {
+            // node is still queued, the owner drops it when it is dequeued
+            if (atomic_compare_exchange_weak_explicit(&node->state, &state, MPSC_BINARY_HEAP_NODE_QUEUED_INSERT_CANCELLED,
+                    memory_order_acq_rel, memory_order_acquire))
+            {
+                return 0;
+            }
+        }
+        else if (state == MPSC_BINARY_HEAP_NODE_IN_HEAP)
+        {
+            // node left the queue, so it can be queued again as removal request
+            if (atomic_compare_exchange_weak_explicit(&node->state, &state, MPSC_BINARY_HEAP_NODE_QUEUED_CANCEL,
+                    memory_order_acq_rel, memory_order_acquire))
+            {
+                mpsc_binary_heap_enqueue(heap, node);
+                return 0;
+            }
+        }
+        else
+        {
+            return -1;
+        }
+    }
+}
+
+
+size_t
+mpsc_binary_heap_drain(
+    mpsc_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    linked_binary_heap_node_t* batch[MPSC_BINARY_HEAP_DRAIN_BATCH];
+    size_t batch_count = 0;
+    size_t applied = 0;
+    mpsc_binary_heap_node_t* node;
+    while ((node = mpsc_binary_heap_dequeue(heap)) != NULL)
+    {
+        if (node == &heap->stub)
+        {
+            continue;
+        }
+        applied++;
+        uint32_t state = MPSC_BINARY_HEAP_NODE_QUEUED_INSERT;
+        if (atomic_compare_exchange_strong_explicit(&node->state, &state, MPSC_BINARY_HEAP_NODE_IN_HEAP,
+                memory_order_acq_rel, memory_order_acquire))
+        {
+            batch[batch_count++] = &node->heap_node;
+            if (batch_count == MPSC_BINARY_HEAP_DRAIN_BATCH)
+            {
+                mpsc_binary_heap_flush(heap, batch, &batch_count);
+            }
+        }
+        else if (state == MPSC_BINARY_HEAP_NODE_QUEUED_INSERT_CANCELLED)
+        {
+            atomic_store_explicit(&node->state, MPSC_BINARY_HEAP_NODE_IDLE, memory_order_release);
+        }
+        else
+        {
+            // removal request, the node may still be in the pending batch or already popped
+            ASSERT_WITH_MSG(state == MPSC_BINARY_HEAP_NODE_QUEUED_CANCEL, "Queued node must have queued state");
+            mpsc_binary_heap_flush(heap, batch, &batch_count);
+            if (linked_binary_heap_contains_node(&heap->heap, &node->heap_node))
+            {
+                linked_binary_heap_remove(&heap->heap, &node->heap_node);
+            }
+            atomic_store_explicit(&node->state, MPSC_BINARY_HEAP_NODE_IDLE, memory_order_release);
+        }
+    }
+    mpsc_binary_heap_flush(heap, batch, &batch_count);
+    return applied;
+}
+
+
+size_t
+mpsc_binary_heap_size(
+    mpsc_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    mpsc_binary_heap_drain(heap);
+    return linked_binary_heap_size(&heap->heap);
+}
+
+
+int
+mpsc_binary_heap_peek(
+    mpsc_binary_heap_t* heap,
+    mpsc_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    mpsc_binary_heap_drain(heap);
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_peek(&heap->heap, &top))
+    {
+        mpsc_binary_heap_node_t* const node = mpsc_binary_heap_node_from_heap_node(top);
+        if (atomic_load_explicit(&node->state, memory_order_acquire) == MPSC_BINARY_HEAP_NODE_IN_HEAP)
+        {
+            *out_node = node;
+            return 0;
+        }
+        // cancelled after drain, its queued request finds it removed
+        linked_binary_heap_remove(&heap->heap, top);
+    }
+    return -1;
+}
+
+
+int
+mpsc_binary_heap_pop(
+    mpsc_binary_heap_t* heap,
+    mpsc_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    mpsc_binary_heap_drain(heap);
+    linked_binary_heap_node_t* top;
+    while (0 == linked_binary_heap_pop(&heap->heap, &top))
+    {
+        mpsc_binary_heap_node_t* const node = mpsc_binary_heap_node_from_heap_node(top);
+        uint32_t state = MPSC_BINARY_HEAP_NODE_IN_HEAP;
+        if (atomic_compare_exchange_strong_explicit(&node->state, &state, MPSC_BINARY_HEAP_NODE_IDLE,
+                memory_order_acq_rel, memory_order_acquire))
+        {
+            *out_node = node;
+            return 0;
+        }
+        // cancel won the race, node stays queued until its request is drained
+    }
+    return -1;
+}
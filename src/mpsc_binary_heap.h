@@ -0,0 +1,110 @@
+#ifndef _MPSC_BINARY_HEAP_H_
+#define _MPSC_BINARY_HEAP_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/*
+ * Single-owner heap with lock-free multi-producer insertion buffer.
+ * Any thread may submit or cancel nodes, requests are queued in an intrusive
+ * MPSC queue without blocking. Only the owner thread calls drain, peek, pop and size,
+ * they apply queued requests to the heap first, inserts are applied in batches.
+ */
+
+typedef struct mpsc_binary_heap_node mpsc_binary_heap_node_t;
+
+typedef struct mpsc_binary_heap mpsc_binary_heap_t;
+
+/* states of the node, changed atomically by producers and the owner */
+typedef enum mpsc_binary_heap_node_state
+{
+    MPSC_BINARY_HEAP_NODE_IDLE = 0, /* node is neither queued nor in the heap */
+    MPSC_BINARY_HEAP_NODE_QUEUED_INSERT, /* node is queued to be inserted */
+    MPSC_BINARY_HEAP_NODE_QUEUED_INSERT_CANCELLED, /* node is queued to be inserted, but was cancelled since */
+    MPSC_BINARY_HEAP_NODE_IN_HEAP, /* node is in the heap */
+    MPSC_BINARY_HEAP_NODE_QUEUED_CANCEL, /* node is queued to be removed from the heap */
+} mpsc_binary_heap_node_state_t;
+
+/* structure representing heap node with link of insertion queue */
+struct mpsc_binary_heap_node
+{
+    linked_binary_heap_node_t heap_node; /* node of the owner's heap, key must be set before submit */
+    _Atomic(mpsc_binary_heap_node_t*) next; /* next node in the insertion queue */
+    _Atomic uint32_t state; /* one of mpsc_binary_heap_node_state_t */
+};
+
+/* structure representing heap, producer and owner sides are on separate cache lines */
+struct mpsc_binary_heap
+{
+    _Alignas(64) _Atomic(mpsc_binary_heap_node_t*) head; /* last queued node, producers append after it */
+    _Alignas(64) mpsc_binary_heap_node_t* tail; /* first queued node, owned by the owner */
+    mpsc_binary_heap_node_t stub; /* queue placeholder, so queue is never empty */
+    linked_binary_heap_t heap; /* heap of the owner */
+};
+
+
+void
+mpsc_binary_heap_init(
+    mpsc_binary_heap_t*,
+    linked_binary_heap_node_data_comparer,
+    linked_binary_heap_node_data_visualizer);
+
+
+/* initializes heap ordered by keys cached in nodes instead of comparer */
+void
+mpsc_binary_heap_init_keyed(
+    mpsc_binary_heap_t*,
+    linked_binary_heap_key_type_t,
+    linked_binary_heap_node_data_visualizer);
+
+
+void
+mpsc_binary_heap_node_init(
+    mpsc_binary_heap_node_t*,
+    void*);
+
+
+/* queues insert of idle node, thread safe and never blocks, returns -1 if node is not idle */
+int
+mpsc_binary_heap_submit(
+    mpsc_binary_heap_t*,
+    mpsc_binary_heap_node_t*);
+
+
+/* queues removal of submitted node, thread safe and never blocks, node will not be popped after success,
+ * returns -1 if node is idle or cancelled already */
+int
+mpsc_binary_heap_cancel(
+    mpsc_binary_heap_t*,
+    mpsc_binary_heap_node_t*);
+
+
+/* applies queued requests to the heap, owner only, returns number of applied requests */
+size_t
+mpsc_binary_heap_drain(
+    mpsc_binary_heap_t*);
+
+
+/* number of nodes in the heap after drain, owner only */
+size_t
+mpsc_binary_heap_size(
+    mpsc_binary_heap_t*);
+
+
+/* owner only */
+int
+mpsc_binary_heap_peek(
+    mpsc_binary_heap_t*,
+    mpsc_binary_heap_node_t**);
+
+
+/* owner only, popped node becomes idle and may be submitted again */
+int
+mpsc_binary_heap_pop(
+    mpsc_binary_heap_t*,
+    mpsc_binary_heap_node_t**);
+
+#endif
@@ -0,0 +1,250 @@
+#include "mpsc_binary_heap.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+/*
+ * Benchmark of many producers submitting nodes to a heap owned by one thread.
+ * Lock-free insertion buffer of mpsc_binary_heap_t is compared against
+ * linked_binary_heap_t protected by a mutex taken by producers and the owner.
+ *
+ * Every measurement is printed as a single CSV line:
+ *   queue,producers,ops,ops_per_sec
+ *
+ * Usage: mpsc_binary_heap_bench [--ops N] [--max-producers N] [--seed N]
+ */
+
+#define BENCH_MAX_PRODUCERS 64
+
+typedef struct bench_item
+{
+    mpsc_binary_heap_node_t node;
+} bench_item_t;
+
+
+typedef struct bench_queue
+{
+    int locked; /* mutex protected heap or MPSC insertion buffer */
+    pthread_mutex_t lock;
+    linked_binary_heap_t heap;
+    mpsc_binary_heap_t mpsc;
+} bench_queue_t;
+
+
+typedef struct bench_producer
+{
+    bench_queue_t* queue;
+    bench_item_t* items;
+    size_t items_count;
+} bench_producer_t;
+
+
+static uint64_t
+bench_rand(uint64_t* state)
+{
+    // xorshift64*, reproducible across platforms unlike rand()
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+
+static uint64_t
+bench_now_ns(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+static void*
+bench_producer_run(void* arg)
+{
+    bench_producer_t* producer = (bench_producer_t*)arg;
+    bench_queue_t* queue = producer->queue;
+    for (size_t i = 0; i < producer->items_count; i++)
+    {
+        if (queue->locked)
+        {
+            pthread_mutex_lock(&queue->lock);
+            linked_binary_heap_push(&queue->heap, &producer->items[i].node.heap_node);
+            pthread_mutex_unlock(&queue->lock);
+        }
+        else
+        {
+            mpsc_binary_heap_submit(&queue->mpsc, &producer->items[i].node);
+        }
+    }
+    return NULL;
+}
+
+
+static int
+bench_queue_pop(bench_queue_t* queue)
+{
+    if (queue->locked)
+    {
+        linked_binary_heap_node_t* top;
+        pthread_mutex_lock(&queue->lock);
+        const int err = linked_binary_heap_pop(&queue->heap, &top);
+        pthread_mutex_unlock(&queue->lock);
+        return err;
+    }
+    mpsc_binary_heap_node_t* top;
+    return mpsc_binary_heap_pop(&queue->mpsc, &top);
+}
+
+
+static int
+bench_run(
+    int locked,
+    size_t producers_count,
+    bench_item_t* items,
+    size_t ops,
+    uint64_t seed,
+    double* out_ops_per_sec)
+{
+    bench_queue_t queue;
+    memset(&queue, 0, sizeof(queue));
+    queue.locked = locked;
+    pthread_mutex_init(&queue.lock, NULL);
+    linked_binary_heap_init_keyed(&queue.heap, LINKED_BINARY_HEAP_KEY_U64, NULL);
+    mpsc_binary_heap_init_keyed(&queue.mpsc, LINKED_BINARY_HEAP_KEY_U64, NULL);
+
+    uint64_t rng_state = 0x9E3779B97F4A7C15ull ^ seed;
+    for (size_t i = 0; i < ops; i++)
+    {
+        mpsc_binary_heap_node_init(&items[i].node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].node.heap_node, bench_rand(&rng_state));
+    }
+
+    pthread_t threads[BENCH_MAX_PRODUCERS];
+    bench_producer_t producers[BENCH_MAX_PRODUCERS];
+    const size_t items_per_producer = ops / producers_count;
+    size_t started = 0;
+    const uint64_t start = bench_now_ns();
+    for (; started < producers_count; started++)
+    {
+        producers[started].queue = &queue;
+        producers[started].items = &items[started * items_per_producer];
+        producers[started].items_count = items_per_producer;
+        if (0 != pthread_create(&threads[started], NULL, bench_producer_run, &producers[started]))
+        {
+            break;
+        }
+    }
+
+    // this thread is the owner, it pops everything producers submit
+    const size_t expected = started * items_per_producer;
+    size_t popped = 0;
+    while (popped < expected)
+    {
+        if (0 == bench_queue_pop(&queue))
+        {
+            popped++;
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+    const uint64_t elapsed = bench_now_ns() - start;
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&queue.lock);
+    *out_ops_per_sec = elapsed > 0 ? (double)expected * 1e9 / (double)elapsed : 0;
+    return started == producers_count ? 0 : -1;
+}
+
+
+static int
+bench_parse_size(const char* text, size_t* out_value)
+{
+    char* end = NULL;
+    const unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || *end != '\0')
+    {
+        return -1;
+    }
+    *out_value = (size_t)value;
+    return 0;
+}
+
+
+int
+main(int argc, char** argv)
+{
+    size_t ops = 1000000;
+    size_t max_producers = BENCH_MAX_PRODUCERS;
+    size_t seed = 42;
+
+    for (int i = 1; i < argc; i++)
+    {
+        size_t* target = NULL;
+        if (strcmp(argv[i], "--ops") == 0)
+        {
+            target = &ops;
+        }
+        else if (strcmp(argv[i], "--max-producers") == 0)
+        {
+            target = &max_producers;
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            target = &seed;
+        }
+        if (target == NULL || i + 1 >= argc || 0 != bench_parse_size(argv[i + 1], target))
+        {
+            fprintf(stderr, "usage: %s [--ops N] [--max-producers N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (ops == 0 || max_producers == 0 || max_producers > BENCH_MAX_PRODUCERS)
+    {
+        fprintf(stderr, "ops and max producers (up to %d) must be positive\n", BENCH_MAX_PRODUCERS);
+        return 1;
+    }
+
+    bench_item_t* items = (bench_item_t*)malloc(ops * sizeof(bench_item_t));
+    if (items == NULL)
+    {
+        fprintf(stderr, "failed to allocate memory for %zu items\n", ops);
+        return 1;
+    }
+
+    printf("queue,producers,ops,ops_per_sec\n");
+    for (size_t producers = 1; producers <= max_producers; producers *= 2)
+    {
+        for (int locked = 1; locked >= 0; locked--)
+        {
+            double ops_per_sec = 0;
+            if (0 != bench_run(locked, producers, items, ops, (uint64_t)seed, &ops_per_sec))
+            {
+                fprintf(stderr, "failed to run benchmark with %zu producers\n", producers);
+                free(items);
+                return 1;
+            }
+            printf("%s,%zu,%zu,%.0f\n", locked ? "mutex" : "mpsc", producers, ops / producers * producers, ops_per_sec);
+            fflush(stdout);
+        }
+    }
+
+    free(items);
+    return 0;
+}
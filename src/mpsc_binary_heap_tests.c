@@ -0,0 +1,204 @@
+#include "mpsc_binary_heap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define PRODUCERS_COUNT 4
+
+typedef struct item
+{
+    mpsc_binary_heap_node_t node;
+    uint32_t popped;
+    int cancelled;
+} item_t;
+
+typedef struct producer
+{
+    mpsc_binary_heap_t* heap;
+    item_t* items;
+    size_t items_count;
+} producer_t;
+
+
+void*
+producer_run(void* arg)
+{
+    producer_t* producer = (producer_t*)arg;
+    for (size_t i = 0; i < producer->items_count; i++)
+    {
+        mpsc_binary_heap_submit(producer->heap, &producer->items[i].node);
+        if (i >= 16 && i % 3 == 0)
+        {
+            // cancel fails only when owner already popped the node
+            item_t* item = &producer->items[i - 16];
+            item->cancelled = (0 == mpsc_binary_heap_cancel(producer->heap, &item->node));
+        }
+    }
+    return NULL;
+}
+
+
+void
+test_mpsc_binary_heap_submit_cancel_pop(void)
+{
+    const size_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    mpsc_binary_heap_t heap;
+    mpsc_binary_heap_init_keyed(&heap, LINKED_BINARY_HEAP_KEY_U64, NULL);
+    for (size_t i = 0; i < items_count; i++)
+    {
+        mpsc_binary_heap_node_init(&items[i].node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].node.heap_node, (uint64_t)(rand() % 1024));
+        items[i].popped = 0;
+        items[i].cancelled = 0;
+        if (0 != mpsc_binary_heap_submit(&heap, &items[i].node))
+        {
+            printf("%s test FAILED: failed to submit idle node\n", __func__);
+            goto free_mem;
+        }
+        if (i % 1000 == 999)
+        {
+            mpsc_binary_heap_drain(&heap);
+        }
+    }
+    if (0 == mpsc_binary_heap_submit(&heap, &items[0].node))
+    {
+        printf("%s test FAILED: node was submitted twice\n", __func__);
+        goto free_mem;
+    }
+
+    // cancel both nodes which are already in the heap and still queued ones
+    for (size_t i = 0; i < items_count; i += 5)
+    {
+        items[i].cancelled = 1;
+        if (0 != mpsc_binary_heap_cancel(&heap, &items[i].node) || 0 == mpsc_binary_heap_cancel(&heap, &items[i].node))
+        {
+            printf("%s test FAILED: cancel of submitted node is not accepted exactly once\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    uint64_t root_key = 0;
+    mpsc_binary_heap_node_t* top;
+    while (0 == mpsc_binary_heap_pop(&heap, &top))
+    {
+        item_t* item = (item_t*)top->heap_node.data;
+        if (root_key > top->heap_node.key || item->cancelled)
+        {
+            printf("%s test FAILED: cancelled or out of order node popped\n", __func__);
+            goto free_mem;
+        }
+        root_key = top->heap_node.key;
+        item->popped++;
+    }
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (items[i].popped != (items[i].cancelled ? 0u : 1u)
+            || atomic_load(&items[i].node.state) != MPSC_BINARY_HEAP_NODE_IDLE)
+        {
+            printf("%s test FAILED: node %zu is popped %"PRIu32" times\n", __func__, i, items[i].popped);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_mpsc_binary_heap_concurrent_producers(void)
+{
+    const size_t items_per_producer = 64 * 1024;
+    const size_t items_count = PRODUCERS_COUNT * items_per_producer;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    mpsc_binary_heap_t heap;
+    mpsc_binary_heap_init_keyed(&heap, LINKED_BINARY_HEAP_KEY_U64, NULL);
+    for (size_t i = 0; i < items_count; i++)
+    {
+        mpsc_binary_heap_node_init(&items[i].node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].node.heap_node, (uint64_t)rand());
+        items[i].popped = 0;
+        items[i].cancelled = 0;
+    }
+
+    pthread_t threads[PRODUCERS_COUNT];
+    producer_t producers[PRODUCERS_COUNT];
+    size_t started = 0;
+    for (; started < PRODUCERS_COUNT; started++)
+    {
+        producers[started].heap = &heap;
+        producers[started].items = &items[started * items_per_producer];
+        producers[started].items_count = items_per_producer;
+        if (0 != pthread_create(&threads[started], NULL, producer_run, &producers[started]))
+        {
+            break;
+        }
+    }
+
+    // this thread is the owner, it pops concurrently with producers
+    mpsc_binary_heap_node_t* top;
+    for (size_t i = 0; i < items_count / 2; i++)
+    {
+        if (0 == mpsc_binary_heap_pop(&heap, &top))
+        {
+            ((item_t*)top->heap_node.data)->popped++;
+        }
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    while (0 == mpsc_binary_heap_pop(&heap, &top))
+    {
+        ((item_t*)top->heap_node.data)->popped++;
+    }
+
+    if (started != PRODUCERS_COUNT)
+    {
+        printf("%s test FAILED: failed to start producer threads\n", __func__);
+        goto free_mem;
+    }
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (items[i].popped != (items[i].cancelled ? 0u : 1u)
+            || atomic_load(&items[i].node.state) != MPSC_BINARY_HEAP_NODE_IDLE)
+        {
+            printf("%s test FAILED: node %zu is popped %"PRIu32" times\n", __func__, i, items[i].popped);
+            goto free_mem;
+        }
+    }
+    if (0 != linked_binary_heap_verify(&heap.heap) || mpsc_binary_heap_size(&heap) != 0)
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_mpsc_binary_heap_submit_cancel_pop();
+    test_mpsc_binary_heap_concurrent_producers();
+}
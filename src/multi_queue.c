@@ -0,0 +1,207 @@
+#include "multi_queue.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+// per thread state of xorshift64* generator, seeded lazily
+static _Thread_local uint64_t multi_queue_random_state = 0;
+
+static _Atomic uint64_t multi_queue_random_seed = 0x9E3779B97F4A7C15ull;
+
+
+static size_t
+multi_queue_random_shard(
+    const multi_queue_t* queue)
+{
+    uint64_t x = multi_queue_random_state;
+    if (x == 0)
+    {
+        x = atomic_fetch_add_explicit(&multi_queue_random_seed, 0x9E3779B97F4A7C15ull, memory_order_relaxed)
+            ^ (uint64_t)(uintptr_t)&multi_queue_random_state;
+        x = x == 0 ? 1 : x;
+    }
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    multi_queue_random_state = x;
+    return (size_t)((x * 0x2545F4914F6CDD1Dull) >> 32) % queue->shards_count;
+}
+
+
+static void
+multi_queue_shard_publish_top(
+    multi_queue_shard_t* shard)
+{
+    // called with shard lock held, readers use the key as a hint only
+    linked_binary_heap_node_t* top;
+    const uint64_t key = 0 == linked_binary_heap_peek(&shard->heap, &top) ? top->key : MULTI_QUEUE_EMPTY_KEY;
+    atomic_store_explicit(&shard->top_key, key, memory_order_relaxed);
+}
+
+
+static int
+multi_queue_shard_pop(
+    multi_queue_shard_t* shard,
+    linked_binary_heap_node_t** out_node)
+{
+    // called with shard lock held
+    if (0 != linked_binary_heap_pop(&shard->heap, out_node))
+    {
+        return -1;
+    }
+    multi_queue_shard_publish_top(shard);
+    return 0;
+}
+
+
+int
+multi_queue_init(
+    multi_queue_t* queue,
+    size_t shards_count,
+    linked_binary_heap_key_type_t key_type)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(key_type != LINKED_BINARY_HEAP_KEY_NONE, "Shards must be keyed heaps");
+    memset(queue, 0, sizeof(*queue));
+    if (shards_count == 0)
+    {
+        return -1;
+    }
+    multi_queue_shard_t* shards =
+        (multi_queue_shard_t*)aligned_alloc(_Alignof(multi_queue_shard_t), shards_count * sizeof(multi_queue_shard_t));
+    if (shards == NULL)
+    {
+        return -1;
+    }
+    for (size_t i = 0; i < shards_count; i++)
+    {
+        if (0 != pthread_mutex_init(&shards[i].lock, NULL))
+        {
+            while (i-- > 0)
+            {
+                pthread_mutex_destroy(&shards[i].lock);
+            }
+            free(shards);
+            return -1;
+        }
+        linked_binary_heap_init_keyed(&shards[i].heap, key_type, NULL);
+        atomic_init(&shards[i].top_key, MULTI_QUEUE_EMPTY_KEY);
+    }
+    queue->shards = shards;
+    queue->shards_count = shards_count;
+    return 0;
+}
+
+
+void
+multi_queue_destroy(
+    multi_queue_t* queue)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    for (size_t i = 0; i < queue->shards_count; i++)
+    {
+        pthread_mutex_destroy(&queue->shards[i].lock);
+    }
+    free(queue->shards);
+    queue->shards = NULL;
+    queue->shards_count = 0;
+}
+
+
+void
+multi_queue_push(
+    multi_queue_t* queue,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    for (;;)
+    {
+        // busy shard is skipped in favor of another random one
+        multi_queue_shard_t* const shard = &queue->shards[multi_queue_random_shard(queue)];
+        if (0 != pthread_mutex_trylock(&shard->lock))
+        {
+            continue;
+        }
+        linked_binary_heap_push(&shard->heap, node);
+        multi_queue_shard_publish_top(shard);
+        pthread_mutex_unlock(&shard->lock);
+        return;
+    }
+}
+
+
+int
+multi_queue_pop(
+    multi_queue_t* queue,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    size_t empty_probes = 0;
+    while (empty_probes < queue->shards_count)
+    {
+        // pick the better of two random shards by cached root keys without locking them
+        multi_queue_shard_t* first = &queue->shards[multi_queue_random_shard(queue)];
+        multi_queue_shard_t* second = &queue->shards[multi_queue_random_shard(queue)];
+        const uint64_t first_key = atomic_load_explicit(&first->top_key, memory_order_relaxed);
+        const uint64_t second_key = atomic_load_explicit(&second->top_key, memory_order_relaxed);
+        multi_queue_shard_t* const shard = second_key < first_key ? second : first;
+        if (first_key == MULTI_QUEUE_EMPTY_KEY && second_key == MULTI_QUEUE_EMPTY_KEY)
+        {
+            empty_probes++;
+            continue;
+        }
+        if (0 != pthread_mutex_trylock(&shard->lock))
+        {
+            continue;
+        }
+        const int err = multi_queue_shard_pop(shard, out_node);
+        pthread_mutex_unlock(&shard->lock);
+        if (err == 0)
+        {
+            return 0;
+        }
+    }
+
+    // queue looks empty, check every shard before reporting it
+    for (size_t i = 0; i < queue->shards_count; i++)
+    {
+        multi_queue_shard_t* const shard = &queue->shards[i];
+        pthread_mutex_lock(&shard->lock);
+        const int err = multi_queue_shard_pop(shard, out_node);
+        pthread_mutex_unlock(&shard->lock);
+        if (err == 0)
+        {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+
+size_t
+multi_queue_size(
+    multi_queue_t* queue)
+{
+    ASSERT_WITH_MSG(queue != NULL, "Queue pointer must not be null");
+    size_t size = 0;
+    for (size_t i = 0; i < queue->shards_count; i++)
+    {
+        pthread_mutex_lock(&queue->shards[i].lock);
+        size += linked_binary_heap_size(&queue->shards[i].heap);
+        pthread_mutex_unlock(&queue->shards[i].lock);
+    }
+    return size;
+}
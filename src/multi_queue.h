@@ -0,0 +1,74 @@
+#ifndef _MULTI_QUEUE_H_
+#define _MULTI_QUEUE_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/*
+ * Relaxed concurrent priority queue made of independently locked keyed heaps (MultiQueue).
+ * Push inserts node into a random shard, pop try-locks the better of two random shards
+ * chosen by cached root keys, so popped node is close to, but not always, the smallest one.
+ * Recommended number of shards is a small multiple (2-4) of the number of threads.
+ */
+
+/* cached root key of empty shard, shard with root key equal to it is still found by pop */
+#define MULTI_QUEUE_EMPTY_KEY UINT64_MAX
+
+typedef struct multi_queue_shard multi_queue_shard_t;
+
+typedef struct multi_queue multi_queue_t;
+
+/* structure representing a shard, aligned to cache line to avoid false sharing of locks */
+struct multi_queue_shard
+{
+    _Alignas(64) pthread_mutex_t lock; /* lock protecting the heap */
+    linked_binary_heap_t heap; /* keyed heap of the shard */
+    _Atomic uint64_t top_key; /* key of the root node, MULTI_QUEUE_EMPTY_KEY when shard is empty */
+};
+
+/* structure representing queue */
+struct multi_queue
+{
+    multi_queue_shard_t* shards; /* array of shards */
+    size_t shards_count; /* number of shards */
+};
+
+
+/* initializes queue of given number of keyed heap shards, returns -1 on failure */
+int
+multi_queue_init(
+    multi_queue_t*,
+    size_t,
+    linked_binary_heap_key_type_t);
+
+
+/* releases shards, queue must not be used concurrently */
+void
+multi_queue_destroy(
+    multi_queue_t*);
+
+
+/* pushes node with key set by linked_binary_heap_node_set_key_* into a random shard */
+void
+multi_queue_push(
+    multi_queue_t*,
+    linked_binary_heap_node_t*);
+
+
+/* pops node with one of the smallest keys, returns -1 if all shards are empty */
+int
+multi_queue_pop(
+    multi_queue_t*,
+    linked_binary_heap_node_t**);
+
+
+/* number of nodes in all shards, only approximate while queue is modified concurrently */
+size_t
+multi_queue_size(
+    multi_queue_t*);
+
+#endif
@@ -0,0 +1,385 @@
+#include "multi_queue.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/*
+ * Multi-threaded benchmark of MultiQueue against a strict heap protected by one mutex.
+ *
+ * Every thread repeatedly pops a node and pushes it back with a new random key.
+ * Every measurement is printed as a single CSV line:
+ *   queue,threads,shards,size,ops,ops_per_sec,mean_rank_error,max_rank_error
+ *
+ * Rank error of a pop is the number of nodes with smaller keys present in the queue at that moment.
+ * It is computed by replaying operations in the order of tickets taken next to every operation
+ * in a separate run, so it is an estimate for MultiQueue and exact for the strict heap.
+ *
+ * Usage: multi_queue_bench [--size N] [--ops N] [--max-threads N] [--shards-per-thread N] [--seed N]
+ */
+
+/* keys are drawn from [0, BENCH_KEY_RANGE) so rank can be counted by Fenwick tree */
+#define BENCH_KEY_RANGE (1u << 20)
+
+#define BENCH_OP_PUSH 0
+#define BENCH_OP_POP 1
+
+typedef struct bench_item
+{
+    linked_binary_heap_node_t heap_node;
+} bench_item_t;
+
+
+typedef struct bench_log_entry
+{
+    uint32_t key;
+    uint32_t op;
+} bench_log_entry_t;
+
+
+typedef struct bench_queue
+{
+    int strict; /* strict heap under one mutex or MultiQueue */
+    pthread_mutex_t lock;
+    linked_binary_heap_t heap;
+    multi_queue_t multi_queue;
+    bench_log_entry_t* log; /* operations indexed by ticket, null when rank is not measured */
+    _Atomic uint64_t tickets;
+} bench_queue_t;
+
+
+typedef struct bench_worker
+{
+    bench_queue_t* queue;
+    size_t ops;
+    uint64_t rng_state;
+} bench_worker_t;
+
+
+static uint64_t
+bench_rand(uint64_t* state)
+{
+    // xorshift64*, reproducible across platforms unlike rand()
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+
+static uint64_t
+bench_now_ns(void)
+{
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+    timespec_get(&ts, TIME_UTC);
+#endif
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+
+static void
+bench_log(bench_queue_t* queue, uint32_t op, uint64_t key)
+{
+    if (queue->log != NULL)
+    {
+        const uint64_t ticket = atomic_fetch_add_explicit(&queue->tickets, 1, memory_order_relaxed);
+        queue->log[ticket].key = (uint32_t)key;
+        queue->log[ticket].op = op;
+    }
+}
+
+
+static void
+bench_queue_push(bench_queue_t* queue, linked_binary_heap_node_t* node)
+{
+    if (queue->strict)
+    {
+        pthread_mutex_lock(&queue->lock);
+        bench_log(queue, BENCH_OP_PUSH, node->key);
+        linked_binary_heap_push(&queue->heap, node);
+        pthread_mutex_unlock(&queue->lock);
+    }
+    else
+    {
+        // ticket is taken before the node becomes visible, so the push is replayed before its pop
+        bench_log(queue, BENCH_OP_PUSH, node->key);
+        multi_queue_push(&queue->multi_queue, node);
+    }
+}
+
+
+static int
+bench_queue_pop(bench_queue_t* queue, linked_binary_heap_node_t** out_node)
+{
+    int err;
+    if (queue->strict)
+    {
+        pthread_mutex_lock(&queue->lock);
+        err = linked_binary_heap_pop(&queue->heap, out_node);
+        if (err == 0)
+        {
+            bench_log(queue, BENCH_OP_POP, (*out_node)->key);
+        }
+        pthread_mutex_unlock(&queue->lock);
+    }
+    else
+    {
+        err = multi_queue_pop(&queue->multi_queue, out_node);
+        if (err == 0)
+        {
+            bench_log(queue, BENCH_OP_POP, (*out_node)->key);
+        }
+    }
+    return err;
+}
+
+
+static void*
+bench_worker_run(void* arg)
+{
+    bench_worker_t* worker = (bench_worker_t*)arg;
+    linked_binary_heap_node_t* node;
+    for (size_t i = 0; i < worker->ops; i++)
+    {
+        if (0 != bench_queue_pop(worker->queue, &node))
+        {
+            continue;
+        }
+        linked_binary_heap_node_set_key_u64(node, bench_rand(&worker->rng_state) % BENCH_KEY_RANGE);
+        bench_queue_push(worker->queue, node);
+    }
+    return NULL;
+}
+
+
+static void
+bench_rank_error(const bench_log_entry_t* log, uint64_t count, double* out_mean, uint64_t* out_max)
+{
+    // replay operations over Fenwick tree of key counts
+    uint32_t* tree = (uint32_t*)calloc(BENCH_KEY_RANGE + 1, sizeof(uint32_t));
+    uint64_t pops = 0;
+    uint64_t total = 0;
+    uint64_t max = 0;
+    if (tree == NULL)
+    {
+        *out_mean = -1;
+        *out_max = 0;
+        return;
+    }
+    for (uint64_t i = 0; i < count; i++)
+    {
+        const uint32_t key = log[i].key;
+        if (log[i].op == BENCH_OP_POP)
+        {
+            uint64_t rank = 0;
+            for (uint32_t k = key; k > 0; k -= k & (0u - k))
+            {
+                rank += tree[k];
+            }
+            total += rank;
+            max = rank > max ? rank : max;
+            pops++;
+        }
+        const uint32_t delta = log[i].op == BENCH_OP_POP ? UINT32_MAX : 1;
+        for (uint32_t k = key + 1; k <= BENCH_KEY_RANGE; k += k & (0u - k))
+        {
+            tree[k] += delta;
+        }
+    }
+    free(tree);
+    *out_mean = pops > 0 ? (double)total / (double)pops : 0;
+    *out_max = max;
+}
+
+
+static int
+bench_run(
+    int strict,
+    size_t threads_count,
+    size_t shards_count,
+    bench_item_t* items,
+    size_t size,
+    size_t ops_per_thread,
+    uint64_t seed,
+    int measure_rank,
+    double* out_ops_per_sec,
+    double* out_mean_rank,
+    uint64_t* out_max_rank)
+{
+    bench_queue_t queue;
+    memset(&queue, 0, sizeof(queue));
+    queue.strict = strict;
+    if (strict)
+    {
+        pthread_mutex_init(&queue.lock, NULL);
+        linked_binary_heap_init_keyed(&queue.heap, LINKED_BINARY_HEAP_KEY_U64, NULL);
+    }
+    else if (0 != multi_queue_init(&queue.multi_queue, shards_count, LINKED_BINARY_HEAP_KEY_U64))
+    {
+        return -1;
+    }
+    const uint64_t log_size = size + 2 * (uint64_t)threads_count * ops_per_thread;
+    if (measure_rank)
+    {
+        queue.log = (bench_log_entry_t*)malloc(log_size * sizeof(bench_log_entry_t));
+        if (queue.log == NULL)
+        {
+            return -1;
+        }
+    }
+
+    uint64_t rng_state = 0x9E3779B97F4A7C15ull ^ seed;
+    for (size_t i = 0; i < size; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].heap_node, bench_rand(&rng_state) % BENCH_KEY_RANGE);
+        bench_queue_push(&queue, &items[i].heap_node);
+    }
+
+    pthread_t threads[256];
+    bench_worker_t workers[256];
+    size_t started = 0;
+    const uint64_t start = bench_now_ns();
+    for (; started < threads_count; started++)
+    {
+        workers[started].queue = &queue;
+        workers[started].ops = ops_per_thread;
+        workers[started].rng_state = rng_state ^ (0xBF58476D1CE4E5B9ull * (started + 1));
+        if (0 != pthread_create(&threads[started], NULL, bench_worker_run, &workers[started]))
+        {
+            break;
+        }
+    }
+    for (size_t t = 0; t < started; t++)
+    {
+        pthread_join(threads[t], NULL);
+    }
+    const uint64_t elapsed = bench_now_ns() - start;
+    *out_ops_per_sec = elapsed > 0 ? (double)(started * ops_per_thread) * 1e9 / (double)elapsed : 0;
+
+    *out_mean_rank = 0;
+    *out_max_rank = 0;
+    if (measure_rank)
+    {
+        bench_rank_error(queue.log, atomic_load(&queue.tickets), out_mean_rank, out_max_rank);
+        free(queue.log);
+    }
+
+    if (strict)
+    {
+        pthread_mutex_destroy(&queue.lock);
+    }
+    else
+    {
+        multi_queue_destroy(&queue.multi_queue);
+    }
+    return started == threads_count ? 0 : -1;
+}
+
+
+static int
+bench_parse_size(const char* text, size_t* out_value)
+{
+    char* end = NULL;
+    const unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || *end != '\0')
+    {
+        return -1;
+    }
+    *out_value = (size_t)value;
+    return 0;
+}
+
+
+int
+main(int argc, char** argv)
+{
+    size_t size = 1000000;
+    size_t ops = 1000000;
+    size_t max_threads = 8;
+    size_t shards_per_thread = 2;
+    size_t seed = 42;
+
+    for (int i = 1; i < argc; i++)
+    {
+        size_t* target = NULL;
+        if (strcmp(argv[i], "--size") == 0)
+        {
+            target = &size;
+        }
+        else if (strcmp(argv[i], "--ops") == 0)
+        {
+            target = &ops;
+        }
+        else if (strcmp(argv[i], "--max-threads") == 0)
+        {
+            target = &max_threads;
+        }
+        else if (strcmp(argv[i], "--shards-per-thread") == 0)
+        {
+            target = &shards_per_thread;
+        }
+        else if (strcmp(argv[i], "--seed") == 0)
+        {
+            target = &seed;
+        }
+        if (target == NULL || i + 1 >= argc || 0 != bench_parse_size(argv[i + 1], target))
+        {
+            fprintf(stderr, "usage: %s [--size N] [--ops N] [--max-threads N] [--shards-per-thread N] [--seed N]\n", argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (size == 0 || max_threads == 0 || max_threads > 256 || shards_per_thread == 0)
+    {
+        fprintf(stderr, "size, max threads (up to 256) and shards per thread must be positive\n");
+        return 1;
+    }
+
+    bench_item_t* items = (bench_item_t*)malloc(size * sizeof(bench_item_t));
+    if (items == NULL)
+    {
+        fprintf(stderr, "failed to allocate memory for %zu items\n", size);
+        return 1;
+    }
+
+    printf("queue,threads,shards,size,ops,ops_per_sec,mean_rank_error,max_rank_error\n");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        for (int strict = 1; strict >= 0; strict--)
+        {
+            // ops are split between threads, so every row does the same amount of work
+            const size_t ops_per_thread = ops / threads;
+            const size_t shards = strict ? 1 : threads * shards_per_thread;
+            double ops_per_sec = 0;
+            double mean_rank = 0;
+            uint64_t max_rank = 0;
+            double unused_mean = 0;
+            uint64_t unused_max = 0;
+            if (0 != bench_run(strict, threads, shards, items, size, ops_per_thread, (uint64_t)seed, 0,
+                    &ops_per_sec, &unused_mean, &unused_max)
+                || 0 != bench_run(strict, threads, shards, items, size, ops_per_thread, (uint64_t)seed, 1,
+                    &unused_mean, &mean_rank, &max_rank))
+            {
+                fprintf(stderr, "failed to run benchmark with %zu threads\n", threads);
+                free(items);
+                return 1;
+            }
+            printf("%s,%zu,%zu,%zu,%zu,%.0f,%.2f,%"PRIu64"\n",
+                strict ? "strict" : "multi_queue", threads, shards, size, ops_per_thread * threads,
+                ops_per_sec, mean_rank, max_rank);
+            fflush(stdout);
+        }
+    }
+
+    free(items);
+    return 0;
+}
@@ -0,0 +1,211 @@
+#include "multi_queue.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define THREADS_COUNT 4
+
+typedef struct item
+{
+    linked_binary_heap_node_t heap_node;
+    uint32_t popped;
+} item_t;
+
+typedef struct worker
+{
+    multi_queue_t* queue;
+    item_t* items;
+    size_t items_count;
+    size_t popped_count;
+} worker_t;
+
+
+void*
+push_worker(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    for (size_t i = 0; i < worker->items_count; i++)
+    {
+        multi_queue_push(worker->queue, &worker->items[i].heap_node);
+    }
+    return NULL;
+}
+
+
+void*
+pop_worker(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    linked_binary_heap_node_t* node;
+    while (0 == multi_queue_pop(worker->queue, &node))
+    {
+        // every item is popped by exactly one thread, so plain increment is enough
+        ((item_t*)node->data)->popped += 1;
+        worker->popped_count += 1;
+    }
+    return NULL;
+}
+
+
+void*
+push_pop_worker(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    linked_binary_heap_node_t* node;
+    for (size_t i = 0; i < worker->items_count; i++)
+    {
+        multi_queue_push(worker->queue, &worker->items[i].heap_node);
+        if (i % 2 == 1 && 0 == multi_queue_pop(worker->queue, &node))
+        {
+            ((item_t*)node->data)->popped += 1;
+            worker->popped_count += 1;
+        }
+    }
+    return NULL;
+}
+
+
+int
+run_workers(void* (*routine)(void*), worker_t* workers)
+{
+    pthread_t threads[THREADS_COUNT];
+    size_t started = 0;
+    int err = 0;
+    for (; started < THREADS_COUNT; started++)
+    {
+        if (0 != pthread_create(&threads[started], NULL, routine, &workers[started]))
+        {
+            err = -1;
+            break;
+        }
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    return err;
+}
+
+
+void
+test_multi_queue_single_shard_pops_in_order(void)
+{
+    const size_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    multi_queue_t queue;
+    if (items == NULL || 0 != multi_queue_init(&queue, 1, LINKED_BINARY_HEAP_KEY_U64))
+    {
+        printf("%s test FAILED: failed to allocate memory for queue\n", __func__);
+        free(items);
+        return;
+    }
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].heap_node, (uint64_t)(rand() % 1024));
+        multi_queue_push(&queue, &items[i].heap_node);
+    }
+
+    uint64_t root_key = 0;
+    size_t popped = 0;
+    linked_binary_heap_node_t* node;
+    while (0 == multi_queue_pop(&queue, &node))
+    {
+        if (root_key > node->key)
+        {
+            printf("%s test FAILED: Key %"PRIu64" of popped item is less than previously popped %"PRIu64" \n",
+                __func__, node->key, root_key);
+            goto free_mem;
+        }
+        root_key = node->key;
+        popped++;
+    }
+    if (popped != items_count || multi_queue_size(&queue) != 0)
+    {
+        printf("%s test FAILED: %zu items popped instead of %zu\n", __func__, popped, items_count);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    multi_queue_destroy(&queue);
+    free(items);
+}
+
+
+void
+test_multi_queue_concurrent_items_popped_once(void)
+{
+    const size_t items_per_thread = 64 * 1024;
+    const size_t items_count = THREADS_COUNT * items_per_thread;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    worker_t workers[THREADS_COUNT];
+    multi_queue_t queue;
+    if (items == NULL || 0 != multi_queue_init(&queue, 2 * THREADS_COUNT, LINKED_BINARY_HEAP_KEY_U64))
+    {
+        printf("%s test FAILED: failed to allocate memory for queue\n", __func__);
+        free(items);
+        return;
+    }
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].heap_node, (uint64_t)rand());
+        items[i].popped = 0;
+    }
+    for (size_t t = 0; t < THREADS_COUNT; t++)
+    {
+        workers[t].queue = &queue;
+        workers[t].items = &items[t * items_per_thread];
+        workers[t].items_count = items_per_thread;
+        workers[t].popped_count = 0;
+    }
+
+    if (0 != run_workers(push_worker, workers) || multi_queue_size(&queue) != items_count)
+    {
+        printf("%s test FAILED: queue size expected to be %zu after concurrent push\n", __func__, items_count);
+        goto free_mem;
+    }
+    if (0 != run_workers(pop_worker, workers)
+        || 0 != run_workers(push_pop_worker, workers)
+        || 0 != run_workers(pop_worker, workers))
+    {
+        printf("%s test FAILED: failed to start worker threads\n", __func__);
+        goto free_mem;
+    }
+
+    // every item was pushed twice, by push worker and by push-pop worker, and drained after each round
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (items[i].popped != 2)
+        {
+            printf("%s test FAILED: item %zu popped %"PRIu32" times\n", __func__, i, items[i].popped);
+            goto free_mem;
+        }
+    }
+    for (size_t i = 0; i < queue.shards_count; i++)
+    {
+        if (0 != linked_binary_heap_verify(&queue.shards[i].heap))
+        {
+            printf("%s test FAILED: shard %zu is not valid\n", __func__, i);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    multi_queue_destroy(&queue);
+    free(items);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_multi_queue_single_shard_pops_in_order();
+    test_multi_queue_concurrent_items_popped_once();
+}
@@ -0,0 +1,928 @@
+#include "pooled_binary_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#if defined(LINKED_BINARY_HEAP_DEBUG)
+#define POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS
+#endif
+
+#if defined(LINKED_BINARY_HEAP_STATS)
+#define POOLED_BINARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (heap)->stats.counter += (value); } while (0)
+#else
+#define POOLED_BINARY_HEAP_STATS_ADD(heap, counter, value) \
+do { (void)(heap); } while (0)
+#endif
+
+#define UINT32_GT(a, b) (((b) - (a)) & 0x80000000)
+
+#define POOLED_BINARY_HEAP_MIN_CAPACITY 16
+
+// values of parent link of nodes which are not in the heap
+#define POOLED_BINARY_HEAP_DETACHED (UINT32_MAX - 1)
+#define POOLED_BINARY_HEAP_FREE (UINT32_MAX - 2)
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static int
+pooled_binary_heap_node_compare_data(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t a,
+    pooled_binary_heap_handle_t b)
+{
+    if (a == b)
+    {
+        return 0;
+    }
+    const pooled_binary_heap_node_t* const x = &heap->nodes[a];
+    const pooled_binary_heap_node_t* const y = &heap->nodes[b];
+    if (heap->comparer == NULL)
+    {
+        if (x->key != y->key)
+        {
+            return x->key < y->key ? -1 : 1;
+        }
+    }
+    else
+    {
+        const int cmp = heap->comparer(x->data, y->data);
+        if (cmp != 0)
+        {
+            return cmp;
+        }
+    }
+    if (x->sequence == y->sequence)
+    {
+        ASSERT_WITH_MSG(0, "Only possible when compared to itself");
+        return 0;
+    }
+    // break equal priorities by order of push into heap
+    return UINT32_GT(x->sequence, y->sequence) ? 1 : -1;
+}
+
+
+static int
+pooled_binary_heap_node_in_heap(
+    const pooled_binary_heap_node_t* node)
+{
+    return node->parent != POOLED_BINARY_HEAP_DETACHED && node->parent != POOLED_BINARY_HEAP_FREE;
+}
+
+
+static void
+pooled_binary_heap_bubble_up(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t node)
+{
+    pooled_binary_heap_node_t* const nodes = heap->nodes;
+
+    // find the highest ancestor to be displaced using comparisons only
+    pooled_binary_heap_handle_t top = nodes[node].parent;
+    if (top == POOLED_BINARY_HEAP_NIL || pooled_binary_heap_node_compare_data(heap, node, top) > 0)
+    {
+        return;
+    }
+    uint32_t levels = 1;
+    while (nodes[top].parent != POOLED_BINARY_HEAP_NIL
+        && pooled_binary_heap_node_compare_data(heap, node, nodes[top].parent) <= 0)
+    {
+        top = nodes[top].parent;
+        levels++;
+    }
+    POOLED_BINARY_HEAP_STATS_ADD(heap, swaps, levels);
+
+    // shift every ancestor on the path one level down, bottom to top,
+    // left/right hold children of the position the ancestor moves into
+    const pooled_binary_heap_handle_t top_parent = nodes[top].parent;
+    pooled_binary_heap_handle_t left = nodes[node].left;
+    pooled_binary_heap_handle_t right = nodes[node].right;
+    pooled_binary_heap_handle_t below = node;
+    pooled_binary_heap_handle_t ancestor = nodes[node].parent;
+    if (heap->last == node)
+    {
+        heap->last = ancestor;
+    }
+    for (;;)
+    {
+        const pooled_binary_heap_handle_t next = nodes[ancestor].parent;
+        const int from_left = (nodes[ancestor].left == below);
+        const pooled_binary_heap_handle_t sibling = from_left ? nodes[ancestor].right : nodes[ancestor].left;
+
+        nodes[ancestor].left = left;
+        if (left != POOLED_BINARY_HEAP_NIL)
+        {
+            nodes[left].parent = ancestor;
+        }
+        nodes[ancestor].right = right;
+        if (right != POOLED_BINARY_HEAP_NIL)
+        {
+            nodes[right].parent = ancestor;
+        }
+
+        if (from_left)
+        {
+            left = ancestor;
+            right = sibling;
+        }
+        else
+        {
+            left = sibling;
+            right = ancestor;
+        }
+        if (ancestor == top)
+        {
+            break;
+        }
+        below = ancestor;
+        ancestor = next;
+    }
+
+    // node takes place of the top ancestor
+    nodes[node].parent = top_parent;
+    if (top_parent == POOLED_BINARY_HEAP_NIL)
+    {
+        heap->root = node;
+    }
+    else if (nodes[top_parent].left == top)
+    {
+        nodes[top_parent].left = node;
+    }
+    else
+    {
+        nodes[top_parent].right = node;
+    }
+    nodes[node].left = left;
+    nodes[left].parent = node;
+    nodes[node].right = right;
+    if (right != POOLED_BINARY_HEAP_NIL)
+    {
+        nodes[right].parent = node;
+    }
+}
+
+
+static void
+pooled_binary_heap_bubble_down(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t node)
+{
+    pooled_binary_heap_node_t* const nodes = heap->nodes;
+
+    // find final position using comparisons only, remember taken direction per level,
+    // 32-bit handles limit depth of the tree to 32 levels
+    const uint32_t max_depth = 32;
+    uint32_t path = 0;
+    uint32_t depth = 0;
+    pooled_binary_heap_handle_t position = node;
+    for (; depth < max_depth; depth++)
+    {
+        const pooled_binary_heap_handle_t left = nodes[position].left;
+        const pooled_binary_heap_handle_t right = nodes[position].right;
+        pooled_binary_heap_handle_t smallest = node;
+        if (left != POOLED_BINARY_HEAP_NIL && pooled_binary_heap_node_compare_data(heap, left, smallest) < 0)
+        {
+            smallest = left;
+        }
+        if (right != POOLED_BINARY_HEAP_NIL && pooled_binary_heap_node_compare_data(heap, right, smallest) < 0)
+        {
+            smallest = right;
+        }
+        if (smallest == node)
+        {
+            break;
+        }
+        if (smallest == right)
+        {
+            path |= ((uint32_t)1) << depth;
+        }
+        position = smallest;
+    }
+    if (depth == 0)
+    {
+        return;
+    }
+    POOLED_BINARY_HEAP_STATS_ADD(heap, swaps, depth);
+
+    // shift every child on the path one level up, top to bottom,
+    // left/right hold children of the position the child moves out of
+    pooled_binary_heap_handle_t parent = nodes[node].parent;
+    pooled_binary_heap_handle_t* link = &heap->root;
+    if (parent != POOLED_BINARY_HEAP_NIL)
+    {
+        link = (nodes[parent].left == node) ? &nodes[parent].left : &nodes[parent].right;
+    }
+    pooled_binary_heap_handle_t left = nodes[node].left;
+    pooled_binary_heap_handle_t right = nodes[node].right;
+    for (uint32_t i = 0; i < depth; i++)
+    {
+        const int to_right = (path & (((uint32_t)1) << i)) != 0;
+        const pooled_binary_heap_handle_t child = to_right ? right : left;
+        const pooled_binary_heap_handle_t sibling = to_right ? left : right;
+        left = nodes[child].left;
+        right = nodes[child].right;
+
+        *link = child;
+        nodes[child].parent = parent;
+        if (to_right)
+        {
+            nodes[child].left = sibling;
+            link = &nodes[child].right;
+        }
+        else
+        {
+            nodes[child].right = sibling;
+            link = &nodes[child].left;
+        }
+        if (sibling != POOLED_BINARY_HEAP_NIL)
+        {
+            nodes[sibling].parent = child;
+        }
+        parent = child;
+    }
+
+    // node takes place of the last shifted child
+    if (heap->last == parent)
+    {
+        heap->last = node;
+    }
+    *link = node;
+    nodes[node].parent = parent;
+    nodes[node].left = left;
+    if (left != POOLED_BINARY_HEAP_NIL)
+    {
+        nodes[left].parent = node;
+    }
+    nodes[node].right = right;
+    if (right != POOLED_BINARY_HEAP_NIL)
+    {
+        nodes[right].parent = node;
+    }
+}
+
+
+static pooled_binary_heap_handle_t
+pooled_binary_heap_node_predecessor(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t node)
+{
+    const pooled_binary_heap_node_t* const nodes = heap->nodes;
+    ASSERT_WITH_MSG(nodes[node].parent != POOLED_BINARY_HEAP_NIL, "root node does not have predecessor");
+
+    // previous node in level order, amortized O(1) for consecutive calls
+    if (nodes[nodes[node].parent].right == node)
+    {
+        return nodes[nodes[node].parent].left;
+    }
+    pooled_binary_heap_handle_t n = node;
+    uint32_t levels = 0;
+    while (nodes[n].parent != POOLED_BINARY_HEAP_NIL && nodes[nodes[n].parent].left == n)
+    {
+        n = nodes[n].parent;
+        levels++;
+    }
+    if (nodes[n].parent == POOLED_BINARY_HEAP_NIL)
+    {
+        // node is the first on its level, predecessor is the last node of the level above
+        levels--;
+    }
+    else
+    {
+        n = nodes[nodes[n].parent].left;
+    }
+    for (uint32_t i = 0; i < levels; i++)
+    {
+        n = nodes[n].right;
+    }
+    return n;
+}
+
+
+static pooled_binary_heap_handle_t
+pooled_binary_heap_next_parent(
+    const pooled_binary_heap_t* heap)
+{
+    const pooled_binary_heap_node_t* const nodes = heap->nodes;
+    ASSERT_WITH_MSG(heap->last != POOLED_BINARY_HEAP_NIL, "heap must not be empty");
+
+    // parent of the next free slot in level order, amortized O(1) for consecutive calls
+    pooled_binary_heap_handle_t n = heap->last;
+    if (nodes[n].parent == POOLED_BINARY_HEAP_NIL)
+    {
+        return n;
+    }
+    if (nodes[nodes[n].parent].left == n)
+    {
+        return nodes[n].parent;
+    }
+    uint32_t levels = 0;
+    while (nodes[n].parent != POOLED_BINARY_HEAP_NIL && nodes[nodes[n].parent].right == n)
+    {
+        n = nodes[n].parent;
+        levels++;
+    }
+    if (nodes[n].parent == POOLED_BINARY_HEAP_NIL)
+    {
+        // the last level is full, next slot starts a new level
+        levels++;
+    }
+    else
+    {
+        n = nodes[nodes[n].parent].right;
+    }
+    for (uint32_t i = 1; i < levels; i++)
+    {
+        n = nodes[n].left;
+    }
+    return n;
+}
+
+
+static int
+pooled_binary_heap_grow(
+    pooled_binary_heap_t* heap,
+    size_t required)
+{
+    if (required <= heap->capacity)
+    {
+        return 0;
+    }
+    if (required > POOLED_BINARY_HEAP_MAX_CAPACITY)
+    {
+        return -1;
+    }
+    size_t capacity = heap->capacity < POOLED_BINARY_HEAP_MIN_CAPACITY ? POOLED_BINARY_HEAP_MIN_CAPACITY : heap->capacity;
+    while (capacity < required)
+    {
+        capacity *= 2;
+    }
+    if (capacity > POOLED_BINARY_HEAP_MAX_CAPACITY)
+    {
+        capacity = POOLED_BINARY_HEAP_MAX_CAPACITY;
+    }
+    pooled_binary_heap_node_t* nodes =
+        (pooled_binary_heap_node_t*)realloc(heap->nodes, capacity * sizeof(pooled_binary_heap_node_t));
+    if (nodes == NULL)
+    {
+        return -1;
+    }
+    heap->nodes = nodes;
+    heap->capacity = (uint32_t)capacity;
+    return 0;
+}
+
+
+static int
+pooled_binary_heap_verify_subtree(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t node,
+    pooled_binary_heap_handle_t parent,
+    uint32_t* count)
+{
+    if (node == POOLED_BINARY_HEAP_NIL)
+    {
+        return 0;
+    }
+    if (node >= heap->allocated || heap->nodes[node].parent != parent)
+    {
+        ASSERT_WITH_MSG(0, "Node has wrong link to parent");
+        return -1;
+    }
+    if (*count >= heap->size)
+    {
+        ASSERT_WITH_MSG(0, "Actual and declared nodes count mismatch");
+        return -1;
+    }
+    *count += 1;
+    if (parent != POOLED_BINARY_HEAP_NIL && pooled_binary_heap_node_compare_data(heap, parent, node) > 0)
+    {
+        ASSERT_WITH_MSG(0, "Node's parent has bigger priority");
+        return -1;
+    }
+    if (0 != pooled_binary_heap_verify_subtree(heap, heap->nodes[node].left, node, count))
+    {
+        return -1;
+    }
+    return pooled_binary_heap_verify_subtree(heap, heap->nodes[node].right, node, count);
+}
+
+
+void
+pooled_binary_heap_init(
+    pooled_binary_heap_t* heap,
+    linked_binary_heap_node_data_comparer comparer)
+{
+    memset(heap, 0, sizeof(*heap));
+    heap->free_list = POOLED_BINARY_HEAP_NIL;
+    heap->root = POOLED_BINARY_HEAP_NIL;
+    heap->last = POOLED_BINARY_HEAP_NIL;
+    heap->comparer = comparer;
+}
+
+
+void
+pooled_binary_heap_init_keyed(
+    pooled_binary_heap_t* heap)
+{
+    pooled_binary_heap_init(heap, NULL);
+}
+
+
+void
+pooled_binary_heap_destroy(
+    pooled_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    free(heap->nodes);
+    pooled_binary_heap_init(heap, heap->comparer);
+}
+
+
+int
+pooled_binary_heap_reserve(
+    pooled_binary_heap_t* heap,
+    size_t capacity)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    return pooled_binary_heap_grow(heap, capacity);
+}
+
+
+int
+pooled_binary_heap_node_alloc(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t* out_handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_handle != NULL, "Pointer to out handle must not be null");
+    pooled_binary_heap_handle_t handle = heap->free_list;
+    if (handle != POOLED_BINARY_HEAP_NIL)
+    {
+        heap->free_list = heap->nodes[handle].left;
+    }
+    else
+    {
+        if (0 != pooled_binary_heap_grow(heap, (size_t)heap->allocated + 1))
+        {
+            return -1;
+        }
+        handle = heap->allocated;
+    }
+    pooled_binary_heap_node_t* const node = &heap->nodes[handle];
+    node->key = 0;
+    node->parent = POOLED_BINARY_HEAP_DETACHED;
+    node->left = POOLED_BINARY_HEAP_NIL;
+    node->right = POOLED_BINARY_HEAP_NIL;
+    node->sequence = 0;
+    if (handle == heap->allocated)
+    {
+        // node state is written before node is counted, so rebuild after the owner died never meets
+        // counted node of shared slab whose zeroed parent link looks like a link of heap node
+        atomic_signal_fence(memory_order_release);
+        heap->allocated += 1;
+    }
+    *out_handle = handle;
+    return 0;
+}
+
+
+void
+pooled_binary_heap_node_free(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(handle < heap->allocated, "Handle must be allocated from the heap");
+    pooled_binary_heap_node_t* const node = &heap->nodes[handle];
+    if (node->parent == POOLED_BINARY_HEAP_FREE)
+    {
+        ASSERT_WITH_MSG(0, "Node is already freed");
+        return;
+    }
+    if (pooled_binary_heap_node_in_heap(node))
+    {
+        pooled_binary_heap_remove(heap, handle);
+    }
+    node->parent = POOLED_BINARY_HEAP_FREE;
+    node->left = heap->free_list;
+    heap->free_list = handle;
+}
+
+
+void
+pooled_binary_heap_node_set_data(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle,
+    void* data)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(handle < heap->allocated, "Handle must be allocated from the heap");
+    ASSERT_WITH_MSG(heap->comparer != NULL, "Keyed heap nodes have no data");
+    heap->nodes[handle].data = data;
+}
+
+
+void*
+pooled_binary_heap_node_get_data(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(handle < heap->allocated, "Handle must be allocated from the heap");
+    ASSERT_WITH_MSG(heap->comparer != NULL, "Keyed heap nodes have no data");
+    return heap->nodes[handle].data;
+}
+
+
+void
+pooled_binary_heap_node_set_key_u64(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle,
+    uint64_t key)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(handle < heap->allocated, "Handle must be allocated from the heap");
+    ASSERT_WITH_MSG(heap->comparer == NULL, "Node must belong to keyed heap");
+    pooled_binary_heap_node_t* const node = &heap->nodes[handle];
+    if (!pooled_binary_heap_node_in_heap(node))
+    {
+        node->key = key;
+        return;
+    }
+    if (node->key == key)
+    {
+        return;
+    }
+    const int decreased = key < node->key;
+    node->key = key;
+    if (decreased)
+    {
+        pooled_binary_heap_decrease(heap, handle);
+    }
+    else
+    {
+        pooled_binary_heap_increase(heap, handle);
+    }
+}
+
+
+uint64_t
+pooled_binary_heap_node_get_key_u64(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(handle < heap->allocated, "Handle must be allocated from the heap");
+    return heap->nodes[handle].key;
+}
+
+
+size_t
+pooled_binary_heap_size(
+    const pooled_binary_heap_t* heap)
+{
+    return heap->size;
+}
+
+
+uint32_t
+pooled_binary_heap_version(
+    const pooled_binary_heap_t* heap)
+{
+    return heap->mod_count;
+}
+
+
+int
+pooled_binary_heap_contains_node(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    return handle < heap->allocated && pooled_binary_heap_node_in_heap(&heap->nodes[handle]);
+}
+
+
+void
+pooled_binary_heap_push(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(handle < heap->allocated, "Handle must be allocated from the heap");
+    pooled_binary_heap_node_t* const nodes = heap->nodes;
+    if (nodes[handle].parent != POOLED_BINARY_HEAP_DETACHED)
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap or freed");
+        return;
+    }
+
+    // link node to the next free slot in level order
+    nodes[handle].left = POOLED_BINARY_HEAP_NIL;
+    nodes[handle].right = POOLED_BINARY_HEAP_NIL;
+    if (heap->last == POOLED_BINARY_HEAP_NIL)
+    {
+        heap->root = handle;
+        nodes[handle].parent = POOLED_BINARY_HEAP_NIL;
+    }
+    else
+    {
+        const pooled_binary_heap_handle_t parent = pooled_binary_heap_next_parent(heap);
+        if (nodes[parent].left == POOLED_BINARY_HEAP_NIL)
+        {
+            nodes[parent].left = handle;
+        }
+        else
+        {
+            nodes[parent].right = handle;
+        }
+        nodes[handle].parent = parent;
+    }
+    heap->last = handle;
+    nodes[handle].sequence = heap->mod_count;
+    heap->size += 1;
+    heap->mod_count += 1;
+    pooled_binary_heap_bubble_up(heap, handle);
+#if defined(POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    pooled_binary_heap_verify(heap);
+#endif
+}
+
+
+void
+pooled_binary_heap_remove(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (!pooled_binary_heap_contains_node(heap, handle))
+    {
+        ASSERT_WITH_MSG(0, "Node is not inserted into the heap");
+        return;
+    }
+    pooled_binary_heap_node_t* const nodes = heap->nodes;
+
+    heap->size -= 1;
+    heap->mod_count += 1;
+    if (heap->size == 0)
+    {
+        heap->root = POOLED_BINARY_HEAP_NIL;
+        heap->last = POOLED_BINARY_HEAP_NIL;
+    }
+    else
+    {
+        // detach the last node, then let it take place of the removed one
+        const pooled_binary_heap_handle_t last_node = heap->last;
+        const pooled_binary_heap_handle_t last_parent = nodes[last_node].parent;
+        heap->last = pooled_binary_heap_node_predecessor(heap, last_node);
+        if (nodes[last_parent].left == last_node)
+        {
+            nodes[last_parent].left = POOLED_BINARY_HEAP_NIL;
+        }
+        else
+        {
+            nodes[last_parent].right = POOLED_BINARY_HEAP_NIL;
+        }
+
+        if (last_node != handle)
+        {
+            if (heap->last == handle)
+            {
+                heap->last = last_node;
+            }
+            const pooled_binary_heap_handle_t parent = nodes[handle].parent;
+            nodes[last_node].parent = parent;
+            nodes[last_node].left = nodes[handle].left;
+            nodes[last_node].right = nodes[handle].right;
+            if (parent == POOLED_BINARY_HEAP_NIL)
+            {
+                heap->root = last_node;
+            }
+            else if (nodes[parent].left == handle)
+            {
+                nodes[parent].left = last_node;
+            }
+            else
+            {
+                nodes[parent].right = last_node;
+            }
+            if (nodes[last_node].left != POOLED_BINARY_HEAP_NIL)
+            {
+                nodes[nodes[last_node].left].parent = last_node;
+            }
+            if (nodes[last_node].right != POOLED_BINARY_HEAP_NIL)
+            {
+                nodes[nodes[last_node].right].parent = last_node;
+            }
+            pooled_binary_heap_bubble_down(heap, last_node);
+            pooled_binary_heap_bubble_up(heap, last_node);
+        }
+    }
+
+    nodes[handle].parent = POOLED_BINARY_HEAP_DETACHED;
+    nodes[handle].left = POOLED_BINARY_HEAP_NIL;
+    nodes[handle].right = POOLED_BINARY_HEAP_NIL;
+    nodes[handle].sequence = 0;
+#if defined(POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    pooled_binary_heap_verify(heap);
+#endif
+}
+
+
+void
+pooled_binary_heap_update(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (!pooled_binary_heap_contains_node(heap, handle))
+    {
+        ASSERT_WITH_MSG(0, "Node is not inserted into the heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    const pooled_binary_heap_handle_t parent = heap->nodes[handle].parent;
+    if (parent != POOLED_BINARY_HEAP_NIL && pooled_binary_heap_node_compare_data(heap, handle, parent) < 0)
+    {
+        pooled_binary_heap_bubble_up(heap, handle);
+    }
+    else
+    {
+        pooled_binary_heap_bubble_down(heap, handle);
+    }
+#if defined(POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    pooled_binary_heap_verify(heap);
+#endif
+}
+
+
+void
+pooled_binary_heap_decrease(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (!pooled_binary_heap_contains_node(heap, handle))
+    {
+        ASSERT_WITH_MSG(0, "Node is not inserted into the heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    pooled_binary_heap_bubble_up(heap, handle);
+#if defined(POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    pooled_binary_heap_verify(heap);
+#endif
+}
+
+
+void
+pooled_binary_heap_increase(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (!pooled_binary_heap_contains_node(heap, handle))
+    {
+        ASSERT_WITH_MSG(0, "Node is not inserted into the heap");
+        return;
+    }
+
+    heap->mod_count += 1;
+    pooled_binary_heap_bubble_down(heap, handle);
+#if defined(POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    pooled_binary_heap_verify(heap);
+#endif
+}
+
+
+int
+pooled_binary_heap_peek(
+    const pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t* out_handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_handle != NULL, "Pointer to out handle must not be null");
+    if (heap->size > 0)
+    {
+        *out_handle = heap->root;
+        return 0;
+    }
+    return -1;
+}
+
+
+int
+pooled_binary_heap_pop(
+    pooled_binary_heap_t* heap,
+    pooled_binary_heap_handle_t* out_handle)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_handle != NULL, "Pointer to out handle must not be null");
+    if (0 != pooled_binary_heap_peek(heap, out_handle))
+    {
+        return -1;
+    }
+    pooled_binary_heap_remove(heap, *out_handle);
+    return 0;
+}
+
+
+void
+pooled_binary_heap_rebuild(
+    pooled_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    pooled_binary_heap_node_t* const nodes = heap->nodes;
+    heap->root = POOLED_BINARY_HEAP_NIL;
+    heap->last = POOLED_BINARY_HEAP_NIL;
+    heap->free_list = POOLED_BINARY_HEAP_NIL;
+    heap->size = 0;
+    heap->mod_count += 1;
+
+    // links may be left half updated, only free state of nodes is trusted
+    for (pooled_binary_heap_handle_t handle = heap->allocated; handle-- > 0;)
+    {
+        if (nodes[handle].parent == POOLED_BINARY_HEAP_FREE)
+        {
+            nodes[handle].left = heap->free_list;
+            heap->free_list = handle;
+        }
+    }
+    // node is detached until push links it and again once remove unlinks it, so only nodes
+    // which were linked are pushed back and detached ones stay owned by the caller
+    for (pooled_binary_heap_handle_t handle = 0; handle < heap->allocated; handle++)
+    {
+        if (pooled_binary_heap_node_in_heap(&nodes[handle]))
+        {
+            nodes[handle].parent = POOLED_BINARY_HEAP_DETACHED;
+            pooled_binary_heap_push(heap, handle);
+        }
+    }
+#if defined(POOLED_BINARY_HEAP_VERIFY_MUTATE_FUNCTIONS)
+    pooled_binary_heap_verify(heap);
+#endif
+}
+
+
+void
+pooled_binary_heap_free_detached(
+    pooled_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    for (pooled_binary_heap_handle_t handle = heap->allocated; handle-- > 0;)
+    {
+        if (heap->nodes[handle].parent == POOLED_BINARY_HEAP_DETACHED)
+        {
+            pooled_binary_heap_node_free(heap, handle);
+        }
+    }
+}
+
+
+int
+pooled_binary_heap_verify(
+    const pooled_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    uint32_t count = 0;
+    if (0 != pooled_binary_heap_verify_subtree(heap, heap->root, POOLED_BINARY_HEAP_NIL, &count))
+    {
+        return -1;
+    }
+    if (count != heap->size)
+    {
+        ASSERT_WITH_MSG(0, "Actual and declared nodes count mismatch");
+        return -1;
+    }
+
+    // last node must be at position size - 1 in level order
+    pooled_binary_heap_handle_t last = POOLED_BINARY_HEAP_NIL;
+    if (heap->size > 0)
+    {
+        size_t path = 0;
+        uint8_t depth = 0;
+        linked_binary_heap_node_get_traverse_path_from_index(heap->size - 1, &path, &depth);
+        last = heap->root;
+        for (uint8_t i = 0; i < depth; i++)
+        {
+            last = (path & (((size_t)1) << i)) ? heap->nodes[last].right : heap->nodes[last].left;
+        }
+    }
+    if (last != heap->last)
+    {
+        ASSERT_WITH_MSG(0, "Last node handle does not match last node in level order");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,202 @@
+#ifndef _POOLED_BINARY_HEAP_H_
+#define _POOLED_BINARY_HEAP_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Linked binary heap with nodes allocated from a slab owned by the heap.
+ * Nodes are addressed by 32-bit handles which stay valid while slab grows,
+ * links between nodes are handles as well, so node takes 24 bytes.
+ * Freed nodes are recycled through a free list, with reserved capacity
+ * allocation and free never call malloc.
+ */
+
+/* invalid node handle, also used as missing link */
+#define POOLED_BINARY_HEAP_NIL UINT32_MAX
+
+/* maximal number of nodes in the slab, handles above are reserved for node states */
+#define POOLED_BINARY_HEAP_MAX_CAPACITY (UINT32_MAX - 3)
+
+typedef uint32_t pooled_binary_heap_handle_t;
+
+typedef struct pooled_binary_heap_node pooled_binary_heap_node_t;
+
+typedef struct pooled_binary_heap pooled_binary_heap_t;
+
+/* structure representing heap node stored in the slab */
+struct pooled_binary_heap_node
+{
+    union
+    {
+        void* data; /* pointer to data associated with heap node, compared by comparer */
+        uint64_t key; /* key of the node in keyed heap */
+    };
+    pooled_binary_heap_handle_t parent; /* parent node, NIL for the root, special values mark nodes out of the heap and free nodes */
+    pooled_binary_heap_handle_t left; /* left child of the node, next free node for free nodes */
+    pooled_binary_heap_handle_t right; /* right child of the node */
+    uint32_t sequence; /* sequence number of this node, used to resolve priority collision in push order */
+};
+
+/* structure representing heap */
+struct pooled_binary_heap
+{
+    pooled_binary_heap_node_t* nodes; /* slab of nodes indexed by handle */
+    uint32_t capacity; /* number of nodes slab can hold */
+    uint32_t allocated; /* number of slab nodes ever handed out, nodes above are never used */
+    pooled_binary_heap_handle_t free_list; /* head of the list of freed nodes */
+    pooled_binary_heap_handle_t root; /* root node of the heap */
+    pooled_binary_heap_handle_t last; /* last node of the heap in level order */
+    uint32_t size; /* number of nodes stored in this heap */
+    uint32_t mod_count; /* number of heap modification operations executed */
+    linked_binary_heap_node_data_comparer comparer; /* function to compare data associated with nodes, null for keyed heap */
+#if defined(LINKED_BINARY_HEAP_STATS)
+    linked_binary_heap_stats_t stats; /* counters of internal operations */
+#endif
+};
+
+
+void
+pooled_binary_heap_init(
+    pooled_binary_heap_t*,
+    linked_binary_heap_node_data_comparer);
+
+
+/* initializes heap ordered by u64 node keys instead of comparer */
+void
+pooled_binary_heap_init_keyed(
+    pooled_binary_heap_t*);
+
+
+/* releases the slab, all handles become invalid */
+void
+pooled_binary_heap_destroy(
+    pooled_binary_heap_t*);
+
+
+/* preallocates slab for at least given number of nodes, returns -1 on allocation failure */
+int
+pooled_binary_heap_reserve(
+    pooled_binary_heap_t*,
+    size_t);
+
+
+/* allocates node which is not inserted into the heap yet, returns -1 if slab can not be grown */
+int
+pooled_binary_heap_node_alloc(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t*);
+
+
+/* returns node to the free list, node is removed from the heap first if needed */
+void
+pooled_binary_heap_node_free(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+void
+pooled_binary_heap_node_set_data(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t,
+    void*);
+
+
+void*
+pooled_binary_heap_node_get_data(
+    const pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+/* key setter of keyed heap nodes, node already inserted into the heap is moved according to the new key */
+void
+pooled_binary_heap_node_set_key_u64(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t,
+    uint64_t);
+
+
+uint64_t
+pooled_binary_heap_node_get_key_u64(
+    const pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+size_t
+pooled_binary_heap_size(
+    const pooled_binary_heap_t*);
+
+
+uint32_t
+pooled_binary_heap_version(
+    const pooled_binary_heap_t*);
+
+
+int
+pooled_binary_heap_contains_node(
+    const pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+void
+pooled_binary_heap_push(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+void
+pooled_binary_heap_remove(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+void
+pooled_binary_heap_update(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+void
+pooled_binary_heap_decrease(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+void
+pooled_binary_heap_increase(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t);
+
+
+int
+pooled_binary_heap_pop(
+    pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t*);
+
+
+int
+pooled_binary_heap_peek(
+    const pooled_binary_heap_t*,
+    pooled_binary_heap_handle_t*);
+
+
+/* relinks every node which was linked into the heap and rebuilds the free list from node states only,
+ * recovers heap whose modification was interrupted, nodes not pushed yet or already removed stay detached */
+void
+pooled_binary_heap_rebuild(
+    pooled_binary_heap_t*);
+
+
+/* frees every allocated node which is neither in the heap nor freed, e.g. nodes of died owner after rebuild */
+void
+pooled_binary_heap_free_detached(
+    pooled_binary_heap_t*);
+
+
+int
+pooled_binary_heap_verify(
+    const pooled_binary_heap_t*);
+
+#endif
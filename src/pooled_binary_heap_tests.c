@@ -0,0 +1,217 @@
+#include "pooled_binary_heap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+typedef struct item
+{
+    pooled_binary_heap_handle_t handle;
+    int32_t priority;
+} item_t;
+
+
+int
+item_comparer(const void* x, const void* y)
+{
+    const item_t* X = x;
+    const item_t* Y = y;
+    return (X->priority > Y->priority) - (X->priority < Y->priority);
+}
+
+
+void
+shuffle_array(uint32_t *a, size_t size)
+{
+    for (size_t i = size - 1; i >= 1; i--)
+    {
+        const size_t r = (size_t)1 * RAND_MAX * rand() + rand();
+        size_t j = r % (i + 1);
+        uint32_t temp = a[j];
+        a[j] = a[i];
+        a[i] = temp;
+    }
+}
+
+
+void
+test_pooled_binary_heap_node_size(void)
+{
+    if (sizeof(pooled_binary_heap_node_t) > 24)
+    {
+        printf("%s test FAILED: node takes %zu bytes\n", __func__, sizeof(pooled_binary_heap_node_t));
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_pooled_binary_heap_push_pop_random_keys(void)
+{
+    const uint32_t items_count = 1024 * 1024;
+    pooled_binary_heap_t heap;
+    pooled_binary_heap_init_keyed(&heap);
+    if (0 != pooled_binary_heap_reserve(&heap, items_count))
+    {
+        printf("%s test FAILED: failed to reserve heap capacity\n", __func__);
+        goto free_mem;
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        pooled_binary_heap_handle_t handle;
+        if (0 != pooled_binary_heap_node_alloc(&heap, &handle))
+        {
+            printf("%s test FAILED: failed to allocate node\n", __func__);
+            goto free_mem;
+        }
+        pooled_binary_heap_node_set_key_u64(&heap, handle, (uint64_t)(rand() % items_count));
+        pooled_binary_heap_push(&heap, handle);
+    }
+    if (heap.capacity != items_count || pooled_binary_heap_size(&heap) != items_count)
+    {
+        printf("%s test FAILED: reserved slab was grown\n", __func__);
+        goto free_mem;
+    }
+
+    if (0 != pooled_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: Heap is not valid\n", __func__);
+        goto free_mem;
+    }
+
+    uint64_t root_key = 0;
+    pooled_binary_heap_handle_t top;
+    while (0 == pooled_binary_heap_pop(&heap, &top))
+    {
+        const uint64_t key = pooled_binary_heap_node_get_key_u64(&heap, top);
+        if (root_key > key)
+        {
+            printf("%s test FAILED: Key %"PRIu64" of popped node is less than previously popped %"PRIu64" \n",
+                __func__, key, root_key);
+            goto free_mem;
+        }
+        root_key = key;
+        pooled_binary_heap_node_free(&heap, top);
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    pooled_binary_heap_destroy(&heap);
+}
+
+
+void
+test_pooled_binary_heap_random_remove_and_update(void)
+{
+    const uint32_t items_count = 64 * 1024;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    uint32_t* order = (uint32_t*)malloc(items_count * sizeof(uint32_t));
+    pooled_binary_heap_t heap;
+    pooled_binary_heap_init(&heap, item_comparer);
+    if (items == NULL || order == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        goto free_mem;
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        order[i] = i;
+        items[i].priority = (int32_t)(rand() % 1024);
+        pooled_binary_heap_node_alloc(&heap, &items[i].handle);
+        pooled_binary_heap_node_set_data(&heap, items[i].handle, &items[i]);
+        pooled_binary_heap_push(&heap, items[i].handle);
+    }
+
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        item_t* item = &items[rand() % items_count];
+        item->priority = (int32_t)(rand() % 1024);
+        pooled_binary_heap_update(&heap, item->handle);
+    }
+    if (0 != pooled_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap state is invalid after update\n", __func__);
+        goto free_mem;
+    }
+
+    shuffle_array(order, items_count);
+    for (uint32_t i = 0; i < items_count; i++)
+    {
+        pooled_binary_heap_remove(&heap, items[order[i]].handle);
+        if (pooled_binary_heap_contains_node(&heap, items[order[i]].handle)
+            || (i % 1024 == 0 && 0 != pooled_binary_heap_verify(&heap)))
+        {
+            printf("%s test FAILED: heap state is invalid after remove\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    if (pooled_binary_heap_size(&heap) != 0 || 0 != pooled_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    pooled_binary_heap_destroy(&heap);
+    free(items);
+    free(order);
+}
+
+
+void
+test_pooled_binary_heap_free_list_reuse(void)
+{
+    // timers churn: nodes are freed while in the heap and slots are recycled,
+    // slab never grows past the peak number of live nodes
+    const uint32_t live_count = 4096;
+    pooled_binary_heap_handle_t handles[4096];
+    pooled_binary_heap_t heap;
+    pooled_binary_heap_init_keyed(&heap);
+
+    for (uint32_t i = 0; i < live_count; i++)
+    {
+        pooled_binary_heap_node_alloc(&heap, &handles[i]);
+        pooled_binary_heap_node_set_key_u64(&heap, handles[i], (uint64_t)(rand() % 64));
+        pooled_binary_heap_push(&heap, handles[i]);
+    }
+    const uint32_t capacity = heap.capacity;
+
+    for (uint32_t i = 0; i < 16 * live_count; i++)
+    {
+        const uint32_t slot = (uint32_t)rand() % live_count;
+        pooled_binary_heap_node_free(&heap, handles[slot]);
+        pooled_binary_heap_node_alloc(&heap, &handles[slot]);
+        pooled_binary_heap_node_set_key_u64(&heap, handles[slot], (uint64_t)(rand() % 64));
+        pooled_binary_heap_push(&heap, handles[slot]);
+        if (i % 1024 == 0 && 0 != pooled_binary_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap state is invalid after node reuse\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    if (heap.capacity != capacity || heap.allocated != live_count || pooled_binary_heap_size(&heap) != live_count)
+    {
+        printf("%s test FAILED: freed nodes are not reused\n", __func__);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    pooled_binary_heap_destroy(&heap);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_pooled_binary_heap_node_size();
+    test_pooled_binary_heap_push_pop_random_keys();
+    test_pooled_binary_heap_random_remove_and_update();
+    test_pooled_binary_heap_free_list_reuse();
+}
@@ -0,0 +1,276 @@
+#include "radix_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <string.h>
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static uint32_t
+radix_heap_highest_bit(uint64_t value)
+{
+    ASSERT_WITH_MSG(value != 0, "Value must have at least one bit set");
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - (uint32_t)__builtin_clzll(value);
+#else
+    uint32_t bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+
+static uint32_t
+radix_heap_lowest_bit(uint64_t value)
+{
+    ASSERT_WITH_MSG(value != 0, "Value must have at least one bit set");
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_ctzll(value);
+#else
+    uint32_t bit = 0;
+    while (!(value & 1))
+    {
+        value >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+
+static uint32_t
+radix_heap_bucket_of(uint64_t last_key, uint64_t key)
+{
+    return key == last_key ? 0 : radix_heap_highest_bit(key ^ last_key) + 1;
+}
+
+
+static void
+radix_heap_bucket_append(
+    radix_heap_t* heap,
+    linked_binary_heap_node_t* node,
+    uint32_t bucket)
+{
+    linked_binary_heap_node_t* const sentinel = &heap->buckets[bucket];
+    node->left = sentinel->left;
+    node->right = sentinel;
+    sentinel->left->right = node;
+    sentinel->left = node;
+    node->parent = sentinel;
+    node->sequence = bucket;
+    if (bucket > 0)
+    {
+        heap->nonempty |= ((uint64_t)1) << (bucket - 1);
+    }
+}
+
+
+static void
+radix_heap_bucket_unlink(
+    radix_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    const uint32_t bucket = node->sequence;
+    node->left->right = node->right;
+    node->right->left = node->left;
+    if (bucket > 0 && heap->buckets[bucket].right == &heap->buckets[bucket])
+    {
+        heap->nonempty &= ~(((uint64_t)1) << (bucket - 1));
+    }
+}
+
+
+static void
+radix_heap_redistribute(
+    radix_heap_t* heap)
+{
+    // smallest node is in the lowest non empty bucket, it becomes the new last key,
+    // and every node of that bucket moves to a lower bucket relative to it
+    const uint32_t bucket = radix_heap_lowest_bit(heap->nonempty) + 1;
+    linked_binary_heap_node_t* const sentinel = &heap->buckets[bucket];
+    uint64_t min_key = UINT64_MAX;
+    for (linked_binary_heap_node_t* node = sentinel->right; node != sentinel; node = node->right)
+    {
+        min_key = node->key < min_key ? node->key : min_key;
+    }
+    heap->last_key = min_key;
+
+    linked_binary_heap_node_t* node = sentinel->right;
+    sentinel->left = sentinel;
+    sentinel->right = sentinel;
+    heap->nonempty &= ~(((uint64_t)1) << (bucket - 1));
+    while (node != sentinel)
+    {
+        linked_binary_heap_node_t* const next = node->right;
+        const uint32_t target = radix_heap_bucket_of(min_key, node->key);
+        ASSERT_WITH_MSG(target < bucket, "Node must move to a lower bucket");
+        radix_heap_bucket_append(heap, node, target);
+        node = next;
+    }
+}
+
+
+void
+radix_heap_init(
+    radix_heap_t* heap)
+{
+    memset(heap, 0, sizeof(*heap));
+    for (uint32_t i = 0; i < RADIX_HEAP_BUCKETS_COUNT; i++)
+    {
+        heap->buckets[i].left = &heap->buckets[i];
+        heap->buckets[i].right = &heap->buckets[i];
+    }
+}
+
+
+size_t
+radix_heap_size(
+    const radix_heap_t* heap)
+{
+    return heap->size;
+}
+
+
+uint64_t
+radix_heap_last_key(
+    const radix_heap_t* heap)
+{
+    return heap->last_key;
+}
+
+
+int
+radix_heap_contains_node(
+    const radix_heap_t* heap,
+    const linked_binary_heap_node_t* node)
+{
+    return node->sequence < RADIX_HEAP_BUCKETS_COUNT && node->parent == &heap->buckets[node->sequence];
+}
+
+
+void
+radix_heap_push(
+    radix_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (node->parent != NULL || node->heap != NULL)
+    {
+        ASSERT_WITH_MSG(0, "Node is already inserted into the heap");
+        return;
+    }
+    ASSERT_WITH_MSG(node->key >= heap->last_key, "Key must not be smaller than the last peeked or popped key");
+    const uint32_t bucket = node->key > heap->last_key ? radix_heap_bucket_of(heap->last_key, node->key) : 0;
+    radix_heap_bucket_append(heap, node, bucket);
+    heap->size += 1;
+}
+
+
+void
+radix_heap_remove(
+    radix_heap_t* heap,
+    linked_binary_heap_node_t* node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(node != NULL, "Node pointer must not be null");
+    if (!radix_heap_contains_node(heap, node))
+    {
+        ASSERT_WITH_MSG(0, "Node belong to different heap");
+        return;
+    }
+    radix_heap_bucket_unlink(heap, node);
+    heap->size -= 1;
+    node->left = NULL;
+    node->right = NULL;
+    node->parent = NULL;
+    node->sequence = 0;
+}
+
+
+int
+radix_heap_peek(
+    radix_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (heap->size == 0)
+    {
+        return -1;
+    }
+    if (heap->buckets[0].right == &heap->buckets[0])
+    {
+        radix_heap_redistribute(heap);
+    }
+    *out_node = heap->buckets[0].right;
+    return 0;
+}
+
+
+int
+radix_heap_pop(
+    radix_heap_t* heap,
+    linked_binary_heap_node_t** out_node)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(out_node != NULL, "Pointer to out node must not be null");
+    if (0 != radix_heap_peek(heap, out_node))
+    {
+        return -1;
+    }
+    radix_heap_remove(heap, *out_node);
+    return 0;
+}
+
+
+int
+radix_heap_verify(
+    const radix_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    size_t count = 0;
+    for (uint32_t bucket = 0; bucket < RADIX_HEAP_BUCKETS_COUNT; bucket++)
+    {
+        const linked_binary_heap_node_t* const sentinel = &heap->buckets[bucket];
+        if (bucket > 0 && ((heap->nonempty >> (bucket - 1)) & 1) != (sentinel->right != sentinel))
+        {
+            ASSERT_WITH_MSG(0, "Non empty buckets mask does not match buckets");
+            return -1;
+        }
+        for (const linked_binary_heap_node_t* node = sentinel->right; node != sentinel; node = node->right)
+        {
+            if (node->right->left != node || node->parent != sentinel || node->sequence != bucket)
+            {
+                ASSERT_WITH_MSG(0, "Wrong links of node in bucket");
+                return -1;
+            }
+            if (node->key < heap->last_key || radix_heap_bucket_of(heap->last_key, node->key) != bucket)
+            {
+                ASSERT_WITH_MSG(0, "Node is stored in wrong bucket");
+                return -1;
+            }
+            if (++count > heap->size)
+            {
+                ASSERT_WITH_MSG(0, "Actual and declared nodes count mismatch");
+                return -1;
+            }
+        }
+    }
+    if (count != heap->size)
+    {
+        ASSERT_WITH_MSG(0, "Actual and declared nodes count mismatch");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef _RADIX_HEAP_H_
+#define _RADIX_HEAP_H_
+
+#include "linked_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+
+/*
+ * Monotone radix heap of linked_binary_heap_node_t ordered by u64 node keys.
+ * Pushed key must not be smaller than the last minimum, the smallest key found by the last peek or pop,
+ * e.g. deadlines or path lengths, then push is O(1) and pop is O(log C) amortized without comparing nodes on push.
+ * Peek raises the last minimum too, so it stays raised even if the peeked node is removed instead of popped.
+ * Node with key equal to the last minimum is in bucket 0, node with other key is in bucket
+ * of the highest bit differing from the last minimum, peek and pop redistribute the smallest non empty bucket.
+ * Buckets are lists linked through left and right links of nodes, nodes with equal keys are not popped in push order.
+ * Keys are set by linked_binary_heap_node_set_key_* before push and must not be changed while node is in the heap.
+ */
+
+/* number of buckets, one for the last minimum and one per bit of the key */
+#define RADIX_HEAP_BUCKETS_COUNT 65
+
+typedef struct radix_heap radix_heap_t;
+
+/* structure representing heap */
+struct radix_heap
+{
+    linked_binary_heap_node_t buckets[RADIX_HEAP_BUCKETS_COUNT]; /* sentinels of circular bucket lists, left is the previous node and right is the next one */
+    uint64_t nonempty; /* bit i - 1 is set when bucket i is not empty, bucket 0 is checked directly */
+    uint64_t last_key; /* the smallest key found by the last peek or pop, no smaller key can be pushed */
+    size_t size; /* number of nodes stored in this heap */
+};
+
+
+void
+radix_heap_init(
+    radix_heap_t*);
+
+
+size_t
+radix_heap_size(
+    const radix_heap_t*);
+
+
+/* the smallest key found by the last peek or pop, 0 before the first of them */
+uint64_t
+radix_heap_last_key(
+    const radix_heap_t*);
+
+
+int
+radix_heap_contains_node(
+    const radix_heap_t*,
+    const linked_binary_heap_node_t*);
+
+
+/* pushes node with key not smaller than the last peeked or popped key, asserts otherwise,
+ * smaller key is popped as if it was equal to that key when asserts are disabled */
+void
+radix_heap_push(
+    radix_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+void
+radix_heap_remove(
+    radix_heap_t*,
+    linked_binary_heap_node_t*);
+
+
+/* moves the smallest node into bucket 0 and raises the last key to its key, so heap is modified even though no node is removed */
+int
+radix_heap_peek(
+    radix_heap_t*,
+    linked_binary_heap_node_t**);
+
+
+int
+radix_heap_pop(
+    radix_heap_t*,
+    linked_binary_heap_node_t**);
+
+
+int
+radix_heap_verify(
+    const radix_heap_t*);
+
+#endif
@@ -0,0 +1,182 @@
+#include "radix_heap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+
+typedef struct item
+{
+    linked_binary_heap_node_t heap_node;
+    uint32_t popped;
+    int removed;
+} item_t;
+
+
+void
+test_radix_heap_monotone_push_pop_remove(void)
+{
+    const size_t items_count = 100000;
+    item_t* items = (item_t*)malloc(items_count * sizeof(item_t));
+    if (items == NULL)
+    {
+        printf("%s test FAILED: failed to allocate memory for items\n", __func__);
+        return;
+    }
+
+    // shortest path like workload, pushed keys are the last popped key plus edge length
+    radix_heap_t heap;
+    radix_heap_init(&heap);
+    size_t pushed = 0;
+    size_t popped = 0;
+    uint64_t last_key = 0;
+    while (pushed < items_count || radix_heap_size(&heap) > 0)
+    {
+        const int pushes = pushed < items_count ? 1 + rand() % 4 : 0;
+        for (int i = 0; i < pushes && pushed < items_count; i++, pushed++)
+        {
+            item_t* item = &items[pushed];
+            linked_binary_heap_node_init(&item->heap_node, item);
+            item->popped = 0;
+            item->removed = 0;
+            const uint64_t length = (rand() % 8 == 0) ? ((uint64_t)rand() << 10) : (uint64_t)(rand() % 100);
+            linked_binary_heap_node_set_key_u64(&item->heap_node, radix_heap_last_key(&heap) + length);
+            radix_heap_push(&heap, &item->heap_node);
+        }
+        if (pushed > 0 && rand() % 5 == 0)
+        {
+            item_t* item = &items[(size_t)rand() % pushed];
+            if (radix_heap_contains_node(&heap, &item->heap_node))
+            {
+                radix_heap_remove(&heap, &item->heap_node);
+                item->removed = 1;
+            }
+        }
+
+        linked_binary_heap_node_t* top;
+        if (0 == radix_heap_pop(&heap, &top))
+        {
+            item_t* item = (item_t*)top->data;
+            if (top->key < last_key || radix_heap_contains_node(&heap, top))
+            {
+                printf("%s test FAILED: key %"PRIu64" popped after %"PRIu64"\n", __func__, top->key, last_key);
+                goto free_mem;
+            }
+            last_key = top->key;
+            item->popped++;
+            popped++;
+        }
+        if (popped % 1000 == 0 && 0 != radix_heap_verify(&heap))
+        {
+            printf("%s test FAILED: heap is not valid\n", __func__);
+            goto free_mem;
+        }
+    }
+
+    for (size_t i = 0; i < items_count; i++)
+    {
+        if (items[i].popped != (items[i].removed ? 0u : 1u))
+        {
+            printf("%s test FAILED: item %zu popped %"PRIu32" times\n", __func__, i, items[i].popped);
+            goto free_mem;
+        }
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    free(items);
+}
+
+
+void
+test_radix_heap_signed_keys(void)
+{
+    // order preserving encoding of signed keys keeps them monotone
+    const int64_t keys[] = { INT64_MIN, -1000, -1000, -1, 0, 1, 7, 1000, INT64_MAX };
+    const size_t keys_count = sizeof(keys) / sizeof(keys[0]);
+    item_t items[sizeof(keys) / sizeof(keys[0])];
+    radix_heap_t heap;
+    radix_heap_init(&heap);
+    for (size_t i = keys_count; i > 0; i--)
+    {
+        linked_binary_heap_node_init(&items[i - 1].heap_node, &items[i - 1]);
+        linked_binary_heap_node_set_key_i64(&items[i - 1].heap_node, keys[i - 1]);
+        radix_heap_push(&heap, &items[i - 1].heap_node);
+    }
+    for (size_t i = 0; i < keys_count; i++)
+    {
+        linked_binary_heap_node_t* top;
+        if (0 != radix_heap_pop(&heap, &top) || linked_binary_heap_node_get_key_i64(top) != keys[i])
+        {
+            printf("%s test FAILED: key %"PRId64" is not popped in order\n", __func__, keys[i]);
+            return;
+        }
+        // key equal to the last popped one is still accepted
+        if (i == 2)
+        {
+            linked_binary_heap_node_set_key_i64(top, keys[i]);
+            radix_heap_push(&heap, top);
+            if (0 != radix_heap_pop(&heap, &top) || linked_binary_heap_node_get_key_i64(top) != keys[i])
+            {
+                printf("%s test FAILED: key equal to the last popped key is not popped next\n", __func__);
+                return;
+            }
+        }
+    }
+    linked_binary_heap_node_t* top;
+    if (0 == radix_heap_pop(&heap, &top) || 0 != radix_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap expected to be empty\n", __func__);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+
+void
+test_radix_heap_peek_raises_last_key(void)
+{
+    item_t items[3];
+    radix_heap_t heap;
+    radix_heap_init(&heap);
+    const uint64_t keys[] = { 100, 200, 150 };
+    for (size_t i = 0; i < 2; i++)
+    {
+        linked_binary_heap_node_init(&items[i].heap_node, &items[i]);
+        linked_binary_heap_node_set_key_u64(&items[i].heap_node, keys[i]);
+        radix_heap_push(&heap, &items[i].heap_node);
+    }
+
+    // peeked node removed instead of popped leaves the last key at its key
+    linked_binary_heap_node_t* top;
+    if (0 != radix_heap_peek(&heap, &top) || top != &items[0].heap_node || radix_heap_last_key(&heap) != keys[0])
+    {
+        printf("%s test FAILED: peek does not raise the last key\n", __func__);
+        return;
+    }
+    radix_heap_remove(&heap, top);
+    if (radix_heap_last_key(&heap) != keys[0])
+    {
+        printf("%s test FAILED: remove changes the last key\n", __func__);
+        return;
+    }
+
+    // any key not smaller than the last key is accepted
+    linked_binary_heap_node_init(&items[2].heap_node, &items[2]);
+    linked_binary_heap_node_set_key_u64(&items[2].heap_node, keys[2]);
+    radix_heap_push(&heap, &items[2].heap_node);
+    if (0 != radix_heap_pop(&heap, &top) || top != &items[2].heap_node || radix_heap_last_key(&heap) != keys[2]
+        || 0 != radix_heap_pop(&heap, &top) || top != &items[1].heap_node || 0 != radix_heap_verify(&heap))
+    {
+        printf("%s test FAILED: keys are not popped in order\n", __func__);
+        return;
+    }
+    printf("%s test PASSED\n", __func__);
+}
+
+int main(void)
+{
+    srand(42);
+    test_radix_heap_monotone_push_pop_remove();
+    test_radix_heap_signed_keys();
+    test_radix_heap_peek_raises_last_key();
+}
@@ -0,0 +1,372 @@
+// robust mutexes are POSIX.1-2008, which strict ISO C modes do not declare
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "shm_binary_heap.h"
+
+#include <inttypes.h>
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// slab starts at cache line boundary after the region header
+#define SHM_BINARY_HEAP_NODES_OFFSET ((sizeof(shm_binary_heap_region_t) + 63) & ~(size_t)63)
+
+// every node takes slab node, its u64 value and u32 generation
+#define SHM_BINARY_HEAP_NODE_SIZE (sizeof(pooled_binary_heap_node_t) + sizeof(uint64_t) + sizeof(uint32_t))
+
+#if defined(NDEBUG)
+#define ASSERT_WITH_MSG(expression, msg) \
+do { (void)((void) (expression), (void)(msg)); } while (0)
+#else
+#define ASSERT_WITH_MSG(expression, msg) \
+do { assert(((void)(msg), (expression))); } while (0)
+#endif
+
+
+static pooled_binary_heap_node_t*
+shm_binary_heap_nodes(
+    shm_binary_heap_region_t* region)
+{
+    return (pooled_binary_heap_node_t*)((char*)region + SHM_BINARY_HEAP_NODES_OFFSET);
+}
+
+
+static uint64_t*
+shm_binary_heap_values(
+    shm_binary_heap_region_t* region)
+{
+    return (uint64_t*)(shm_binary_heap_nodes(region) + region->capacity);
+}
+
+
+static uint32_t*
+shm_binary_heap_generations(
+    shm_binary_heap_region_t* region)
+{
+    // generation of slab node is advanced by every push, so handles of earlier pushes no longer match
+    return (uint32_t*)(shm_binary_heap_values(region) + region->capacity);
+}
+
+
+static int
+shm_binary_heap_lock(
+    shm_binary_heap_t* heap)
+{
+    shm_binary_heap_region_t* const region = heap->region;
+    const int result = pthread_mutex_lock(&region->lock);
+    if (result != 0 && result != EOWNERDEAD)
+    {
+        return -1;
+    }
+    // slab is mapped at different address in every process
+    region->heap.nodes = shm_binary_heap_nodes(region);
+    if (result == EOWNERDEAD)
+    {
+        // previous owner died, possibly in the middle of heap modification, nodes it has not linked
+        // yet or unlinked already are owned by nobody else
+        pooled_binary_heap_rebuild(&region->heap);
+        pooled_binary_heap_free_detached(&region->heap);
+        pthread_mutex_consistent(&region->lock);
+    }
+    return 0;
+}
+
+
+static void
+shm_binary_heap_unlock(
+    shm_binary_heap_t* heap)
+{
+    pthread_mutex_unlock(&heap->region->lock);
+}
+
+
+size_t
+shm_binary_heap_region_size(
+    uint32_t capacity)
+{
+    return SHM_BINARY_HEAP_NODES_OFFSET + (size_t)capacity * SHM_BINARY_HEAP_NODE_SIZE;
+}
+
+
+int
+shm_binary_heap_format(
+    shm_binary_heap_t* heap,
+    void* base,
+    size_t length)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(base != NULL, "Region pointer must not be null");
+    if (length < shm_binary_heap_region_size(1))
+    {
+        return -1;
+    }
+    size_t capacity = (length - SHM_BINARY_HEAP_NODES_OFFSET) / SHM_BINARY_HEAP_NODE_SIZE;
+    if (capacity > POOLED_BINARY_HEAP_MAX_CAPACITY)
+    {
+        capacity = POOLED_BINARY_HEAP_MAX_CAPACITY;
+    }
+
+    shm_binary_heap_region_t* const region = (shm_binary_heap_region_t*)base;
+    memset(region, 0, sizeof(*region));
+    pthread_mutexattr_t attr;
+    if (0 != pthread_mutexattr_init(&attr))
+    {
+        return -1;
+    }
+    const int result = (0 == pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED)
+        && 0 == pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST)
+        && 0 == pthread_mutex_init(&region->lock, &attr)) ? 0 : -1;
+    pthread_mutexattr_destroy(&attr);
+    if (result != 0)
+    {
+        return -1;
+    }
+    region->length = length;
+    region->capacity = (uint32_t)capacity;
+    // slab is never grown, pooled heap allocates from it until capacity is reached
+    pooled_binary_heap_init_keyed(&region->heap);
+    region->heap.capacity = (uint32_t)capacity;
+
+    // other processes attach only to complete region
+    atomic_store_explicit(&region->magic, SHM_BINARY_HEAP_MAGIC, memory_order_release);
+    heap->region = region;
+    heap->length = length;
+    heap->owns_mapping = 0;
+    return 0;
+}
+
+
+int
+shm_binary_heap_attach(
+    shm_binary_heap_t* heap,
+    void* base,
+    size_t length)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(base != NULL, "Region pointer must not be null");
+    shm_binary_heap_region_t* const region = (shm_binary_heap_region_t*)base;
+    if (length < sizeof(shm_binary_heap_region_t)
+        || SHM_BINARY_HEAP_MAGIC != atomic_load_explicit(&region->magic, memory_order_acquire)
+        || region->length > length)
+    {
+        return -1;
+    }
+    heap->region = region;
+    heap->length = length;
+    heap->owns_mapping = 0;
+    return 0;
+}
+
+
+int
+shm_binary_heap_open(
+    shm_binary_heap_t* heap,
+    const char* name,
+    uint32_t capacity)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    ASSERT_WITH_MSG(name != NULL, "Name must not be null");
+    int created = 1;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST)
+    {
+        created = 0;
+        fd = shm_open(name, O_RDWR, 0600);
+    }
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    size_t length = shm_binary_heap_region_size(capacity);
+    struct stat file_stat;
+    if (created ? 0 != ftruncate(fd, (off_t)length) : (0 != fstat(fd, &file_stat) || file_stat.st_size <= 0))
+    {
+        close(fd);
+        if (created)
+        {
+            shm_unlink(name);
+        }
+        return -1;
+    }
+    if (!created)
+    {
+        length = (size_t)file_stat.st_size;
+    }
+    void* const base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED
+        || 0 != (created ? shm_binary_heap_format(heap, base, length) : shm_binary_heap_attach(heap, base, length)))
+    {
+        if (base != MAP_FAILED)
+        {
+            munmap(base, length);
+        }
+        if (created)
+        {
+            shm_unlink(name);
+        }
+        return -1;
+    }
+    heap->owns_mapping = 1;
+    return 0;
+}
+
+
+void
+shm_binary_heap_close(
+    shm_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL, "Heap pointer must not be null");
+    if (heap->owns_mapping)
+    {
+        munmap(heap->region, heap->length);
+    }
+    heap->region = NULL;
+    heap->length = 0;
+    heap->owns_mapping = 0;
+}
+
+
+int
+shm_binary_heap_push(
+    shm_binary_heap_t* heap,
+    uint64_t key,
+    uint64_t value,
+    shm_binary_heap_handle_t* out_handle)
+{
+    ASSERT_WITH_MSG(heap != NULL && heap->region != NULL, "Heap must be attached to region");
+    if (0 != shm_binary_heap_lock(heap))
+    {
+        return -1;
+    }
+    pooled_binary_heap_t* const pooled = &heap->region->heap;
+    pooled_binary_heap_handle_t handle = POOLED_BINARY_HEAP_NIL;
+    // allocation must not grow the slab, it is not owned by the pooled heap
+    const int full = pooled->free_list == POOLED_BINARY_HEAP_NIL && pooled->allocated >= heap->region->capacity;
+    if (full || 0 != pooled_binary_heap_node_alloc(pooled, &handle))
+    {
+        shm_binary_heap_unlock(heap);
+        return -1;
+    }
+    pooled_binary_heap_node_set_key_u64(pooled, handle, key);
+    shm_binary_heap_values(heap->region)[handle] = value;
+    const uint32_t generation = ++shm_binary_heap_generations(heap->region)[handle];
+    pooled_binary_heap_push(pooled, handle);
+    shm_binary_heap_unlock(heap);
+    if (out_handle != NULL)
+    {
+        *out_handle = ((uint64_t)generation << 32) | handle;
+    }
+    return 0;
+}
+
+
+int
+shm_binary_heap_pop(
+    shm_binary_heap_t* heap,
+    uint64_t* out_key,
+    uint64_t* out_value)
+{
+    ASSERT_WITH_MSG(heap != NULL && heap->region != NULL, "Heap must be attached to region");
+    ASSERT_WITH_MSG(out_key != NULL && out_value != NULL, "Out pointers must not be null");
+    if (0 != shm_binary_heap_lock(heap))
+    {
+        return -1;
+    }
+    pooled_binary_heap_t* const pooled = &heap->region->heap;
+    pooled_binary_heap_handle_t handle;
+    const int result = pooled_binary_heap_pop(pooled, &handle);
+    if (result == 0)
+    {
+        *out_key = pooled_binary_heap_node_get_key_u64(pooled, handle);
+        *out_value = shm_binary_heap_values(heap->region)[handle];
+        pooled_binary_heap_node_free(pooled, handle);
+    }
+    shm_binary_heap_unlock(heap);
+    return result;
+}
+
+
+int
+shm_binary_heap_peek(
+    shm_binary_heap_t* heap,
+    uint64_t* out_key,
+    uint64_t* out_value)
+{
+    ASSERT_WITH_MSG(heap != NULL && heap->region != NULL, "Heap must be attached to region");
+    ASSERT_WITH_MSG(out_key != NULL && out_value != NULL, "Out pointers must not be null");
+    if (0 != shm_binary_heap_lock(heap))
+    {
+        return -1;
+    }
+    pooled_binary_heap_t* const pooled = &heap->region->heap;
+    pooled_binary_heap_handle_t handle;
+    const int result = pooled_binary_heap_peek(pooled, &handle);
+    if (result == 0)
+    {
+        *out_key = pooled_binary_heap_node_get_key_u64(pooled, handle);
+        *out_value = shm_binary_heap_values(heap->region)[handle];
+    }
+    shm_binary_heap_unlock(heap);
+    return result;
+}
+
+
+int
+shm_binary_heap_remove(
+    shm_binary_heap_t* heap,
+    shm_binary_heap_handle_t handle)
+{
+    ASSERT_WITH_MSG(heap != NULL && heap->region != NULL, "Heap must be attached to region");
+    if (0 != shm_binary_heap_lock(heap))
+    {
+        return -1;
+    }
+    pooled_binary_heap_t* const pooled = &heap->region->heap;
+    const pooled_binary_heap_handle_t node = (pooled_binary_heap_handle_t)handle;
+    const int result = (pooled_binary_heap_contains_node(pooled, node)
+        && shm_binary_heap_generations(heap->region)[node] == (uint32_t)(handle >> 32)) ? 0 : -1;
+    if (result == 0)
+    {
+        pooled_binary_heap_node_free(pooled, node);
+    }
+    shm_binary_heap_unlock(heap);
+    return result;
+}
+
+
+size_t
+shm_binary_heap_size(
+    shm_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL && heap->region != NULL, "Heap must be attached to region");
+    if (0 != shm_binary_heap_lock(heap))
+    {
+        return 0;
+    }
+    const size_t size = pooled_binary_heap_size(&heap->region->heap);
+    shm_binary_heap_unlock(heap);
+    return size;
+}
+
+
+int
+shm_binary_heap_verify(
+    shm_binary_heap_t* heap)
+{
+    ASSERT_WITH_MSG(heap != NULL && heap->region != NULL, "Heap must be attached to region");
+    if (0 != shm_binary_heap_lock(heap))
+    {
+        return -1;
+    }
+    const int result = pooled_binary_heap_verify(&heap->region->heap);
+    shm_binary_heap_unlock(heap);
+    return result;
+}
@@ -0,0 +1,133 @@
+#ifndef _SHM_BINARY_HEAP_H_
+#define _SHM_BINARY_HEAP_H_
+
+#include "pooled_binary_heap.h"
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+/*
+ * Keyed heap shared by processes of one host through a memory region mapped by each of them, e.g. shm_open and mmap.
+ * Region holds heap state, slab of nodes, u64 value and generation of every node. Links between nodes are pooled heap handles,
+ * i.e. offsets from the start of the slab, so every process can map the region at its own address
+ * and push or pop without copying or serializing nodes.
+ * Heap is protected by process shared robust mutex, when a process dies holding it the next process taking the lock
+ * rebuilds the heap from the slab, node linked by push of the died process stays in the heap and node it has
+ * allocated but not linked yet or already unlinked by pop is freed.
+ */
+
+/* value of magic of formatted region */
+#define SHM_BINARY_HEAP_MAGIC 0x504145484d4853ull
+
+/* invalid node handle */
+#define SHM_BINARY_HEAP_NIL UINT64_MAX
+
+typedef struct shm_binary_heap_region shm_binary_heap_region_t;
+
+typedef struct shm_binary_heap shm_binary_heap_t;
+
+/* handle of pushed node, slab handle in low 32 bits and generation of the slab node in high 32 bits */
+typedef uint64_t shm_binary_heap_handle_t;
+
+/* structure at the start of shared region, followed by the slab of nodes, array of node values and array of node generations */
+struct shm_binary_heap_region
+{
+    _Atomic uint64_t magic; /* SHM_BINARY_HEAP_MAGIC once region is formatted */
+    uint64_t length; /* size of the region in bytes */
+    uint32_t capacity; /* number of nodes in the slab */
+    pthread_mutex_t lock; /* process shared robust lock protecting the heap */
+    pooled_binary_heap_t heap; /* keyed heap over the slab, its nodes pointer is set by the process holding the lock */
+};
+
+/* structure representing heap in the address space of one process */
+struct shm_binary_heap
+{
+    shm_binary_heap_region_t* region; /* region mapped by this process */
+    size_t length; /* length of the mapping */
+    int owns_mapping; /* region is mapped by shm_binary_heap_open and unmapped by shm_binary_heap_close */
+};
+
+
+/* number of bytes of region holding given number of nodes */
+size_t
+shm_binary_heap_region_size(
+    uint32_t);
+
+
+/* formats region of given length mapped by the calling process, the whole region is used for nodes,
+ * returns -1 when region is too small or lock can not be initialized */
+int
+shm_binary_heap_format(
+    shm_binary_heap_t*,
+    void*,
+    size_t);
+
+
+/* attaches to region formatted by another process, returns -1 when region is not formatted yet */
+int
+shm_binary_heap_attach(
+    shm_binary_heap_t*,
+    void*,
+    size_t);
+
+
+/* creates POSIX shared memory object of given name for given number of nodes and formats it, or attaches to
+ * existing one keeping its capacity, returns -1 on failure or when another process is still formatting the region */
+int
+shm_binary_heap_open(
+    shm_binary_heap_t*,
+    const char*,
+    uint32_t);
+
+
+/* unmaps region mapped by shm_binary_heap_open, shared memory object is removed by shm_unlink */
+void
+shm_binary_heap_close(
+    shm_binary_heap_t*);
+
+
+/* allocates node with given key and value from the slab and pushes it, handle of the node is returned when out
+ * pointer is not null, returns -1 when slab is full or lock can not be taken */
+int
+shm_binary_heap_push(
+    shm_binary_heap_t*,
+    uint64_t,
+    uint64_t,
+    shm_binary_heap_handle_t*);
+
+
+/* pops node with the smallest key and frees it, returns -1 if heap is empty */
+int
+shm_binary_heap_pop(
+    shm_binary_heap_t*,
+    uint64_t*,
+    uint64_t*);
+
+
+int
+shm_binary_heap_peek(
+    shm_binary_heap_t*,
+    uint64_t*,
+    uint64_t*);
+
+
+/* removes and frees pushed node, returns -1 if node is not in the heap, handle of popped or removed node
+ * is rejected even when its slab node is reused by push of another process */
+int
+shm_binary_heap_remove(
+    shm_binary_heap_t*,
+    shm_binary_heap_handle_t);
+
+
+size_t
+shm_binary_heap_size(
+    shm_binary_heap_t*);
+
+
+int
+shm_binary_heap_verify(
+    shm_binary_heap_t*);
+
+#endif
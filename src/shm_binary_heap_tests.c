@@ -0,0 +1,214 @@
+// anonymous mapping shared with workers is not declared by strict ISO C modes
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "shm_binary_heap.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define VALUE_OF_KEY(key) ((key) ^ 0x5555555555555555ull)
+
+
+static uint64_t
+random_key(void)
+{
+    return ((uint64_t)rand() << 16) ^ (uint64_t)rand();
+}
+
+
+void
+test_shm_binary_heap_processes_push_and_pop(void)
+{
+    const size_t initial_count = 20000;
+    const size_t pushes_per_worker = 5000;
+    const int workers_count = 4;
+    char name[64];
+    snprintf(name, sizeof(name), "/linked_binary_heap_shm_test_%d", (int)getpid());
+
+    shm_binary_heap_t heap;
+    uint64_t* popped = (uint64_t*)mmap(NULL, workers_count * sizeof(uint64_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (popped == MAP_FAILED || 0 != shm_binary_heap_open(&heap, name, (uint32_t)(initial_count + workers_count * pushes_per_worker)))
+    {
+        printf("%s test FAILED: failed to map shared memory\n", __func__);
+        return;
+    }
+    for (size_t i = 0; i < initial_count; i++)
+    {
+        const uint64_t key = random_key();
+        shm_binary_heap_push(&heap, key, VALUE_OF_KEY(key), NULL);
+    }
+
+    // workers map the region again, at an address different from the parent's one
+    fflush(stdout);
+    for (int w = 0; w < workers_count; w++)
+    {
+        if (fork() == 0)
+        {
+            shm_binary_heap_t worker;
+            if (0 != shm_binary_heap_open(&worker, name, 0) || worker.region == heap.region)
+            {
+                _exit(1);
+            }
+            srand((unsigned)w);
+            popped[w] = 0;
+            for (size_t i = 0; i < pushes_per_worker; i++)
+            {
+                const uint64_t key = random_key();
+                uint64_t popped_key, popped_value;
+                if (0 != shm_binary_heap_push(&worker, key, VALUE_OF_KEY(key), NULL)
+                    || 0 != shm_binary_heap_pop(&worker, &popped_key, &popped_value)
+                    || popped_value != VALUE_OF_KEY(popped_key))
+                {
+                    _exit(1);
+                }
+                popped[w]++;
+            }
+            shm_binary_heap_close(&worker);
+            _exit(0);
+        }
+    }
+    int failed = 0;
+    for (int w = 0; w < workers_count; w++)
+    {
+        int status = 0;
+        wait(&status);
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (failed || 0 != shm_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: worker failed or heap is not valid\n", __func__);
+        goto free_mem;
+    }
+
+    size_t total = 0;
+    for (int w = 0; w < workers_count; w++)
+    {
+        total += popped[w];
+    }
+    uint64_t last_key = 0;
+    uint64_t key, value;
+    while (0 == shm_binary_heap_pop(&heap, &key, &value))
+    {
+        if (key < last_key || value != VALUE_OF_KEY(key))
+        {
+            printf("%s test FAILED: key %" PRIu64 " popped out of order\n", __func__, key);
+            goto free_mem;
+        }
+        last_key = key;
+        total++;
+    }
+    if (total != initial_count + workers_count * pushes_per_worker)
+    {
+        printf("%s test FAILED: %zu nodes popped\n", __func__, total);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    shm_binary_heap_close(&heap);
+    shm_unlink(name);
+    munmap(popped, workers_count * sizeof(uint64_t));
+}
+
+
+void
+test_shm_binary_heap_rebuilt_after_owner_died(void)
+{
+    const size_t count = 1000;
+    char name[64];
+    snprintf(name, sizeof(name), "/linked_binary_heap_shm_robust_test_%d", (int)getpid());
+    shm_binary_heap_t heap;
+    if (0 != shm_binary_heap_open(&heap, name, (uint32_t)count))
+    {
+        printf("%s test FAILED: failed to map shared memory\n", __func__);
+        return;
+    }
+    shm_binary_heap_handle_t removed = SHM_BINARY_HEAP_NIL;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint64_t key = random_key();
+        shm_binary_heap_push(&heap, key, VALUE_OF_KEY(key), i == count / 2 ? &removed : NULL);
+    }
+    uint64_t key, value;
+    if (0 != shm_binary_heap_remove(&heap, removed) || 0 == shm_binary_heap_remove(&heap, removed))
+    {
+        printf("%s test FAILED: remove of pushed node is not accepted exactly once\n", __func__);
+        goto free_mem;
+    }
+    // slab node of removed one is reused by the next push, handle of the removed node must not remove it
+    shm_binary_heap_handle_t reused = SHM_BINARY_HEAP_NIL;
+    if (0 != shm_binary_heap_push(&heap, 0, VALUE_OF_KEY(0), &reused)
+        || (uint32_t)reused != (uint32_t)removed || 0 == shm_binary_heap_remove(&heap, removed)
+        || 0 != shm_binary_heap_remove(&heap, reused) || 0 != shm_binary_heap_pop(&heap, &key, &value))
+    {
+        printf("%s test FAILED: stale handle removed reused node\n", __func__);
+        goto free_mem;
+    }
+
+    // worker dies holding the lock in the middle of push which allocated node and left links broken,
+    // the allocated node is not linked yet, so it must be freed instead of being pushed
+    fflush(stdout);
+    if (fork() == 0)
+    {
+        pooled_binary_heap_handle_t allocated;
+        pthread_mutex_lock(&heap.region->lock);
+        pooled_binary_heap_node_alloc(&heap.region->heap, &allocated);
+        pooled_binary_heap_node_set_key_u64(&heap.region->heap, allocated, 0);
+        heap.region->heap.root = POOLED_BINARY_HEAP_NIL;
+        heap.region->heap.size = 1;
+        _exit(0);
+    }
+    int status = 0;
+    wait(&status);
+
+    if (shm_binary_heap_size(&heap) != count - 2 || 0 != shm_binary_heap_verify(&heap))
+    {
+        printf("%s test FAILED: heap is not rebuilt\n", __func__);
+        goto free_mem;
+    }
+    uint64_t last_key = key;
+    size_t popped = 0;
+    while (0 == shm_binary_heap_pop(&heap, &key, &value))
+    {
+        if (key < last_key || value != VALUE_OF_KEY(key))
+        {
+            printf("%s test FAILED: key %" PRIu64 " popped out of order\n", __func__, key);
+            goto free_mem;
+        }
+        last_key = key;
+        popped++;
+    }
+    // freed nodes are reused
+    for (size_t i = 0; i < count; i++)
+    {
+        if (0 != shm_binary_heap_push(&heap, i, VALUE_OF_KEY(i), NULL))
+        {
+            printf("%s test FAILED: slab is not reused\n", __func__);
+            goto free_mem;
+        }
+    }
+    if (popped != count - 2 || 0 == shm_binary_heap_push(&heap, 0, 0, NULL))
+    {
+        printf("%s test FAILED: %zu nodes popped, full slab accepted push\n", __func__, popped);
+        goto free_mem;
+    }
+    printf("%s test PASSED\n", __func__);
+
+free_mem:
+    shm_binary_heap_close(&heap);
+    shm_unlink(name);
+}
+
+
+int main(void)
+{
+    srand(42);
+    test_shm_binary_heap_processes_push_and_pop();
+    test_shm_binary_heap_rebuilt_after_owner_died();
+}